@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudiocapturedispatcher_p.h"
+
+#include <QtCore/qiodevice.h>
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+class QAudioCaptureDevice : public QIODevice
+{
+public:
+    QAudioCaptureDevice(QAudioCaptureDispatcher *dispatcher)
+        : m_dispatcher(dispatcher)
+    {
+        open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    }
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        m_dispatcher->push(data, len);
+        return len;
+    }
+
+private:
+    QAudioCaptureDispatcher *m_dispatcher;
+};
+
+}
+
+QAudioCaptureDispatcher::QAudioCaptureDispatcher(const QAudioFormat &format, qsizetype framesPerBlock,
+                                                 Callback callback, int blockCount)
+    : m_format(format),
+      m_framesPerBlock(qMax(framesPerBlock, qsizetype(1))),
+      m_blockBytes(format.bytesForFrames(m_framesPerBlock)),
+      m_blockCount(quint64(qMax(blockCount, 2))),
+      m_callback(std::move(callback)),
+      m_slots(m_blockBytes * qsizetype(m_blockCount), Qt::Uninitialized),
+      m_slotStartFrames(m_blockCount, 0)
+{
+}
+
+QAudioCaptureDispatcher::~QAudioCaptureDispatcher()
+{
+    stop();
+}
+
+void QAudioCaptureDispatcher::start()
+{
+    if (m_thread)
+        return;
+    m_stopping.storeRelaxed(false);
+    m_thread.reset(QThread::create([this]() { deliverBlocks(); }));
+    m_thread->setObjectName(QStringLiteral("QAudioCaptureDispatcher"));
+    m_thread->start(QThread::TimeCriticalPriority);
+}
+
+void QAudioCaptureDispatcher::stop()
+{
+    if (!m_thread)
+        return;
+    m_stopping.storeRelease(true);
+    m_available.release();
+    m_thread->wait();
+    m_thread.reset();
+}
+
+QIODevice *QAudioCaptureDispatcher::device()
+{
+    if (!m_device)
+        m_device.reset(new QAudioCaptureDevice(this));
+    return m_device.get();
+}
+
+void QAudioCaptureDispatcher::push(const char *data, qsizetype len)
+{
+    if (m_blockBytes <= 0)
+        return;
+
+    m_processedBytes.fetchAndAddRelaxed(len);
+
+    while (len > 0) {
+        const quint64 written = m_written.loadRelaxed();
+        if (m_fill == 0) {
+            // Starting a new block, it can only be filled if the delivery thread
+            // has released the slot
+            m_dropBlock = written - m_read.loadAcquire() >= m_blockCount;
+        }
+
+        const qsizetype toCopy = qMin(len, m_blockBytes - m_fill);
+        if (!m_dropBlock) {
+            char *slot = m_slots.data() + qsizetype(written % m_blockCount) * m_blockBytes;
+            memcpy(slot + m_fill, data, toCopy);
+        }
+        m_fill += toCopy;
+        data += toCopy;
+        len -= toCopy;
+
+        if (m_fill < m_blockBytes)
+            break;
+
+        if (m_dropBlock) {
+            m_overruns.fetchAndAddRelaxed(1);
+        } else {
+            m_slotStartFrames[written % m_blockCount] = m_blockStartFrame;
+            m_written.storeRelease(written + 1);
+            m_available.release();
+        }
+        m_blockStartFrame += m_framesPerBlock;
+        m_fill = 0;
+    }
+}
+
+void QAudioCaptureDispatcher::deliverBlocks()
+{
+    for (;;) {
+        m_available.acquire();
+        if (m_stopping.loadAcquire())
+            break;
+
+        const quint64 read = m_read.loadRelaxed();
+        const qsizetype slot = qsizetype(read % m_blockCount);
+        QByteArray block(m_slots.constData() + slot * m_blockBytes, m_blockBytes);
+        const qint64 startTime = m_slotStartFrames[slot] * 1000000 / qMax(m_format.sampleRate(), 1);
+        m_read.storeRelease(read + 1);
+
+        if (m_callback)
+            m_callback(QAudioBuffer(block, m_format, startTime));
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOCAPTUREDISPATCHER_P_H
+#define QAUDIOCAPTUREDISPATCHER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtMultimedia/qaudiobuffer.h>
+#include <QtMultimedia/qaudioformat.h>
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qsemaphore.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+class QThread;
+
+// Delivers captured audio in blocks of a fixed number of frames to a callback
+// running on a thread of its own.
+//
+// The backend feeds data through push() from its audio thread. Data is assembled
+// into blocks directly inside a bounded single producer/single consumer ring of
+// block slots; handing a block to the delivery thread does not take any lock. If
+// the callback falls behind and all slots are in use, incoming blocks are dropped
+// and counted in overrunCount(). The timestamp of each block is its position in
+// the captured stream, so dropped blocks show up as gaps.
+class Q_MULTIMEDIA_EXPORT QAudioCaptureDispatcher
+{
+public:
+    using Callback = std::function<void(const QAudioBuffer &)>;
+
+    QAudioCaptureDispatcher(const QAudioFormat &format, qsizetype framesPerBlock,
+                            Callback callback, int blockCount = 8);
+    ~QAudioCaptureDispatcher();
+
+    void start();
+    void stop();
+
+    // Producer side. Must only be called from one thread at a time.
+    void push(const char *data, qsizetype len);
+
+    // A write only device forwarding to push(), for backends that hand out
+    // captured data through QIODevice::write() instead.
+    QIODevice *device();
+
+    QAudioFormat format() const { return m_format; }
+    qsizetype bytesPerBlock() const { return m_blockBytes; }
+    quint64 overrunCount() const { return m_overruns.loadRelaxed(); }
+    qint64 processedBytes() const { return m_processedBytes.loadRelaxed(); }
+
+private:
+    void deliverBlocks();
+
+    const QAudioFormat m_format;
+    const qsizetype m_framesPerBlock;
+    const qsizetype m_blockBytes;
+    const quint64 m_blockCount;
+    Callback m_callback;
+
+    QByteArray m_slots;
+    std::vector<qint64> m_slotStartFrames;
+
+    // Number of blocks published by the producer resp. consumed by the delivery thread
+    QAtomicInteger<quint64> m_written = 0;
+    QAtomicInteger<quint64> m_read = 0;
+    QSemaphore m_available;
+    QAtomicInteger<bool> m_stopping = false;
+
+    // Only accessed by the producer
+    qsizetype m_fill = 0;
+    qint64 m_blockStartFrame = 0;
+    bool m_dropBlock = false;
+
+    QAtomicInteger<quint64> m_overruns = 0;
+    QAtomicInteger<qint64> m_processedBytes = 0;
+
+    std::unique_ptr<QThread> m_thread;
+    std::unique_ptr<QIODevice> m_device;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOCAPTUREDISPATCHER_P_H
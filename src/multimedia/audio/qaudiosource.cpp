@@ -165,6 +165,7 @@ void QAudioSource::start(QIODevice* device)
 {
     d->elapsedTime.start();
     d->start(device);
+    d->captureDispatcher.reset();
 }
 
 /*!
@@ -188,7 +189,40 @@ void QAudioSource::start(QIODevice* device)
 QIODevice* QAudioSource::start()
 {
     d->elapsedTime.start();
-    return d->start();
+    QIODevice *device = d->start();
+    d->captureDispatcher.reset();
+    return device;
+}
+
+/*!
+    \since 6.3
+
+    Starts capturing audio and delivers it to \a callback in blocks of
+    \a framesPerBlock frames.
+
+    The callback is invoked on a dedicated high priority thread, not on the
+    thread of the QAudioSource, and receives the block as a QAudioBuffer in
+    format(). QAudioBuffer::startTime() is the position of the first frame
+    of the block in the captured stream, in microseconds.
+
+    The data is passed from the audio system to the callback thread through a
+    bounded ring buffer of a few blocks, without taking any locks. If the
+    callback does not keep up, blocks are dropped rather than queued without
+    limit; overrunCount() returns how many blocks were lost, and the dropped
+    blocks show up as a gap in the start times.
+
+    The callback must not call any functions of this QAudioSource. It is no
+    longer invoked once stop() or reset() returns.
+
+    \sa overrunCount(), stop()
+*/
+void QAudioSource::start(qsizetype framesPerBlock, std::function<void(const QAudioBuffer &)> callback)
+{
+    d->stop();
+    d->captureDispatcher.reset(new QAudioCaptureDispatcher(d->format(), framesPerBlock, std::move(callback)));
+    d->captureDispatcher->start();
+    d->elapsedTime.start();
+    d->start(d->captureDispatcher.get());
 }
 
 /*!
@@ -210,6 +244,8 @@ QAudioFormat QAudioSource::format() const
 void QAudioSource::stop()
 {
     d->stop();
+    if (d->captureDispatcher)
+        d->captureDispatcher->stop();
 }
 
 /*!
@@ -219,6 +255,8 @@ void QAudioSource::stop()
 void QAudioSource::reset()
 {
     d->reset();
+    if (d->captureDispatcher)
+        d->captureDispatcher->stop();
 }
 
 /*!
@@ -346,6 +384,21 @@ qint64 QAudioSource::elapsedUSecs() const
     return d->state() == QAudio::StoppedState ? 0 : d->elapsedTime.nsecsElapsed()/1000;
 }
 
+/*!
+    \since 6.3
+
+    Returns the number of blocks that were dropped since the last call to
+    start(qsizetype, std::function<void(const QAudioBuffer &)>) because the
+    callback did not process the previous blocks in time.
+
+    Returns 0 if the audio source was not started with a callback.
+*/
+
+quint64 QAudioSource::overrunCount() const
+{
+    return d->captureDispatcher ? d->captureDispatcher->overrunCount() : 0;
+}
+
 /*!
     Returns the error state.
 */
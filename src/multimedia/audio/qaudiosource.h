@@ -49,10 +49,13 @@
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodevice.h>
 
+#include <functional>
+
 
 QT_BEGIN_NAMESPACE
 
 class QPlatformAudioSource;
+class QAudioBuffer;
 
 class Q_MULTIMEDIA_EXPORT QAudioSource : public QObject
 {
@@ -69,6 +72,7 @@ public:
 
     void start(QIODevice *device);
     QIODevice* start();
+    void start(qsizetype framesPerBlock, std::function<void(const QAudioBuffer &)> callback);
 
     void stop();
     void reset();
@@ -85,6 +89,7 @@ public:
 
     qint64 processedUSecs() const;
     qint64 elapsedUSecs() const;
+    quint64 overrunCount() const;
 
     QAudio::Error error() const;
     QAudio::State state() const;
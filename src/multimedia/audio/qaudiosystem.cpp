@@ -179,6 +179,19 @@ QT_BEGIN_NAMESPACE
     the data transfer. This QIODevice can be used to read() audio data directly.
 */
 
+/*!
+    Starts capturing into \a dispatcher, which delivers the data in fixed size
+    blocks to a callback.
+
+    The default implementation transfers the data through the dispatcher's
+    QIODevice. Backends receiving audio on a thread of their own should
+    reimplement this and call QAudioCaptureDispatcher::push() from that thread.
+*/
+void QPlatformAudioSource::start(QAudioCaptureDispatcher *dispatcher)
+{
+    start(dispatcher->device());
+}
+
 /*!
     \fn void QPlatformAudioSource::stop()
     Stops the audio input.
@@ -56,9 +56,12 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodevice.h>
+#include <private/qaudiocapturedispatcher_p.h>
 
 #include <QtCore/qelapsedtimer.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 class QIODevice;
@@ -99,6 +102,7 @@ class QPlatformAudioSource : public QObject
 public:
     virtual void start(QIODevice *device) = 0;
     virtual QIODevice* start() = 0;
+    virtual void start(QAudioCaptureDispatcher *dispatcher);
     virtual void stop() = 0;
     virtual void reset() = 0;
     virtual void suspend()  = 0;
@@ -115,6 +119,7 @@ public:
     virtual qreal volume() const = 0;
 
     QElapsedTimer elapsedTime;
+    std::unique_ptr<QAudioCaptureDispatcher> captureDispatcher;
 
 Q_SIGNALS:
     void errorChanged(QAudio::Error error);
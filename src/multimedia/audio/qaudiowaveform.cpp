@@ -0,0 +1,726 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudiowaveform_p.h"
+
+#include <QtMultimedia/qaudiobuffer.h>
+#include <QtMultimedia/qaudiodecoder.h>
+#include <QtMultimedia/qwavedecoder.h>
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qvarlengtharray.h>
+#include <private/qsimd_p.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+void QT_FASTCALL qt_reduce_peaks(const float *samples, qsizetype count,
+                                 float *min, float *max, float *sumSquares)
+{
+    float lo = samples[0];
+    float hi = samples[0];
+    float sum = 0;
+    for (qsizetype i = 0; i < count; ++i) {
+        const float s = samples[i];
+        lo = qMin(lo, s);
+        hi = qMax(hi, s);
+        sum += s * s;
+    }
+    *min = lo;
+    *max = hi;
+    *sumSquares = sum;
+}
+
+namespace {
+
+// Buckets reduced by one thread pool task
+constexpr qint64 BucketsPerChunk = 256;
+
+// The sidecar file written by save(): a little endian header followed by
+// min, max and RMS of every level 0 bucket, scaled to qint16. Version 2 added
+// the sample format and the size and modification time of the audio file.
+constexpr quint32 SidecarMagic = 0x4d465751; // "QWFM"
+constexpr quint16 SidecarVersion = 2;
+
+qsizetype chunkBytes(const QAudioFormat &format, int framesPerBucket)
+{
+    return qsizetype(format.bytesPerFrame()) * framesPerBucket * BucketsPerChunk;
+}
+
+typedef void (QT_FASTCALL *ReducePeaksFunc)(const float *samples, qsizetype count,
+                                             float *min, float *max, float *sumSquares);
+
+ReducePeaksFunc reducePeaksFunc()
+{
+    static const ReducePeaksFunc func = []() -> ReducePeaksFunc {
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+        if (qCpuHasFeature(AVX2))
+            return qt_reduce_peaks_avx2;
+#endif
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+        if (qCpuHasFeature(SSE2))
+            return qt_reduce_peaks_sse2;
+#endif
+        return qt_reduce_peaks;
+    }();
+    return func;
+}
+
+template<typename T>
+void toFloat(const char *data, qsizetype first, int stride, qsizetype count,
+             float offset, float scale, float *out)
+{
+    const T *in = reinterpret_cast<const T *>(data) + first;
+    for (qsizetype i = 0; i < count; ++i)
+        out[i] = (float(in[i * stride]) - offset) * scale;
+}
+
+// Converts count samples of one channel, starting at sample first, to floats
+// in the range [-1, 1]
+void toFloat(QAudioFormat::SampleFormat format, const char *data, qsizetype first, int stride,
+             qsizetype count, float *out)
+{
+    switch (format) {
+    case QAudioFormat::UInt8:
+        toFloat<quint8>(data, first, stride, count, 128.f, 1.f / 128, out);
+        break;
+    case QAudioFormat::Int16:
+        toFloat<qint16>(data, first, stride, count, 0.f, 1.f / 32768, out);
+        break;
+    case QAudioFormat::Int32:
+        toFloat<qint32>(data, first, stride, count, 0.f, 1.f / 2147483648.f, out);
+        break;
+    case QAudioFormat::Float:
+        toFloat<float>(data, first, stride, count, 0.f, 1.f, out);
+        break;
+    case QAudioFormat::Unknown:
+    case QAudioFormat::NSampleFormats:
+        std::fill(out, out + count, 0.f);
+        break;
+    }
+}
+
+}
+
+struct QAudioWaveform::Job
+{
+    QAudioFormat format;
+    SourceInfo source;
+    int framesPerBucket = 0;
+    // Frames handed to the thread pool; final once inputDone is set
+    qint64 frameCount = 0;
+    QAtomicInteger<bool> cancelled = false;
+
+    QMutex mutex;
+    // Level 0 buckets of every chunk, by the index of their first bucket
+    QMap<qint64, Level> chunks;
+    int pending = 0;
+    bool inputDone = false;
+
+    QList<Level> levels;
+};
+
+QAudioWaveform::QAudioWaveform(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QAudioWaveform::~QAudioWaveform()
+{
+    cancel();
+}
+
+/*!
+    Sets the number of frames reduced to one bucket of the finest level. Takes
+    effect with the next call to analyze().
+*/
+void QAudioWaveform::setFramesPerBucket(int frames)
+{
+    m_framesPerBucket = qMax(frames, 1);
+}
+
+bool QAudioWaveform::analyze(QWaveDecoder *decoder)
+{
+    cancel();
+    if (!decoder || !(decoder->openMode() & QIODevice::ReadOnly) || !decoder->audioFormat().isValid())
+        return false;
+
+    auto *file = qobject_cast<QFileDevice *>(decoder->getDevice());
+    startJob(decoder->audioFormat(), file ? SourceInfo::ofFile(file->fileName()) : SourceInfo());
+    m_source = decoder;
+    // Directly, the remaining data can only be read before the decoder is closed
+    connect(decoder, &QIODevice::aboutToClose, this, &QAudioWaveform::waveDecoderClosed,
+            Qt::DirectConnection);
+
+    // Local files are reduced straight from the mapping, without copying
+    const QByteArrayView mapped = decoder->mappedData();
+    if (!mapped.isEmpty()) {
+        m_sourceMapped = true;
+        // The file unmaps the data when it is closed or destroyed, even while
+        // the decoder stays open
+        m_sourceFile = file;
+        if (file)
+            connect(file, &QIODevice::aboutToClose, this, &QAudioWaveform::waveDecoderClosed,
+                    Qt::DirectConnection);
+        const qsizetype bytes = chunkBytes(m_job->format, m_job->framesPerBucket);
+        const qsizetype size = mapped.size() - mapped.size() % m_job->format.bytesPerFrame();
+        for (qsizetype offset = 0; offset < size; offset += bytes)
+            dispatch(QByteArray::fromRawData(mapped.data() + offset, qMin(bytes, size - offset)));
+        finishInput();
+        return true;
+    }
+
+    if (!decoder->isSequential())
+        decoder->seekToFrame(0);
+    connect(decoder, &QIODevice::readyRead, this, &QAudioWaveform::readWaveData);
+    QMetaObject::invokeMethod(this, &QAudioWaveform::readWaveData, Qt::QueuedConnection);
+    return true;
+}
+
+bool QAudioWaveform::analyze(QAudioDecoder *decoder)
+{
+    cancel();
+    if (!decoder || !decoder->isSupported())
+        return false;
+
+    // An unset format is taken from the first buffer
+    const QUrl source = decoder->source();
+    startJob(decoder->audioFormat(),
+             source.isLocalFile() ? SourceInfo::ofFile(source.toLocalFile()) : SourceInfo());
+    m_source = decoder;
+    connect(decoder, &QAudioDecoder::bufferReady, this, &QAudioWaveform::readDecoderBuffers);
+    // Queued, decoders may emit finished() from within read(), before the last
+    // buffer is returned
+    const std::weak_ptr<Job> job = m_job;
+    connect(decoder, &QAudioDecoder::finished, this, [this, job]() {
+        if (!m_job || job.lock() != m_job)
+            return;
+        readDecoderBuffers();
+        finishInput();
+    }, Qt::QueuedConnection);
+    connect(decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this, [this, decoder]() {
+        failJob(decoder->errorString());
+    });
+    if (!decoder->isDecoding())
+        decoder->start();
+    return true;
+}
+
+/*!
+    Stops a running analysis and waits for the chunks being reduced. No
+    signals are emitted for it any more.
+*/
+void QAudioWaveform::cancel()
+{
+    if (!m_job)
+        return;
+    m_job->cancelled.storeRelaxed(true);
+    m_job.reset();
+    disconnectSource();
+    m_pending.clear();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+qint64 QAudioWaveform::duration() const
+{
+    return m_sampleRate > 0 ? m_frameCount * 1000000 / m_sampleRate : 0;
+}
+
+qint64 QAudioWaveform::bucketFrames(int level) const
+{
+    if (level < 0 || level >= m_levels.size())
+        return 0;
+    qint64 frames = m_bucketFrames;
+    for (int i = 0; i < level; ++i)
+        frames *= LevelFactor;
+    return frames;
+}
+
+QList<QAudioWaveform::Peak> QAudioWaveform::peaks(int channel, qint64 startTime, qint64 endTime,
+                                                  int count) const
+{
+    const auto toFrame = [this](qint64 time) { return time * m_sampleRate / 1000000; };
+    return framePeaks(channel, toFrame(startTime), toFrame(endTime), count);
+}
+
+/*!
+    Returns count peaks of \a channel, each covering an equal part of the
+    frames from \a startFrame up to \a endFrame. If there are less frames than
+    points, neighbouring points share a bucket. Returns an empty list if there
+    is no overview or no such channel.
+*/
+QList<QAudioWaveform::Peak> QAudioWaveform::framePeaks(int channel, qint64 startFrame,
+                                                       qint64 endFrame, int count) const
+{
+    QList<Peak> result;
+    if (!isReady() || channel < 0 || channel >= m_channelCount || count <= 0)
+        return result;
+
+    const qint64 start = qBound(qint64(0), startFrame, m_frameCount);
+    const qint64 end = qBound(start, endFrame, m_frameCount);
+    result.resize(count);
+    if (start == end)
+        return result;
+
+    const qint64 span = end - start;
+    int level = 0;
+    while (level + 1 < m_levels.size() && bucketFrames(level + 1) <= span / count)
+        ++level;
+    const qint64 size = bucketFrames(level);
+    const Level &buckets = m_levels.at(level);
+
+    for (int i = 0; i < count; ++i) {
+        const qint64 from = start + span * i / count;
+        const qint64 to = qMax(start + span * (i + 1) / count, from + 1);
+        const Bucket merged = mergeBuckets(buckets, m_channelCount, channel, from / size,
+                                           (to - 1) / size + 1, size, m_frameCount);
+        result[i] = { merged.min, merged.max, std::sqrt(merged.meanSquare) };
+    }
+    return result;
+}
+
+/*!
+    Writes the finest level of the overview to \a device. Peaks outside of
+    [-1, 1] are clipped, and all values are stored with 16 bit precision.
+*/
+bool QAudioWaveform::save(QIODevice *device) const
+{
+    if (!isReady() || !device || !device->isWritable())
+        return false;
+
+    QDataStream stream(device);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << SidecarMagic << SidecarVersion << quint16(m_channelCount) << qint32(m_sampleRate)
+           << qint32(m_bucketFrames) << qint64(m_frameCount) << quint16(m_sampleFormat)
+           << qint64(m_sourceInfo.size) << qint64(m_sourceInfo.lastModified);
+
+    const Level &buckets = m_levels.first();
+    const auto quantize = [](float value) { return qint16(qRound(qBound(-1.f, value, 1.f) * 32767)); };
+    QList<qint16> values(buckets.size() * 3);
+    for (qsizetype i = 0; i < buckets.size(); ++i) {
+        const Bucket &bucket = buckets.at(i);
+        values[i * 3] = quantize(bucket.min);
+        values[i * 3 + 1] = quantize(bucket.max);
+        values[i * 3 + 2] = quantize(std::sqrt(bucket.meanSquare));
+    }
+    qToLittleEndian<qint16>(values.constData(), values.size(), values.data());
+    const int bytes = int(values.size() * sizeof(qint16));
+    return stream.writeRawData(reinterpret_cast<const char *>(values.constData()), bytes) == bytes
+            && stream.status() == QDataStream::Ok;
+}
+
+bool QAudioWaveform::save(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && save(&file) && file.commit();
+}
+
+/*!
+    Replaces the overview with one written by save(). A running analysis is
+    cancelled. Returns false, leaving the overview empty, if \a device does
+    not hold a valid overview, or if \a audioFileName is given and is not the
+    file the overview was made of.
+*/
+bool QAudioWaveform::load(QIODevice *device, const QString &audioFileName)
+{
+    cancel();
+    m_levels.clear();
+    m_channelCount = 0;
+    m_sampleRate = 0;
+    m_sampleFormat = QAudioFormat::Unknown;
+    m_sourceInfo = {};
+    m_frameCount = 0;
+    m_bucketFrames = 0;
+    if (!device || !device->isReadable())
+        return false;
+
+    QDataStream stream(device);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 channelCount = 0;
+    qint32 sampleRate = 0;
+    qint32 bucketFrames = 0;
+    qint64 frameCount = 0;
+    quint16 sampleFormat = 0;
+    SourceInfo source;
+    stream >> magic >> version >> channelCount >> sampleRate >> bucketFrames >> frameCount
+           >> sampleFormat >> source.size >> source.lastModified;
+    if (stream.status() != QDataStream::Ok || magic != SidecarMagic || version != SidecarVersion
+        || channelCount == 0 || sampleRate <= 0 || bucketFrames <= 0 || frameCount <= 0
+        || sampleFormat >= QAudioFormat::NSampleFormats) {
+        return false;
+    }
+    // An overview of a stream, or of a file that is gone, matches no file
+    if (!audioFileName.isEmpty() && (source.size < 0 || !(SourceInfo::ofFile(audioFileName) == source)))
+        return false;
+
+    const qint64 bucketCount = (frameCount + bucketFrames - 1) / bucketFrames * channelCount;
+    const qint64 bytes = bucketCount * 3 * qint64(sizeof(qint16));
+    if (bytes > std::numeric_limits<int>::max() || (!device->isSequential() && device->bytesAvailable() < bytes))
+        return false;
+    QList<qint16> values(bucketCount * 3);
+    if (stream.readRawData(reinterpret_cast<char *>(values.data()), int(bytes)) != bytes)
+        return false;
+    qFromLittleEndian<qint16>(values.constData(), values.size(), values.data());
+
+    Level buckets(bucketCount);
+    for (qsizetype i = 0; i < buckets.size(); ++i) {
+        const float rms = values.at(i * 3 + 2) / 32767.f;
+        buckets[i] = { values.at(i * 3) / 32767.f, values.at(i * 3 + 1) / 32767.f, rms * rms };
+    }
+
+    m_levels.append(std::move(buckets));
+    buildLevels(m_levels, channelCount, bucketFrames, frameCount);
+    m_channelCount = channelCount;
+    m_sampleRate = sampleRate;
+    m_sampleFormat = QAudioFormat::SampleFormat(sampleFormat);
+    m_sourceInfo = source;
+    m_frameCount = frameCount;
+    m_bucketFrames = bucketFrames;
+    return true;
+}
+
+bool QAudioWaveform::load(const QString &fileName, const QString &audioFileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        load(nullptr);
+        return false;
+    }
+    return load(&file, audioFileName);
+}
+
+/*!
+    Returns the name of the file the overview of \a audioFileName is stored
+    in by convention.
+*/
+QString QAudioWaveform::sidecarFileName(const QString &audioFileName)
+{
+    return audioFileName + QLatin1String(".peaks");
+}
+
+QAudioWaveform::SourceInfo QAudioWaveform::SourceInfo::ofFile(const QString &fileName)
+{
+    SourceInfo info;
+    const QFileInfo fileInfo(fileName);
+    if (fileInfo.exists()) {
+        info.size = fileInfo.size();
+        info.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    }
+    return info;
+}
+
+void QAudioWaveform::startJob(const QAudioFormat &format, const SourceInfo &source)
+{
+    m_job = std::make_shared<Job>();
+    m_job->format = format;
+    m_job->source = source;
+    m_job->framesPerBucket = m_framesPerBucket;
+    m_sourceMapped = false;
+    m_pending.clear();
+}
+
+// Collects data into chunks of whole buckets, so that every chunk can be
+// reduced on its own
+void QAudioWaveform::appendData(QByteArrayView data)
+{
+    m_pending.append(data);
+    const qsizetype bytes = chunkBytes(m_job->format, m_job->framesPerBucket);
+    qsizetype offset = 0;
+    while (m_pending.size() - offset >= bytes) {
+        dispatch(m_pending.mid(offset, bytes));
+        offset += bytes;
+    }
+    m_pending.remove(0, offset);
+}
+
+void QAudioWaveform::dispatch(const QByteArray &data)
+{
+    const std::shared_ptr<Job> job = m_job;
+    const qint64 firstFrame = job->frameCount;
+    job->frameCount += data.size() / job->format.bytesPerFrame();
+    {
+        QMutexLocker locker(&job->mutex);
+        ++job->pending;
+    }
+
+    m_pool.start([this, job, data, firstFrame]() {
+        Level buckets;
+        if (!job->cancelled.loadRelaxed())
+            buckets = reduceChunk(job->format, job->framesPerBucket, data);
+
+        QMutexLocker locker(&job->mutex);
+        job->chunks.insert(firstFrame / job->framesPerBucket, std::move(buckets));
+        const bool complete = --job->pending == 0 && job->inputDone;
+        locker.unlock();
+        if (complete)
+            completeJob(job);
+    });
+}
+
+void QAudioWaveform::finishInput()
+{
+    if (!m_job)
+        return;
+    const int bytesPerFrame = m_job->format.bytesPerFrame();
+    if (bytesPerFrame > 0 && m_pending.size() >= bytesPerFrame)
+        dispatch(m_pending.left(m_pending.size() - m_pending.size() % bytesPerFrame));
+    m_pending.clear();
+    // A mapped decoder must not be closed before the chunks are reduced
+    if (!m_sourceMapped)
+        disconnectSource();
+
+    const std::shared_ptr<Job> job = m_job;
+    QMutexLocker locker(&job->mutex);
+    job->inputDone = true;
+    if (job->pending == 0)
+        m_pool.start([this, job]() { completeJob(job); });
+}
+
+// Called on the thread pool once all chunks are reduced
+void QAudioWaveform::completeJob(const std::shared_ptr<Job> &job)
+{
+    if (job->cancelled.loadRelaxed())
+        return;
+
+    Level buckets;
+    buckets.reserve((job->frameCount + job->framesPerBucket - 1) / job->framesPerBucket
+                    * job->format.channelCount());
+    for (const Level &chunk : qAsConst(job->chunks))
+        buckets.append(chunk);
+    job->chunks.clear();
+    if (!buckets.isEmpty()) {
+        job->levels.append(std::move(buckets));
+        buildLevels(job->levels, job->format.channelCount(), job->framesPerBucket, job->frameCount);
+    }
+
+    QMetaObject::invokeMethod(this, [this, job]() { finishJob(job); }, Qt::QueuedConnection);
+}
+
+void QAudioWaveform::finishJob(const std::shared_ptr<Job> &job)
+{
+    if (job != m_job)
+        return;
+    m_job.reset();
+    disconnectSource();
+    if (job->levels.isEmpty()) {
+        failJob(tr("No audio data"));
+        return;
+    }
+
+    m_channelCount = job->format.channelCount();
+    m_sampleRate = job->format.sampleRate();
+    m_sampleFormat = job->format.sampleFormat();
+    m_sourceInfo = job->source;
+    m_frameCount = job->frameCount;
+    m_bucketFrames = job->framesPerBucket;
+    m_levels = std::move(job->levels);
+    emit ready();
+}
+
+void QAudioWaveform::failJob(const QString &errorString)
+{
+    cancel();
+    emit error(errorString);
+}
+
+void QAudioWaveform::readWaveData()
+{
+    auto *decoder = qobject_cast<QWaveDecoder *>(m_source.data());
+    if (!m_job || !decoder)
+        return;
+
+    // Read one chunk at a time and come back through the event loop, so that
+    // long files do not block the thread
+    const qsizetype bytes = chunkBytes(m_job->format, m_job->framesPerBucket);
+    const QByteArray data = decoder->read(bytes);
+    if (!data.isEmpty())
+        appendData(data);
+
+    if (decoder->pos() >= decoder->size() || (data.isEmpty() && !decoder->isSequential()))
+        finishInput();
+    else if (data.size() == bytes)
+        QMetaObject::invokeMethod(this, &QAudioWaveform::readWaveData, Qt::QueuedConnection);
+}
+
+// Connected directly, the data has to be read or the chunks reduced before
+// the close goes on
+void QAudioWaveform::waveDecoderClosed()
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+    if (!m_job)
+        return;
+    // The mapping goes away with the decoder or the file, cancel() waits for
+    // the chunks that still read from it
+    if (m_sourceMapped) {
+        failJob(tr("The audio file was closed"));
+        return;
+    }
+    auto *decoder = qobject_cast<QWaveDecoder *>(m_source.data());
+    if (!decoder)
+        return;
+    for (QByteArray data = decoder->readAll(); !data.isEmpty(); data = decoder->readAll())
+        appendData(data);
+    finishInput();
+}
+
+void QAudioWaveform::readDecoderBuffers()
+{
+    auto *decoder = qobject_cast<QAudioDecoder *>(m_source.data());
+    while (m_job && decoder && decoder->bufferAvailable()) {
+        const QAudioBuffer buffer = decoder->read();
+        if (!buffer.isValid())
+            break;
+        if (!m_job->format.isValid()) {
+            m_job->format = buffer.format();
+        } else if (buffer.format() != m_job->format) {
+            failJob(tr("The audio format changed while decoding"));
+            return;
+        }
+        appendData(QByteArrayView(buffer.constData<char>(), buffer.byteCount()));
+    }
+}
+
+void QAudioWaveform::disconnectSource()
+{
+    if (m_source)
+        m_source->disconnect(this);
+    m_source.clear();
+    if (m_sourceFile)
+        m_sourceFile->disconnect(this);
+    m_sourceFile.clear();
+}
+
+QAudioWaveform::Level QAudioWaveform::reduceChunk(const QAudioFormat &format, int framesPerBucket,
+                                                  const QByteArray &data)
+{
+    const int channelCount = format.channelCount();
+    const qsizetype frames = data.size() / format.bytesPerFrame();
+    const qsizetype bucketCount = (frames + framesPerBucket - 1) / framesPerBucket;
+    const ReducePeaksFunc reducePeaks = reducePeaksFunc();
+
+    // Mono float data is reduced in place, everything else is converted
+    // channel by channel first
+    const bool direct = format.sampleFormat() == QAudioFormat::Float && channelCount == 1
+            && quintptr(data.constData()) % alignof(float) == 0;
+    QVarLengthArray<float, 1024> samples(direct ? 0 : framesPerBucket);
+
+    Level buckets(bucketCount * channelCount);
+    for (qsizetype b = 0; b < bucketCount; ++b) {
+        const qsizetype first = b * framesPerBucket;
+        const qsizetype count = qMin(qsizetype(framesPerBucket), frames - first);
+        for (int channel = 0; channel < channelCount; ++channel) {
+            const float *in;
+            if (direct) {
+                in = reinterpret_cast<const float *>(data.constData()) + first;
+            } else {
+                toFloat(format.sampleFormat(), data.constData(), first * channelCount + channel,
+                        channelCount, count, samples.data());
+                in = samples.constData();
+            }
+            Bucket &bucket = buckets[b * channelCount + channel];
+            float sumSquares = 0;
+            reducePeaks(in, count, &bucket.min, &bucket.max, &sumSquares);
+            bucket.meanSquare = sumSquares / count;
+        }
+    }
+    return buckets;
+}
+
+// Merges the buckets [first, last) of one channel. The mean squares are
+// weighted by frames, the last bucket of a stream can be shorter.
+QAudioWaveform::Bucket QAudioWaveform::mergeBuckets(const Level &level, int channelCount, int channel,
+                                                    qint64 first, qint64 last, qint64 bucketFrames,
+                                                    qint64 frameCount)
+{
+    Bucket merged = level.at(first * channelCount + channel);
+    double sumSquares = 0;
+    qint64 frames = 0;
+    for (qint64 i = first; i < last; ++i) {
+        const Bucket &bucket = level.at(i * channelCount + channel);
+        const qint64 n = qMin(bucketFrames, frameCount - i * bucketFrames);
+        merged.min = qMin(merged.min, bucket.min);
+        merged.max = qMax(merged.max, bucket.max);
+        sumSquares += double(bucket.meanSquare) * n;
+        frames += n;
+    }
+    merged.meanSquare = frames > 0 ? float(sumSquares / frames) : 0.f;
+    return merged;
+}
+
+// Appends coarser levels to levels, which holds level 0, until a level has a
+// single bucket per channel
+void QAudioWaveform::buildLevels(QList<Level> &levels, int channelCount, qint64 bucketFrames,
+                                 qint64 frameCount)
+{
+    qint64 size = bucketFrames;
+    while (levels.last().size() > channelCount) {
+        const Level &lower = levels.last();
+        const qint64 lowerCount = lower.size() / channelCount;
+        const qint64 count = (lowerCount + LevelFactor - 1) / LevelFactor;
+        Level upper(count * channelCount);
+        for (qint64 i = 0; i < count; ++i) {
+            const qint64 first = i * LevelFactor;
+            const qint64 last = qMin(first + LevelFactor, lowerCount);
+            for (int channel = 0; channel < channelCount; ++channel)
+                upper[i * channelCount + channel] = mergeBuckets(lower, channelCount, channel, first,
+                                                                 last, size, frameCount);
+        }
+        levels.append(std::move(upper));
+        size *= LevelFactor;
+    }
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qaudiowaveform_p.cpp"
@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudiowaveform_p.h"
+
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+
+QT_BEGIN_NAMESPACE
+
+void QT_FASTCALL qt_reduce_peaks_avx2(const float *samples, qsizetype count,
+                                      float *min, float *max, float *sumSquares)
+{
+    __m256 lo = _mm256_set1_ps(samples[0]);
+    __m256 hi = lo;
+    __m256 sum = _mm256_setzero_ps();
+
+    qsizetype i = 0;
+    for (; i < count - 7; i += 8) {
+        const __m256 s = _mm256_loadu_ps(samples + i);
+        lo = _mm256_min_ps(lo, s);
+        hi = _mm256_max_ps(hi, s);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(s, s));
+    }
+
+    alignas(32) float los[8];
+    alignas(32) float his[8];
+    alignas(32) float sums[8];
+    _mm256_store_ps(los, lo);
+    _mm256_store_ps(his, hi);
+    _mm256_store_ps(sums, sum);
+    float l = los[0];
+    float h = his[0];
+    float s2 = 0;
+    for (int j = 0; j < 8; ++j) {
+        l = qMin(l, los[j]);
+        h = qMax(h, his[j]);
+        s2 += sums[j];
+    }
+
+    for (; i < count; ++i) {
+        const float s = samples[i];
+        l = qMin(l, s);
+        h = qMax(h, s);
+        s2 += s * s;
+    }
+    *min = l;
+    *max = h;
+    *sumSquares = s2;
+}
+
+QT_END_NAMESPACE
+
+#endif
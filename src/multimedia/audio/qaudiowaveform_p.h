@@ -0,0 +1,221 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QAUDIOWAVEFORM_P_H
+#define QAUDIOWAVEFORM_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtMultimedia/qaudioformat.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qthreadpool.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioDecoder;
+class QIODevice;
+class QWaveDecoder;
+
+// Computes a min/max/RMS overview of an audio stream for drawing waveforms.
+//
+// The samples of a QWaveDecoder or QAudioDecoder are converted to float and
+// reduced to buckets of framesPerBucket() frames on a thread pool, using SSE2 or
+// AVX2 where available. Once all data is in, coarser levels each merging
+// LevelFactor buckets of the level below are built. peaks() answers a query
+// from the coarsest level whose buckets are not wider than a point, so its work
+// is proportional to the number of requested points, not to the length of the
+// range.
+//
+// The finest level can be stored next to the audio file with save() and read
+// back with load(), which avoids decoding the file again.
+class Q_MULTIMEDIA_EXPORT QAudioWaveform : public QObject
+{
+    Q_OBJECT
+public:
+    struct Peak
+    {
+        float min = 0;
+        float max = 0;
+        float rms = 0;
+    };
+
+    static constexpr int LevelFactor = 4;
+
+    explicit QAudioWaveform(QObject *parent = nullptr);
+    ~QAudioWaveform();
+
+    int framesPerBucket() const { return m_framesPerBucket; }
+    void setFramesPerBucket(int frames);
+
+    // Analyzes the decoder from its first frame on. The decoder has to be open
+    // and must not be destroyed before ready() or error() is emitted. Closing a
+    // decoder that reads from a memory mapped file, or the file itself, cancels
+    // the analysis, closing any other decoder ends its data. Either has to be
+    // closed in the thread of the waveform.
+    bool analyze(QWaveDecoder *decoder);
+    // Starts the decoder unless it is already decoding.
+    bool analyze(QAudioDecoder *decoder);
+    void cancel();
+
+    bool isRunning() const { return m_job != nullptr; }
+    bool isReady() const { return !m_levels.isEmpty(); }
+
+    int channelCount() const { return m_channelCount; }
+    int sampleRate() const { return m_sampleRate; }
+    QAudioFormat::SampleFormat sampleFormat() const { return m_sampleFormat; }
+    qint64 frameCount() const { return m_frameCount; }
+    qint64 duration() const;
+
+    int levelCount() const { return m_levels.size(); }
+    qint64 bucketFrames(int level) const;
+
+    // One peak per point for count points evenly spread over [start, end),
+    // in microseconds resp. frames.
+    QList<Peak> peaks(int channel, qint64 startTime, qint64 endTime, int count) const;
+    QList<Peak> framePeaks(int channel, qint64 startFrame, qint64 endFrame, int count) const;
+
+    // The file that was analyzed is recorded by size and modification time,
+    // when the decoder read from a local file. Passing audioFileName to load()
+    // rejects an overview of another file or of an older version of it.
+    bool save(QIODevice *device) const;
+    bool save(const QString &fileName) const;
+    bool load(QIODevice *device, const QString &audioFileName = QString());
+    bool load(const QString &fileName, const QString &audioFileName = QString());
+    static QString sidecarFileName(const QString &audioFileName);
+
+Q_SIGNALS:
+    void ready();
+    void error(const QString &errorString);
+
+private:
+    struct Bucket
+    {
+        float min;
+        float max;
+        float meanSquare;
+    };
+    using Level = QList<Bucket>;
+    struct Job;
+    struct SourceInfo
+    {
+        qint64 size = -1;
+        qint64 lastModified = 0;
+
+        static SourceInfo ofFile(const QString &fileName);
+        bool operator==(const SourceInfo &other) const
+        {
+            return size == other.size && lastModified == other.lastModified;
+        }
+    };
+
+    void startJob(const QAudioFormat &format, const SourceInfo &source);
+    void appendData(QByteArrayView data);
+    void dispatch(const QByteArray &data);
+    void finishInput();
+    void completeJob(const std::shared_ptr<Job> &job);
+    void finishJob(const std::shared_ptr<Job> &job);
+    void failJob(const QString &errorString);
+    void readWaveData();
+    void waveDecoderClosed();
+    void readDecoderBuffers();
+    void disconnectSource();
+
+    static Level reduceChunk(const QAudioFormat &format, int framesPerBucket, const QByteArray &data);
+    static Bucket mergeBuckets(const Level &level, int channelCount, int channel, qint64 first,
+                               qint64 last, qint64 bucketFrames, qint64 frameCount);
+    static void buildLevels(QList<Level> &levels, int channelCount, qint64 bucketFrames,
+                            qint64 frameCount);
+
+    Q_DISABLE_COPY(QAudioWaveform)
+
+    int m_framesPerBucket = 256;
+
+    // The finished overview
+    int m_channelCount = 0;
+    int m_sampleRate = 0;
+    QAudioFormat::SampleFormat m_sampleFormat = QAudioFormat::Unknown;
+    SourceInfo m_sourceInfo;
+    qint64 m_frameCount = 0;
+    qint64 m_bucketFrames = 0;
+    // Per level the buckets of all channels, one frame of buckets after the other
+    QList<Level> m_levels;
+
+    // The running analysis
+    std::shared_ptr<Job> m_job;
+    QPointer<QObject> m_source;
+    // The file a mapped source reads from
+    QPointer<QIODevice> m_sourceFile;
+    bool m_sourceMapped = false;
+    QByteArray m_pending;
+    QThreadPool m_pool;
+};
+
+Q_DECLARE_TYPEINFO(QAudioWaveform::Peak, Q_PRIMITIVE_TYPE);
+
+// Reduce count samples to their minimum, maximum and sum of squares. One of
+// them is picked at run time, they are exported for testing. The SSE2 and AVX2
+// versions only exist when the compiler supports the instruction set.
+Q_MULTIMEDIA_EXPORT void QT_FASTCALL qt_reduce_peaks(const float *samples, qsizetype count,
+                                                     float *min, float *max, float *sumSquares);
+Q_MULTIMEDIA_EXPORT void QT_FASTCALL qt_reduce_peaks_sse2(const float *samples, qsizetype count,
+                                                          float *min, float *max, float *sumSquares);
+Q_MULTIMEDIA_EXPORT void QT_FASTCALL qt_reduce_peaks_avx2(const float *samples, qsizetype count,
+                                                          float *min, float *max, float *sumSquares);
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOWAVEFORM_P_H
@@ -0,0 +1,87 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudiowaveform_p.h"
+
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+void QT_FASTCALL qt_reduce_peaks_sse2(const float *samples, qsizetype count,
+                                      float *min, float *max, float *sumSquares)
+{
+    __m128 lo = _mm_set1_ps(samples[0]);
+    __m128 hi = lo;
+    __m128 sum = _mm_setzero_ps();
+
+    qsizetype i = 0;
+    for (; i < count - 3; i += 4) {
+        const __m128 s = _mm_loadu_ps(samples + i);
+        lo = _mm_min_ps(lo, s);
+        hi = _mm_max_ps(hi, s);
+        sum = _mm_add_ps(sum, _mm_mul_ps(s, s));
+    }
+
+    alignas(16) float los[4];
+    alignas(16) float his[4];
+    alignas(16) float sums[4];
+    _mm_store_ps(los, lo);
+    _mm_store_ps(his, hi);
+    _mm_store_ps(sums, sum);
+    float l = qMin(qMin(los[0], los[1]), qMin(los[2], los[3]));
+    float h = qMax(qMax(his[0], his[1]), qMax(his[2], his[3]));
+    float s2 = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+
+    for (; i < count; ++i) {
+        const float s = samples[i];
+        l = qMin(l, s);
+        h = qMax(h, s);
+        s2 += s * s;
+    }
+    *min = l;
+    *max = h;
+    *sumSquares = s2;
+}
+
+QT_END_NAMESPACE
+
+#endif
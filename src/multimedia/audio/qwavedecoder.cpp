@@ -41,6 +41,8 @@
 
 #include <QtCore/qtimer.h>
 #include <QtCore/qendian.h>
+#include <QtCore/qfiledevice.h>
+#include <QtCore/qvarlengtharray.h>
 #include <limits.h>
 #include <qdebug.h>
 
@@ -48,23 +50,59 @@ QT_BEGIN_NAMESPACE
 
 namespace  {
 
-void bswap2(char *data, qsizetype count) noexcept
+enum : quint16 {
+    WaveFormatPcm = 0x0001,
+    WaveFormatIeeeFloat = 0x0003,
+    WaveFormatExtensible = 0xfffe
+};
+
+// Converts count samples from the layout in the file to the native output format.
+// src and dest may only be the same if the sample size doesn't change.
+void convertSamples(const char *src, char *dest, qsizetype count, int bits, bool isFloat,
+                    bool bigEndian, bool byteSwap) noexcept
 {
-    for (qsizetype i = 0; i < count; ++i) {
-        qSwap(data[0], data[1]);
-        ++count;
-        data += 2;
+    if (bits == 24) {
+        // widened to Int32, the low byte stays zero
+        const uchar *in = reinterpret_cast<const uchar *>(src);
+        for (qsizetype i = 0; i < count; ++i, in += 3) {
+            const quint32 value = bigEndian
+                    ? (quint32(in[0]) << 24) | (quint32(in[1]) << 16) | (quint32(in[2]) << 8)
+                    : (quint32(in[2]) << 24) | (quint32(in[1]) << 16) | (quint32(in[0]) << 8);
+            memcpy(dest + 4 * i, &value, 4);
+        }
+        return;
     }
-}
 
-void bswap4(char *data, qsizetype count) noexcept
-{
-    for (qsizetype i = 0; i < count; ++i) {
-        qSwap(data[0], data[3]);
-        qSwap(data[1], data[2]);
-        ++count;
-        data += 4;
+    if (bits == 64 && isFloat) {
+        // QAudioFormat has no double samples, narrow them to Float
+        for (qsizetype i = 0; i < count; ++i) {
+            quint64 raw;
+            memcpy(&raw, src + 8 * i, 8);
+            if (byteSwap)
+                raw = qbswap(raw);
+            double value;
+            memcpy(&value, &raw, 8);
+            const float narrowed = float(value);
+            memcpy(dest + 4 * i, &narrowed, 4);
+        }
+        return;
     }
+
+    // qbswap() handles whole arrays with SIMD where the CPU supports it
+    if (byteSwap) {
+        switch (bits) {
+        case 16:
+            qbswap<2>(src, count, dest);
+            return;
+        case 32:
+            qbswap<4>(src, count, dest);
+            return;
+        default:
+            break;
+        }
+    }
+    if (src != dest)
+        memcpy(dest, src, count * (bits / 8));
 }
 
 }
@@ -89,10 +127,13 @@ bool QWaveDecoder::open(QIODevice::OpenMode mode)
     bool canOpen = false;
     if (mode & QIODevice::ReadOnly && mode & ~QIODevice::WriteOnly) {
         canOpen = QIODevice::open(mode | QIODevice::Unbuffered);
-        if (canOpen && enoughDataAvailable())
+        if (!canOpen)
+            return false;
+        // handleData() disconnects again once the header has been parsed
+        connect(device, SIGNAL(readyRead()), SLOT(handleData()));
+        // Random access devices have all of the data available already
+        if (!device->isSequential() || enoughDataAvailable())
             handleData();
-        else
-            connect(device, SIGNAL(readyRead()), SLOT(handleData()));
         return canOpen;
     }
 
@@ -114,17 +155,69 @@ void QWaveDecoder::close()
         if (!device->isOpen() || !writeDataLength())
             qWarning() << "Failed to finalize wav file";
     }
+    // Unmap after aboutToClose(), users of mappedData() may still access it until then
     QIODevice::close();
+    if (mapped) {
+        if (auto *file = qobject_cast<QFileDevice *>(device))
+            file->unmap(const_cast<uchar *>(mapped));
+        mapped = nullptr;
+    }
 }
 
 bool QWaveDecoder::seek(qint64 pos)
 {
-    return device->seek(pos);
+    if (!(openMode() & QIODevice::ReadOnly) || !haveFormat)
+        return device->seek(pos);
+
+    // pos is in decoded bytes; every sample has a fixed size in the file, so
+    // this maps straight to an offset in the data chunk
+    const int outputBytes = format.bytesPerSample();
+    if (pos < 0 || outputBytes == 0)
+        return false;
+    const qint64 sourcePos = pos / outputBytes * sourceBytesPerSample();
+    if (sourcePos > dataSize)
+        return false;
+    if (!mapped && !device->seek(dataStart + sourcePos))
+        return false;
+    readPos = sourcePos;
+    return QIODevice::seek(pos);
 }
 
 qint64 QWaveDecoder::pos() const
 {
-    return device->pos();
+    if (!(openMode() & QIODevice::ReadOnly) || !haveFormat)
+        return device->pos();
+    return toOutputBytes(readPos);
+}
+
+bool QWaveDecoder::seekToFrame(qint64 frame)
+{
+    return seek(frame * format.bytesPerFrame());
+}
+
+qint64 QWaveDecoder::frameCount() const
+{
+    const int bytesPerFrame = format.bytesPerFrame();
+    return bytesPerFrame ? size() / bytesPerFrame : 0;
+}
+
+/*
+    Returns the sample data straight from the memory mapped file, when the
+    device is a local file and the samples need no conversion. Returns an
+    empty view otherwise, then the data has to be read through read().
+*/
+QByteArrayView QWaveDecoder::mappedData() const
+{
+    if (!mapped || sourceBytesPerSample() != format.bytesPerSample()
+        || (byteSwap && sourceBytesPerSample() > 1)) {
+        return {};
+    }
+    return QByteArrayView(reinterpret_cast<const char *>(mapped), dataSize);
+}
+
+qint64 QWaveDecoder::toOutputBytes(qint64 sourceBytes) const
+{
+    return bps >= 8 ? sourceBytes / sourceBytesPerSample() * format.bytesPerSample() : 0;
 }
 
 QAudioFormat QWaveDecoder::audioFormat() const
@@ -150,9 +243,7 @@ qint64 QWaveDecoder::size() const
     if (openMode() & QIODevice::ReadOnly) {
         if (!haveFormat)
             return 0;
-        if (bps == 24)
-            return dataSize*2/3;
-        return dataSize;
+        return toOutputBytes(dataSize);
     } else {
         return device->size();
     }
@@ -165,7 +256,12 @@ bool QWaveDecoder::isSequential() const
 
 qint64 QWaveDecoder::bytesAvailable() const
 {
-    return haveFormat ? device->bytesAvailable() : 0;
+    if (!haveFormat)
+        return 0;
+    qint64 available = dataSize - readPos;
+    if (!mapped)
+        available = qMin(available, device->bytesAvailable());
+    return toOutputBytes(available);
 }
 
 qint64 QWaveDecoder::headerLength()
@@ -178,47 +274,52 @@ qint64 QWaveDecoder::readData(char *data, qint64 maxlen)
     if (!haveFormat || format.bytesPerSample() == 0)
         return 0;
 
-    if (bps == 24) {
-        // 24 bit WAV, read in as 16 bit
-        qint64 l = 0;
-        while (l < maxlen - 1) {
-            char tmp[3];
-            device->read(tmp, 3);
-            if (byteSwap)
-                qSwap(tmp[0], tmp[2]);
-#if Q_BYTE_ORDER == Q_BIG_ENDIAN
-            data[0] = tmp[0];
-            data[1] = tmp[1];
-#else
-            data[0] = tmp[1];
-            data[1] = tmp[2];
-#endif
-            data += 2;
-            l += 2;
-        }
-        return l;
-    }
+    const int outputBytes = format.bytesPerSample();
+    const qint64 sourceBytes = sourceBytesPerSample();
 
-    qint64 nSamples = maxlen / format.bytesPerSample();
-    maxlen = nSamples * format.bytesPerSample();
-    int read = device->read(data, maxlen);
+    // Only whole samples, and never past the data chunk
+    qint64 available = dataSize - readPos;
+    if (!mapped)
+        available = qMin(available, device->bytesAvailable());
+    const qint64 samples = qMin(maxlen / outputBytes, available / sourceBytes);
+    if (samples <= 0)
+        return 0;
 
-    if (!byteSwap || format.bytesPerFrame() == 1)
-        return read;
+    if (mapped) {
+        convertSamples(reinterpret_cast<const char *>(mapped) + readPos, data, samples, bps,
+                       isFloat, bigEndian, byteSwap);
+        readPos += samples * sourceBytes;
+        return samples * outputBytes;
+    }
 
-    nSamples = read / format.bytesPerSample();
-    switch (format.bytesPerSample()) {
-    case 2:
-        bswap2(data, nSamples);
-        break;
-    case 4:
-        bswap4(data, nSamples);
-        break;
-    default:
-        Q_UNREACHABLE();
+    if (sourceBytes == outputBytes) {
+        // converted in place
+        const qint64 read = device->read(data, samples * sourceBytes);
+        if (read <= 0)
+            return read;
+        convertSamples(data, data, read / sourceBytes, bps, isFloat, bigEndian, byteSwap);
+        readPos += read;
+        return read;
     }
-    return read;
 
+    // The sample size changes, go through a bounce buffer
+    QVarLengthArray<char, 4096> buffer;
+    qint64 converted = 0;
+    while (converted < samples) {
+        const qint64 chunk = qMin(samples - converted, qint64(16384) / sourceBytes);
+        buffer.resize(chunk * sourceBytes);
+        const qint64 read = device->read(buffer.data(), buffer.size());
+        if (read <= 0)
+            break;
+        const qint64 readSamples = read / sourceBytes;
+        convertSamples(buffer.constData(), data + converted * outputBytes, readSamples, bps,
+                       isFloat, bigEndian, byteSwap);
+        readPos += read;
+        converted += readSamples;
+        if (read < buffer.size())
+            break;
+    }
+    return converted * outputBytes;
 }
 
 qint64 QWaveDecoder::writeData(const char *data, qint64 len)
@@ -328,89 +429,70 @@ void QWaveDecoder::handleData()
     }
 
     if (state == QWaveDecoder::InitialState) {
-        if (device->bytesAvailable() < qint64(sizeof(RIFFHeader)))
+        if (device->bytesAvailable() < qint64(sizeof(RIFFHeader))) {
+            if (!device->isSequential())
+                parsingFailed();
             return;
+        }
 
         RIFFHeader riff;
         device->read(reinterpret_cast<char *>(&riff), sizeof(RIFFHeader));
 
-        // RIFF = little endian RIFF, RIFX = big endian RIFF
-        if (((qstrncmp(riff.descriptor.id, "RIFF", 4) != 0) && (qstrncmp(riff.descriptor.id, "RIFX", 4) != 0))
+        // RIFF = little endian RIFF, RIFX = big endian RIFF,
+        // RF64 = little endian with 64 bit sizes in a ds64 chunk
+        rf64 = qstrncmp(riff.descriptor.id, "RF64", 4) == 0;
+        if (((qstrncmp(riff.descriptor.id, "RIFF", 4) != 0) && (qstrncmp(riff.descriptor.id, "RIFX", 4) != 0) && !rf64)
                 || qstrncmp(riff.type, "WAVE", 4) != 0) {
             parsingFailed();
             return;
         }
 
-        state = QWaveDecoder::WaitingForFormatState;
+        state = rf64 ? QWaveDecoder::WaitingForDs64State : QWaveDecoder::WaitingForFormatState;
         bigEndian = (qstrncmp(riff.descriptor.id, "RIFX", 4) == 0);
         byteSwap = (bigEndian != (QSysInfo::ByteOrder == QSysInfo::BigEndian));
     }
 
-    if (state == QWaveDecoder::WaitingForFormatState) {
-        if (findChunk("fmt ")) {
+    if (state == QWaveDecoder::WaitingForDs64State) {
+        if (findChunk("ds64")) {
             chunk descriptor;
             peekChunk(&descriptor);
 
-            quint32 rawChunkSize = descriptor.size + sizeof(chunk);
-            if (device->bytesAvailable() < qint64(rawChunkSize))
+            const qint64 rawChunkSize = qint64(descriptor.size) + sizeof(chunk);
+            if (rawChunkSize < qint64(sizeof(DS64Header))) {
+                parsingFailed();
+                return;
+            }
+            if (device->bytesAvailable() < rawChunkSize)
                 return;
 
-            WAVEHeader wave;
-            device->read(reinterpret_cast<char *>(&wave), sizeof(WAVEHeader));
+            DS64Header ds64;
+            device->read(reinterpret_cast<char *>(&ds64), sizeof(DS64Header));
+            discardBytes(rawChunkSize - sizeof(DS64Header) + (descriptor.size & 1));
 
-            if (rawChunkSize > sizeof(WAVEHeader))
-                discardBytes(rawChunkSize - sizeof(WAVEHeader));
+            rf64DataSize = qint64(qFromLittleEndian<quint64>(ds64.dataSize));
+            state = QWaveDecoder::WaitingForFormatState;
+        }
+    }
 
-            // Swizzle this
-            if (bigEndian) {
-                wave.audioFormat = qFromBigEndian<quint16>(wave.audioFormat);
-            } else {
-                wave.audioFormat = qFromLittleEndian<quint16>(wave.audioFormat);
-            }
+    if (state == QWaveDecoder::WaitingForFormatState) {
+        if (findChunk("fmt ")) {
+            chunk descriptor;
+            peekChunk(&descriptor);
 
-            if (wave.audioFormat != 0 && wave.audioFormat != 1) {
-                // 32bit wave files have format == 0xFFFE (WAVE_FORMAT_EXTENSIBLE).
-                // but don't support them at the moment.
-                parsingFailed();
+            quint32 rawChunkSize = descriptor.size + sizeof(chunk);
+            if (device->bytesAvailable() < qint64(rawChunkSize))
                 return;
-            }
 
-            int rate;
-            int channels;
-            if (bigEndian) {
-                 bps = qFromBigEndian<quint16>(wave.bitsPerSample);
-                 rate = qFromBigEndian<quint32>(wave.sampleRate);
-                 channels = qFromBigEndian<quint16>(wave.numChannels);
-            } else {
-                bps = qFromLittleEndian<quint16>(wave.bitsPerSample);
-                rate = qFromLittleEndian<quint32>(wave.sampleRate);
-                channels = qFromLittleEndian<quint16>(wave.numChannels);
-            }
+            const QByteArray chunkData = device->read(rawChunkSize);
+            // chunks are padded to an even size
+            if (descriptor.size & 1)
+                discardBytes(1);
 
-            QAudioFormat::SampleFormat fmt = QAudioFormat::Unknown;
-            switch(bps) {
-            case 8:
-                fmt = QAudioFormat::UInt8;
-                break;
-            case 16:
-                fmt = QAudioFormat::Int16;
-                break;
-            case 24:
-                fmt = QAudioFormat::Int16;
-                break;
-            case 32:
-                fmt = QAudioFormat::Int32;
-                break;
-            }
-            if (fmt == QAudioFormat::Unknown || rate == 0 || channels == 0) {
+            if (!parseFormat(chunkData)) {
                 parsingFailed();
                 return;
             }
 
-            format.setSampleFormat(fmt);
-            format.setSampleRate(/*qFromBigEndian<quint32>*/(wave.sampleRate));
-            format.setChannelCount(/*qFromBigEndian<quint16>*/(wave.numChannels));
-
             state = QWaveDecoder::WaitingForDataState;
         }
     }
@@ -426,9 +508,28 @@ void QWaveDecoder::handleData()
             else
                 descriptor.size = qFromLittleEndian<quint32>(descriptor.size);
 
+            dataStart = device->pos();
             dataSize = descriptor.size; //means the data size from the data header, not the actual file size
-            if (!dataSize)
-                dataSize = device->size() - headerLength();
+            if (rf64 && descriptor.size == 0xffffffff)
+                dataSize = rf64DataSize;
+
+            if (!device->isSequential()) {
+                // Unknown or truncated data chunks end with the file
+                const qint64 available = device->size() - dataStart;
+                if (!dataSize || dataSize > available)
+                    dataSize = available;
+            } else if (!dataSize) {
+                dataSize = device->bytesAvailable();
+            }
+
+            // Local files are read straight from memory, which also makes seeking free
+            if (auto *file = qobject_cast<QFileDevice *>(device); file && dataSize > 0) {
+                mapped = file->map(dataStart, dataSize);
+                if (mapped) {
+                    connect(file, &QIODevice::aboutToClose, this, [this]() { mapped = nullptr; },
+                            Qt::DirectConnection);
+                }
+            }
 
             haveFormat = true;
             connect(device, SIGNAL(readyRead()), SIGNAL(readyRead()));
@@ -444,6 +545,70 @@ void QWaveDecoder::handleData()
     }
 }
 
+bool QWaveDecoder::parseFormat(const QByteArray &chunkData)
+{
+    if (chunkData.size() < qsizetype(sizeof(WAVEHeader)))
+        return false;
+
+    WAVEHeader wave;
+    memcpy(&wave, chunkData.constData(), sizeof(WAVEHeader));
+
+    auto read16 = [this](const void *p) {
+        return bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+    };
+    auto read32 = [this](const void *p) {
+        return bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+    };
+
+    quint16 audioFormat = read16(&wave.audioFormat);
+    if (audioFormat == WaveFormatExtensible) {
+        // cbSize, validBitsPerSample and channelMask are followed by the sub format
+        // GUID, which starts with the actual format tag
+        const qsizetype subFormatOffset = sizeof(WAVEHeader) + 8;
+        if (chunkData.size() < subFormatOffset + 16)
+            return false;
+        audioFormat = read16(chunkData.constData() + subFormatOffset);
+    }
+
+    bps = read16(&wave.bitsPerSample);
+    const int rate = read32(&wave.sampleRate);
+    const int channels = read16(&wave.numChannels);
+
+    QAudioFormat::SampleFormat fmt = QAudioFormat::Unknown;
+    switch (audioFormat) {
+    case 0:
+    case WaveFormatPcm:
+        isFloat = false;
+        switch (bps) {
+        case 8:
+            fmt = QAudioFormat::UInt8;
+            break;
+        case 16:
+            fmt = QAudioFormat::Int16;
+            break;
+        case 24:
+        case 32:
+            fmt = QAudioFormat::Int32;
+            break;
+        }
+        break;
+    case WaveFormatIeeeFloat:
+        isFloat = true;
+        if (bps == 32 || bps == 64)
+            fmt = QAudioFormat::Float;
+        break;
+    default:
+        break;
+    }
+    if (fmt == QAudioFormat::Unknown || rate <= 0 || channels == 0)
+        return false;
+
+    format.setSampleFormat(fmt);
+    format.setSampleRate(rate);
+    format.setChannelCount(channels);
+    return true;
+}
+
 bool QWaveDecoder::enoughDataAvailable()
 {
     chunk descriptor;
@@ -456,6 +621,9 @@ bool QWaveDecoder::enoughDataAvailable()
         descriptor.size = qFromBigEndian<quint32>(descriptor.size);
     if (qstrncmp(descriptor.id, "RIFF", 4) == 0)
         descriptor.size = qFromLittleEndian<quint32>(descriptor.size);
+    // The size is in the ds64 chunk, just parse as the data comes in
+    if (qstrncmp(descriptor.id, "RF64", 4) == 0)
+        return true;
 
     if (device->bytesAvailable() < qint64(sizeof(chunk) + descriptor.size))
         return false;
@@ -476,7 +644,8 @@ bool QWaveDecoder::findChunk(const char *chunkId)
 
         // It's possible that bytes->available() is less than the chunk size
         // if it's corrupt.
-        junkToSkip = qint64(sizeof(chunk) + descriptor.size);
+        // chunks are padded to an even size
+        junkToSkip = qint64(sizeof(chunk) + descriptor.size + (descriptor.size & 1));
 
         // Skip the current amount
         if (junkToSkip > 0)
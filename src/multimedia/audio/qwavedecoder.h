@@ -41,6 +41,7 @@
 #define WAVEDECODER_H
 
 #include <QtCore/qiodevice.h>
+#include <QtCore/qbytearrayview.h>
 #include <QtMultimedia/qaudioformat.h>
 
 
@@ -61,8 +62,12 @@ public:
     QAudioFormat audioFormat() const;
     QIODevice* getDevice();
     int duration() const;
+    qint64 frameCount() const;
     static qint64 headerLength();
 
+    bool seekToFrame(qint64 frame);
+    QByteArrayView mappedData() const;
+
     bool open(QIODevice::OpenMode mode) override;
     void close() override;
     bool seek(qint64 pos) override;
@@ -89,9 +94,13 @@ private:
     bool findChunk(const char *chunkId);
     void discardBytes(qint64 numBytes);
     void parsingFailed();
+    bool parseFormat(const QByteArray &chunkData);
+    qint64 sourceBytesPerSample() const { return bps / 8; }
+    qint64 toOutputBytes(qint64 sourceBytes) const;
 
     enum State {
         InitialState,
+        WaitingForDs64State,
         WaitingForFormatState,
         WaitingForDataState
     };
@@ -124,6 +133,15 @@ private:
         chunk       descriptor;
     };
 
+    // RF64 stores the 64 bit sizes in a ds64 chunk right after the RIFF header
+    struct DS64Header
+    {
+        chunk       descriptor;
+        quint64     riffSize;
+        quint64     dataSize;
+        quint64     sampleCount;
+    };
+
     struct CombinedHeader
     {
         RIFFHeader  riff;
@@ -141,7 +159,13 @@ private:
     quint32 junkToSkip = 0;
     bool bigEndian = false;
     bool byteSwap = false;
+    bool rf64 = false;
+    bool isFloat = false;
     int bps = 0;
+    qint64 rf64DataSize = 0;
+    qint64 dataStart = 0;
+    qint64 readPos = 0;
+    const uchar *mapped = nullptr;
 };
 
 QT_END_NAMESPACE
@@ -130,6 +130,8 @@ QImageCapture::QImageCapture(QObject *parent)
             this, SIGNAL(imageAvailable(int,QVideoFrame)));
     connect(d->control, SIGNAL(imageSaved(int,QString)),
             this, SIGNAL(imageSaved(int,QString)));
+    connect(d->control, SIGNAL(imageProcessed(int,qint64)),
+            this, SIGNAL(imageProcessed(int,qint64)));
     connect(d->control, SIGNAL(readyForCaptureChanged(bool)),
             this, SIGNAL(readyForCaptureChanged(bool)));
     connect(d->control, SIGNAL(error(int,int,QString)),
@@ -156,6 +158,29 @@ QImageCapture::~QImageCapture()
     delete d_ptr;
 }
 
+/*!
+    \internal
+
+    Preview images are only generated while imageCaptured() is connected.
+*/
+void QImageCapture::connectNotify(const QMetaMethod &signal)
+{
+    Q_D(QImageCapture);
+    if (d->control && signal == QMetaMethod::fromSignal(&QImageCapture::imageCaptured))
+        d->control->setPreviewRequested(true);
+}
+
+/*!
+    \internal
+*/
+void QImageCapture::disconnectNotify(const QMetaMethod &signal)
+{
+    Q_D(QImageCapture);
+    static const QMetaMethod capturedSignal = QMetaMethod::fromSignal(&QImageCapture::imageCaptured);
+    if (d->control && (!signal.isValid() || signal == capturedSignal))
+        d->control->setPreviewRequested(isSignalConnected(capturedSignal));
+}
+
 /*!
     Returns true if the images capture service ready to use.
 */
@@ -330,6 +355,104 @@ int QImageCapture::capture()
     return -1;
 }
 
+/*!
+    \since 6.3
+
+    Captures \a count images from consecutive camera frames, or from every
+    \a frameInterval'th frame, and makes them available as QImage and
+    QVideoFrame.
+
+    The images get consecutive request ids, starting at the returned one. Up
+    to maximumPendingImages() of them are encoded in parallel. When all of them
+    are busy, capturing waits for the next frame after one has finished, so
+    a fast burst needs a queue deep enough for the camera's frame rate.
+
+    Each image is reported with the same signals as a single capture, and
+    imageProcessed() tells how long it took to encode it.
+
+    \sa captureBurstToFile(), setMaximumPendingImages()
+*/
+int QImageCapture::captureBurst(int count, int frameInterval)
+{
+    Q_D(QImageCapture);
+
+    d->unsetError();
+
+    if (!d->control) {
+        d->_q_error(-1, NotSupportedFeatureError, QPlatformImageCapture::msgCameraNotReady());
+        return -1;
+    }
+
+    if (!isReadyForCapture()) {
+        d->_q_error(-1, NotReadyError, tr("Could not capture in stopped state"));
+        return -1;
+    }
+
+    return d->control->captureBurstToBuffer(qMax(count, 1), qMax(frameInterval, 1));
+}
+
+/*!
+    \since 6.3
+
+    Captures \a count images from consecutive camera frames, or from every
+    \a frameInterval'th frame, and saves them to files.
+
+    The file names are generated from \a location the same way as for
+    captureToFile(), with the index of the image in the burst appended.
+
+    \sa captureBurst()
+*/
+int QImageCapture::captureBurstToFile(int count, int frameInterval, const QString &location)
+{
+    Q_D(QImageCapture);
+
+    d->unsetError();
+
+    if (!d->control) {
+        d->_q_error(-1, NotSupportedFeatureError, QPlatformImageCapture::msgCameraNotReady());
+        return -1;
+    }
+
+    if (!isReadyForCapture()) {
+        d->_q_error(-1, NotReadyError, tr("Could not capture in stopped state"));
+        return -1;
+    }
+
+    return d->control->captureBurst(qMax(count, 1), qMax(frameInterval, 1), location);
+}
+
+/*!
+    \since 6.3
+
+    Returns how many captured images can be encoded at the same time.
+*/
+int QImageCapture::maximumPendingImages() const
+{
+    Q_D(const QImageCapture);
+    return d->control ? d->control->maximumPendingImages() : 1;
+}
+
+/*!
+    \since 6.3
+
+    Allows up to \a count captured images to be encoded at the same time.
+
+    The image capture is ready for another capture as long as fewer images are
+    pending. The default is \c 1, a capture has to finish before the next one
+    can start. Higher values allow fast bursts and use more threads and
+    memory.
+*/
+void QImageCapture::setMaximumPendingImages(int count)
+{
+    Q_D(QImageCapture);
+    if (!d->control)
+        return;
+    const int old = d->control->maximumPendingImages();
+    d->control->setMaximumPendingImages(qMax(count, 1));
+    if (d->control->maximumPendingImages() != old)
+        emit maximumPendingImagesChanged();
+}
+
 /*!
     \enum QImageCapture::Error
 
@@ -359,6 +482,10 @@ int QImageCapture::capture()
 
     Signal emitted when the frame with request \a id was captured, but not
     processed and saved yet. Frame \a preview can be displayed to user.
+
+    The preview may be scaled down from the captured resolution, and is only
+    generated while this signal is connected. Use imageAvailable() to get the
+    full frame.
 */
 
 /*!
@@ -406,7 +533,7 @@ void QImageCapture::setFileFormat(QImageCapture::FileFormat format)
 
 QList<QImageCapture::FileFormat> QImageCapture::supportedFormats()
 {
-    return QPlatformMediaIntegration::instance()->formatInfo()->imageFormats;
+    return QPlatformMediaIntegration::instance()->formatInfo()->supportedImageFormats();
 }
 
 QString QImageCapture::fileFormatName(QImageCapture::FileFormat f)
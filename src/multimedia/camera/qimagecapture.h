@@ -67,6 +67,7 @@ class Q_MULTIMEDIA_EXPORT QImageCapture : public QObject
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorChanged)
     Q_PROPERTY(FileFormat fileFormat READ fileFormat NOTIFY setFileFormat NOTIFY fileFormatChanged)
     Q_PROPERTY(Quality quality READ quality NOTIFY setQuality NOTIFY qualityChanged)
+    Q_PROPERTY(int maximumPendingImages READ maximumPendingImages WRITE setMaximumPendingImages NOTIFY maximumPendingImagesChanged)
 public:
     enum Error
     {
@@ -129,9 +130,14 @@ public:
     void setMetaData(const QMediaMetaData &metaData);
     void addMetaData(const QMediaMetaData &metaData);
 
+    int maximumPendingImages() const;
+    void setMaximumPendingImages(int count);
+
 public Q_SLOTS:
     int captureToFile(const QString &location = QString());
     int capture();
+    int captureBurst(int count, int frameInterval = 1);
+    int captureBurstToFile(int count, int frameInterval = 1, const QString &location = QString());
 
 Q_SIGNALS:
     void errorChanged();
@@ -149,6 +155,12 @@ Q_SIGNALS:
     void imageMetadataAvailable(int id, const QMediaMetaData &metaData);
     void imageAvailable(int id, const QVideoFrame &frame);
     void imageSaved(int id, const QString &fileName);
+    void imageProcessed(int id, qint64 latency);
+    void maximumPendingImagesChanged();
+
+protected:
+    void connectNotify(const QMetaMethod &signal) override;
+    void disconnectNotify(const QMetaMethod &signal) override;
 
 private:
     // This is here to flag an incompatibilities with Qt 5
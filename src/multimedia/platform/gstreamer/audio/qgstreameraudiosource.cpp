@@ -44,6 +44,7 @@
 
 #include "qgstreameraudiosource_p.h"
 #include "qgstreameraudiodevice_p.h"
+#include <private/qgstreamermessage_p.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -140,6 +141,26 @@ QIODevice *QGStreamerAudioSource::start()
     return m_audioSink;
 }
 
+void QGStreamerAudioSource::start(QAudioCaptureDispatcher *dispatcher)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    close();
+
+    // Samples are pushed to the dispatcher straight from the appsink's
+    // streaming thread, see new_sample()
+    m_dispatcher = dispatcher;
+    if (!open()) {
+        m_dispatcher = nullptr;
+        return;
+    }
+
+    m_pullMode = true;
+
+    setState(QAudio::ActiveState);
+}
+
 void QGStreamerAudioSource::stop()
 {
     if (m_deviceState == QAudio::StoppedState)
@@ -185,10 +206,8 @@ bool QGStreamerAudioSource::open()
 #endif
 
     gstPipeline = QGstPipeline("pipeline");
-
-    auto *gstBus = gst_pipeline_get_bus(gstPipeline.pipeline());
-    gst_bus_add_watch(gstBus, &QGStreamerAudioSource::busMessage, this);
-    gst_object_unref (gstBus);
+    // Delivered on the thread of the source, which stops itself on EOS
+    gstPipeline.installMessageFilter(this, this);
 
     gstAppSink = createAppSink();
     gstAppSink.set("caps", gstCaps);
@@ -218,6 +237,7 @@ void QGStreamerAudioSource::close()
         return;
 
     gstPipeline.setState(GST_STATE_NULL);
+    gstPipeline.removeMessageFilter(this);
     gstPipeline = {};
     gstVolume = {};
     gstAppSink = {};
@@ -227,18 +247,19 @@ void QGStreamerAudioSource::close()
         delete m_audioSink;
     }
     m_audioSink = nullptr;
+    m_dispatcher = nullptr;
     m_opened = false;
 }
 
-gboolean QGStreamerAudioSource::busMessage(GstBus *, GstMessage *msg, gpointer user_data)
+bool QGStreamerAudioSource::processBusMessage(const QGstreamerMessage &message)
 {
-    QGStreamerAudioSource *input = static_cast<QGStreamerAudioSource *>(user_data);
+    auto *msg = message.rawMessage();
     switch (GST_MESSAGE_TYPE (msg)) {
     case GST_MESSAGE_EOS:
-        input->stop();
+        stop();
         break;
     case GST_MESSAGE_ERROR: {
-        input->setError(QAudio::IOError);
+        setError(QAudio::IOError);
         gchar  *debug;
         GError *error;
 
@@ -297,6 +318,8 @@ qsizetype QGStreamerAudioSource::bufferSize() const
 
 qint64 QGStreamerAudioSource::processedUSecs() const
 {
+    if (m_dispatcher)
+        return m_format.durationForBytes(m_dispatcher->processedBytes());
     return m_format.durationForBytes(m_bytesWritten);
 }
 
@@ -364,6 +387,16 @@ GstFlowReturn QGStreamerAudioSource::new_sample(GstAppSink *sink, gpointer user_
     QGStreamerAudioSource *control = static_cast<QGStreamerAudioSource*>(user_data);
 
     GstSample *sample = gst_app_sink_pull_sample(sink);
+    if (control->m_dispatcher) {
+        GstBuffer *buffer = gst_sample_get_buffer(sample);
+        GstMapInfo mapInfo;
+        if (gst_buffer_map(buffer, &mapInfo, GST_MAP_READ)) {
+            control->m_dispatcher->push(reinterpret_cast<const char *>(mapInfo.data), mapInfo.size);
+            gst_buffer_unmap(buffer, &mapInfo);
+        }
+        gst_sample_unref(sample);
+        return GST_FLOW_OK;
+    }
     QMetaObject::invokeMethod(control, "newDataAvailable", Qt::AutoConnection, Q_ARG(GstSample *, sample));
 
     return GST_FLOW_OK;
@@ -74,7 +74,8 @@ QT_BEGIN_NAMESPACE
 class GStreamerInputPrivate;
 
 class QGStreamerAudioSource
-    : public QPlatformAudioSource
+    : public QPlatformAudioSource,
+      public QGstreamerBusMessageFilter
 {
     Q_OBJECT
     friend class GStreamerInputPrivate;
@@ -84,6 +85,7 @@ public:
 
     void start(QIODevice *device) override;
     QIODevice *start() override;
+    void start(QAudioCaptureDispatcher *dispatcher) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -111,14 +113,15 @@ private:
     static GstFlowReturn new_sample(GstAppSink *, gpointer user_data);
     static void eos(GstAppSink *, gpointer user_data);
 
+    bool processBusMessage(const QGstreamerMessage &message) override;
+
     bool open();
     void close();
 
-    static gboolean busMessage(GstBus *bus, GstMessage *msg, gpointer user_data);
-
     QAudioDevice m_info;
     qint64 m_bytesWritten = 0;
     QIODevice *m_audioSink = nullptr;
+    QAudioCaptureDispatcher *m_dispatcher = nullptr;
     QAudioFormat m_format;
     QAudio::Error m_errorState = QAudio::NoError;
     QAudio::State m_deviceState = QAudio::StoppedState;
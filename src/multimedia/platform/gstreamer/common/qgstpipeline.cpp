@@ -38,30 +38,39 @@
 ****************************************************************************/
 
 #include <QtCore/qmap.h>
-#include <QtCore/qtimer.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qlist.h>
-#include <QtCore/qabstracteventdispatcher.h>
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qproperty.h>
 
+#include <memory>
+
 #include "qgstpipeline_p.h"
 #include "qgstreamermessage_p.h"
 
 QT_BEGIN_NAMESPACE
 
+// The bus filters installed for one delivery context, together with the
+// messages waiting to be delivered to them on the thread of that context.
+struct QGstBusFilterQueue
+{
+    QObject *context = nullptr;
+    QMutex mutex;
+    QList<QGstreamerBusMessageFilter *> filters;
+    QList<QGstreamerMessage> pendingMessages;
+
+    void processPendingMessages();
+};
+
 class QGstPipelinePrivate : public QObject
 {
     Q_OBJECT
 public:
 
     int m_ref = 0;
-    guint m_tag = 0;
     GstBus *m_bus = nullptr;
-    QTimer *m_intervalTimer = nullptr;
     QMutex filterMutex;
     QList<QGstreamerSyncMessageFilter*> syncFilters;
-    QList<QGstreamerBusMessageFilter*> busFilters;
     bool inStoppedState = true;
     mutable qint64 m_position = 0;
     double m_rate = 1.;
@@ -71,6 +80,11 @@ public:
     int m_configCounter = 0;
     GstState m_savedState = GST_STATE_NULL;
 
+    // One queue per context bus filters were installed with, the first one
+    // delivering on the thread this object lives in. Guarded by queuesMutex.
+    QMutex queuesMutex;
+    QList<std::shared_ptr<QGstBusFilterQueue>> busQueues;
+
     QGstPipelinePrivate(GstBus* bus, QObject* parent = 0);
     ~QGstPipelinePrivate();
 
@@ -79,91 +93,140 @@ public:
 
     void installMessageFilter(QGstreamerSyncMessageFilter *filter);
     void removeMessageFilter(QGstreamerSyncMessageFilter *filter);
-    void installMessageFilter(QGstreamerBusMessageFilter *filter);
+    void installMessageFilter(QGstreamerBusMessageFilter *filter, QObject *context);
     void removeMessageFilter(QGstreamerBusMessageFilter *filter);
 
     static GstBusSyncReply syncGstBusFilter(GstBus* bus, GstMessage* message, QGstPipelinePrivate *d)
     {
         Q_UNUSED(bus);
-        QMutexLocker lock(&d->filterMutex);
-
-        for (QGstreamerSyncMessageFilter *filter : qAsConst(d->syncFilters)) {
-            if (filter->processSyncMessage(QGstreamerMessage(message))) {
-                gst_message_unref(message);
-                return GST_BUS_DROP;
+        {
+            QMutexLocker lock(&d->filterMutex);
+
+            for (QGstreamerSyncMessageFilter *filter : qAsConst(d->syncFilters)) {
+                if (filter->processSyncMessage(QGstreamerMessage(message))) {
+                    gst_message_unref(message);
+                    return GST_BUS_DROP;
+                }
             }
         }
 
-        return GST_BUS_PASS;
+        // Every message goes through here, regardless of whether the application
+        // runs a GLib main loop, so we queue it ourselves instead of leaving it on
+        // the bus to be picked up by a watch or by polling.
+        d->queueMessage(message);
+        gst_message_unref(message);
+        return GST_BUS_DROP;
     }
 
-private Q_SLOTS:
-    void interval()
+private:
+    static bool isCoalescable(GstMessageType type)
     {
-        GstMessage* message;
-        while ((message = gst_bus_poll(m_bus, GST_MESSAGE_ANY, 0)) != nullptr) {
-            processMessage(message);
-            gst_message_unref(message);
-        }
+        return type == GST_MESSAGE_TAG || type == GST_MESSAGE_BUFFERING || type == GST_MESSAGE_QOS;
     }
-    void doProcessMessage(const QGstreamerMessage& msg)
+
+    // Tries to fold message into one that is still pending from the same source.
+    // Only looks back across other coalescable messages, so that the order of
+    // messages relative to state changes, EOS, errors etc. is preserved.
+    static bool coalesceMessage(QList<QGstreamerMessage> &pendingMessages, GstMessage *message)
     {
-        for (QGstreamerBusMessageFilter *filter : qAsConst(busFilters)) {
-            if (filter->processBusMessage(msg))
-                break;
+        const GstMessageType type = GST_MESSAGE_TYPE(message);
+        if (!isCoalescable(type))
+            return false;
+
+        for (qsizetype i = pendingMessages.size() - 1; i >= 0; --i) {
+            GstMessage *pending = pendingMessages.at(i).rawMessage();
+            const GstMessageType pendingType = GST_MESSAGE_TYPE(pending);
+            if (!isCoalescable(pendingType))
+                return false;
+            if (pendingType != type || GST_MESSAGE_SRC(pending) != GST_MESSAGE_SRC(message))
+                continue;
+
+            if (type == GST_MESSAGE_TAG) {
+                GstTagList *pendingTags = nullptr;
+                GstTagList *tags = nullptr;
+                gst_message_parse_tag(pending, &pendingTags);
+                gst_message_parse_tag(message, &tags);
+                GstTagList *merged = gst_tag_list_merge(pendingTags, tags, GST_TAG_MERGE_REPLACE);
+                gst_tag_list_unref(pendingTags);
+                gst_tag_list_unref(tags);
+                GstMessage *mergedMessage = gst_message_new_tag(GST_MESSAGE_SRC(message), merged);
+                pendingMessages[i] = QGstreamerMessage(mergedMessage);
+                gst_message_unref(mergedMessage);
+            } else {
+                // Buffering percentages and QoS statistics are superseded by newer ones
+                pendingMessages[i] = QGstreamerMessage(message);
+            }
+            return true;
         }
+        return false;
     }
 
-private:
-    void processMessage(GstMessage* message)
+    void queueMessage(GstMessage* message)
     {
-        QGstreamerMessage msg(message);
-        doProcessMessage(msg);
+        QMutexLocker lock(&queuesMutex);
+        for (const std::shared_ptr<QGstBusFilterQueue> &queue : qAsConst(busQueues)) {
+            QMutexLocker queueLock(&queue->mutex);
+            if (queue->filters.isEmpty() || coalesceMessage(queue->pendingMessages, message))
+                continue;
+
+            // Only the first message of a batch schedules a delivery, the ones arriving
+            // before it runs are handled by the same invocation. The queue may go away
+            // with the pipeline while the delivery is pending on another thread.
+            const bool scheduleDelivery = queue->pendingMessages.isEmpty();
+            queue->pendingMessages.append(QGstreamerMessage(message));
+            if (scheduleDelivery) {
+                std::weak_ptr<QGstBusFilterQueue> weakQueue = queue;
+                QMetaObject::invokeMethod(queue->context, [weakQueue]() {
+                    if (auto queue = weakQueue.lock())
+                        queue->processPendingMessages();
+                }, Qt::QueuedConnection);
+            }
+        }
     }
+};
 
-    void queueMessage(GstMessage* message)
+void QGstBusFilterQueue::processPendingMessages()
+{
+    QList<QGstreamerMessage> messages;
     {
-        QGstreamerMessage msg(message);
-        QMetaObject::invokeMethod(this, "doProcessMessage", Qt::QueuedConnection,
-                                  Q_ARG(QGstreamerMessage, msg));
+        QMutexLocker lock(&mutex);
+        messages.swap(pendingMessages);
     }
 
-    static gboolean busCallback(GstBus *bus, GstMessage *message, gpointer data)
-    {
-        Q_UNUSED(bus);
-        static_cast<QGstPipelinePrivate *>(data)->queueMessage(message);
-        return TRUE;
+    for (const QGstreamerMessage &msg : qAsConst(messages)) {
+        // Filters may remove themselves or others while handling a message
+        QList<QGstreamerBusMessageFilter *> currentFilters;
+        {
+            QMutexLocker lock(&mutex);
+            currentFilters = filters;
+        }
+        for (QGstreamerBusMessageFilter *filter : qAsConst(currentFilters)) {
+            // A filter removed by an earlier one may already be deleted
+            {
+                QMutexLocker lock(&mutex);
+                if (!filters.contains(filter))
+                    continue;
+            }
+            if (filter->processBusMessage(msg))
+                break;
+        }
     }
-};
+}
 
 QGstPipelinePrivate::QGstPipelinePrivate(GstBus* bus, QObject* parent)
   : QObject(parent),
     m_bus(bus)
 {
-    gst_object_ref(GST_OBJECT(bus));
-
-    // glib event loop can be disabled either by env variable or QT_NO_GLIB define, so check the dispacher
-    QAbstractEventDispatcher *dispatcher = QCoreApplication::eventDispatcher();
-    const bool hasGlib = dispatcher && dispatcher->inherits("QEventDispatcherGlib");
-    if (!hasGlib) {
-        m_intervalTimer = new QTimer(this);
-        m_intervalTimer->setInterval(250);
-        connect(m_intervalTimer, SIGNAL(timeout()), SLOT(interval()));
-        m_intervalTimer->start();
-    } else {
-        m_tag = gst_bus_add_watch_full(bus, G_PRIORITY_DEFAULT, busCallback, this, nullptr);
-    }
+    auto defaultQueue = std::make_shared<QGstBusFilterQueue>();
+    defaultQueue->context = this;
+    busQueues.append(std::move(defaultQueue));
 
+    gst_object_ref(GST_OBJECT(bus));
     gst_bus_set_sync_handler(bus, (GstBusSyncHandler)syncGstBusFilter, this, nullptr);
 }
 
 QGstPipelinePrivate::~QGstPipelinePrivate()
 {
-    delete m_intervalTimer;
-
-    if (m_tag)
-        gst_bus_remove_watch(m_bus);
-
     gst_bus_set_sync_handler(m_bus, nullptr, nullptr, nullptr);
     gst_object_unref(GST_OBJECT(m_bus));
 }
@@ -185,16 +248,44 @@ void QGstPipelinePrivate::removeMessageFilter(QGstreamerSyncMessageFilter *filte
     }
 }
 
-void QGstPipelinePrivate::installMessageFilter(QGstreamerBusMessageFilter *filter)
+void QGstPipelinePrivate::installMessageFilter(QGstreamerBusMessageFilter *filter, QObject *context)
 {
-    if (filter && !busFilters.contains(filter))
-        busFilters.append(filter);
+    if (!filter)
+        return;
+    removeMessageFilter(filter);
+
+    QMutexLocker lock(&queuesMutex);
+    if (!context)
+        context = this;
+    std::shared_ptr<QGstBusFilterQueue> queue;
+    for (const std::shared_ptr<QGstBusFilterQueue> &q : qAsConst(busQueues)) {
+        if (q->context == context)
+            queue = q;
+    }
+    if (!queue) {
+        queue = std::make_shared<QGstBusFilterQueue>();
+        queue->context = context;
+        busQueues.append(queue);
+    }
+    QMutexLocker queueLock(&queue->mutex);
+    queue->filters.append(filter);
 }
 
 void QGstPipelinePrivate::removeMessageFilter(QGstreamerBusMessageFilter *filter)
 {
-    if (filter)
-        busFilters.removeAll(filter);
+    if (!filter)
+        return;
+    QMutexLocker lock(&queuesMutex);
+    for (qsizetype i = busQueues.size() - 1; i >= 0; --i) {
+        const std::shared_ptr<QGstBusFilterQueue> &queue = busQueues.at(i);
+        QMutexLocker queueLock(&queue->mutex);
+        queue->filters.removeAll(filter);
+        // The default queue stays, the others are dropped with their last filter
+        if (i > 0 && queue->filters.isEmpty()) {
+            queueLock.unlock();
+            busQueues.removeAt(i);
+        }
+    }
 }
 
 QGstPipeline::QGstPipeline(const QGstPipeline &o)
@@ -265,10 +356,21 @@ void QGstPipeline::removeMessageFilter(QGstreamerSyncMessageFilter *filter)
     d->removeMessageFilter(filter);
 }
 
-void QGstPipeline::installMessageFilter(QGstreamerBusMessageFilter *filter)
+/*!
+    Installs a bus message filter. Bus messages are delivered to the filter in
+    batches on the thread of \a context, or on the thread the pipeline was
+    created in if \a context is null. Filters sharing a context see the messages
+    in the order they were installed, and a filter returning true hides the
+    message from the filters after it. Filters with different contexts each see
+    every message.
+
+    The context has to outlive the pipeline or the filter's installation, and a
+    filter with a context must be removed from the thread of that context.
+*/
+void QGstPipeline::installMessageFilter(QGstreamerBusMessageFilter *filter, QObject *context)
 {
     Q_ASSERT(d);
-    d->installMessageFilter(filter);
+    d->installMessageFilter(filter, context);
 }
 
 void QGstPipeline::removeMessageFilter(QGstreamerBusMessageFilter *filter)
@@ -98,7 +98,7 @@ public:
 
     void installMessageFilter(QGstreamerSyncMessageFilter *filter);
     void removeMessageFilter(QGstreamerSyncMessageFilter *filter);
-    void installMessageFilter(QGstreamerBusMessageFilter *filter);
+    void installMessageFilter(QGstreamerBusMessageFilter *filter, QObject *context = nullptr);
     void removeMessageFilter(QGstreamerBusMessageFilter *filter);
 
     GstStateChangeReturn setState(GstState state);
@@ -45,6 +45,7 @@
 #include <gst/gstversion.h>
 #include <private/qgstutils_p.h>
 #include <private/qiso639_2_p.h>
+#include <private/qencodedimage_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -201,7 +202,9 @@ static void addTagToMap(const GstTagList *list,
                         if (buffer) {
                             GstMapInfo info;
                             gst_buffer_map(buffer, &info, GST_MAP_READ);
-                            map->insert(key, QImage::fromData(info.data, info.size, name));
+                            // decoded when the image is first used, see QEncodedImage
+                            QByteArray data(reinterpret_cast<const char *>(info.data), info.size);
+                            map->insert(key, QVariant::fromValue(QEncodedImage(data, name)));
                             gst_buffer_unmap(buffer, &info);
                         }
                     }
@@ -0,0 +1,155 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qgstreamermetadatascanner_p.h"
+#include "qgstreamermetadata_p.h"
+
+#include <private/qiso639_2_p.h>
+
+#include <QtCore/qsize.h>
+
+#include <gst/pbutils/pbutils.h>
+
+QT_BEGIN_NAMESPACE
+
+// per file, files that take longer are reported with a TimeoutError
+static constexpr GstClockTime scanTimeout = 10 * GST_SECOND;
+
+QGstreamerMetaDataScanner::QGstreamerMetaDataScanner(QMediaMetaDataScanner *parent)
+    : QPlatformMetaDataScanner(parent)
+{
+}
+
+static QMediaMetaData streamMetaData(GstDiscovererStreamInfo *stream)
+{
+    QMediaMetaData metaData;
+    if (const GstTagList *tags = gst_discoverer_stream_info_get_tags(stream))
+        metaData = QGstreamerMetaData::fromGstTagList(tags);
+
+    if (GST_IS_DISCOVERER_AUDIO_INFO(stream)) {
+        auto *audio = GST_DISCOVERER_AUDIO_INFO(stream);
+        if (uint bitRate = gst_discoverer_audio_info_get_bitrate(audio))
+            metaData.insert(QMediaMetaData::AudioBitRate, int(bitRate));
+    } else if (GST_IS_DISCOVERER_VIDEO_INFO(stream)) {
+        auto *video = GST_DISCOVERER_VIDEO_INFO(stream);
+        metaData.insert(QMediaMetaData::Resolution, QSize(gst_discoverer_video_info_get_width(video),
+                                                          gst_discoverer_video_info_get_height(video)));
+        const uint num = gst_discoverer_video_info_get_framerate_num(video);
+        const uint denom = gst_discoverer_video_info_get_framerate_denom(video);
+        if (num && denom)
+            metaData.insert(QMediaMetaData::VideoFrameRate, double(num) / denom);
+        if (uint bitRate = gst_discoverer_video_info_get_bitrate(video))
+            metaData.insert(QMediaMetaData::VideoBitRate, int(bitRate));
+    } else if (GST_IS_DISCOVERER_SUBTITLE_INFO(stream)) {
+        auto *subtitle = GST_DISCOVERER_SUBTITLE_INFO(stream);
+        if (const gchar *language = gst_discoverer_subtitle_info_get_language(subtitle))
+            metaData.insert(QMediaMetaData::Language, QVariant::fromValue(QtMultimediaPrivate::fromIso639(language)));
+    }
+    return metaData;
+}
+
+static QList<QMediaMetaData> streamsMetaData(GList *streams)
+{
+    QList<QMediaMetaData> tracks;
+    for (GList *stream = streams; stream; stream = stream->next)
+        tracks.append(streamMetaData(GST_DISCOVERER_STREAM_INFO(stream->data)));
+    gst_discoverer_stream_info_list_free(streams);
+    return tracks;
+}
+
+/*
+    Runs a GstDiscoverer on the url: it only prerolls the decoders, without
+    sinks or clock, which is much cheaper than a playback pipeline. Each call
+    uses its own discoverer, so calls from several threads don't interfere.
+*/
+QPlatformMetaDataScanner::Result QGstreamerMetaDataScanner::scanUrl(const QUrl &url)
+{
+    Result result;
+
+    GError *error = nullptr;
+    GstDiscoverer *discoverer = gst_discoverer_new(scanTimeout, &error);
+    if (!discoverer) {
+        result.error = QMediaMetaDataScanner::NotSupportedError;
+        result.errorString = error ? QString::fromUtf8(error->message) : QString();
+        g_clear_error(&error);
+        return result;
+    }
+
+    GstDiscovererInfo *info = gst_discoverer_discover_uri(discoverer, url.toEncoded().constData(), &error);
+    const GstDiscovererResult discovererResult = info ? gst_discoverer_info_get_result(info) : GST_DISCOVERER_ERROR;
+
+    switch (discovererResult) {
+    case GST_DISCOVERER_OK:
+        break;
+    case GST_DISCOVERER_TIMEOUT:
+        result.error = QMediaMetaDataScanner::TimeoutError;
+        result.errorString = QMediaMetaDataScanner::tr("Timed out reading the file");
+        break;
+    case GST_DISCOVERER_MISSING_PLUGINS:
+        result.error = QMediaMetaDataScanner::FormatError;
+        result.errorString = QMediaMetaDataScanner::tr("The file format is not supported");
+        break;
+    default:
+        result.error = QMediaMetaDataScanner::ResourceError;
+        result.errorString = error ? QString::fromUtf8(error->message)
+                                   : QMediaMetaDataScanner::tr("Could not read the file");
+        break;
+    }
+    g_clear_error(&error);
+
+    if (result.error == QMediaMetaDataScanner::NoError) {
+        if (const GstTagList *tags = gst_discoverer_info_get_tags(info))
+            result.metaData = QGstreamerMetaData::fromGstTagList(tags);
+        const GstClockTime duration = gst_discoverer_info_get_duration(info);
+        if (GST_CLOCK_TIME_IS_VALID(duration))
+            result.metaData.insert(QMediaMetaData::Duration, qint64(duration / GST_MSECOND));
+
+        result.tracks[QPlatformMediaPlayer::AudioStream] = streamsMetaData(gst_discoverer_info_get_audio_streams(info));
+        result.tracks[QPlatformMediaPlayer::VideoStream] = streamsMetaData(gst_discoverer_info_get_video_streams(info));
+        result.tracks[QPlatformMediaPlayer::SubtitleStream] = streamsMetaData(gst_discoverer_info_get_subtitle_streams(info));
+    }
+
+    if (info)
+        gst_discoverer_info_unref(info);
+    g_object_unref(discoverer);
+    return result;
+}
+
+QT_END_NAMESPACE
@@ -84,6 +84,32 @@ QGstVideoRenderer::~QGstVideoRenderer()
 {
 }
 
+QList<QVideoFrameFormat::PixelFormat> QGstVideoRenderer::supportedPixelFormats()
+{
+    // All the formats that both we and gstreamer support
+    return QList<QVideoFrameFormat::PixelFormat>()
+           << QVideoFrameFormat::Format_YUV420P
+           << QVideoFrameFormat::Format_YUV422P
+           << QVideoFrameFormat::Format_YV12
+           << QVideoFrameFormat::Format_UYVY
+           << QVideoFrameFormat::Format_YUYV
+           << QVideoFrameFormat::Format_NV12
+           << QVideoFrameFormat::Format_NV21
+           << QVideoFrameFormat::Format_AYUV
+           << QVideoFrameFormat::Format_P010
+           << QVideoFrameFormat::Format_XRGB8888
+           << QVideoFrameFormat::Format_XBGR8888
+           << QVideoFrameFormat::Format_RGBX8888
+           << QVideoFrameFormat::Format_BGRX8888
+           << QVideoFrameFormat::Format_ARGB8888
+           << QVideoFrameFormat::Format_ABGR8888
+           << QVideoFrameFormat::Format_RGBA8888
+           << QVideoFrameFormat::Format_BGRA8888
+           << QVideoFrameFormat::Format_Y8
+           << QVideoFrameFormat::Format_Y16
+        ;
+}
+
 void QGstVideoRenderer::createSurfaceCaps()
 {
     QRhi *rhi = m_sink->rhi();
@@ -92,28 +118,7 @@ void QGstVideoRenderer::createSurfaceCaps()
     QGstMutableCaps caps;
     caps.create();
 
-    // All the formats that both we and gstreamer support
-    auto formats = QList<QVideoFrameFormat::PixelFormat>()
-                   << QVideoFrameFormat::Format_YUV420P
-                   << QVideoFrameFormat::Format_YUV422P
-                   << QVideoFrameFormat::Format_YV12
-                   << QVideoFrameFormat::Format_UYVY
-                   << QVideoFrameFormat::Format_YUYV
-                   << QVideoFrameFormat::Format_NV12
-                   << QVideoFrameFormat::Format_NV21
-                   << QVideoFrameFormat::Format_AYUV
-                   << QVideoFrameFormat::Format_P010
-                   << QVideoFrameFormat::Format_XRGB8888
-                   << QVideoFrameFormat::Format_XBGR8888
-                   << QVideoFrameFormat::Format_RGBX8888
-                   << QVideoFrameFormat::Format_BGRX8888
-                   << QVideoFrameFormat::Format_ARGB8888
-                   << QVideoFrameFormat::Format_ABGR8888
-                   << QVideoFrameFormat::Format_RGBA8888
-                   << QVideoFrameFormat::Format_BGRA8888
-                   << QVideoFrameFormat::Format_Y8
-                   << QVideoFrameFormat::Format_Y16
-        ;
+    const auto formats = supportedPixelFormats();
 #if QT_CONFIG(gstreamer_gl)
     if (rhi && rhi->backend() == QRhi::OpenGLES2) {
         caps.addPixelFormats(formats, GST_CAPS_FEATURE_MEMORY_GL_MEMORY);
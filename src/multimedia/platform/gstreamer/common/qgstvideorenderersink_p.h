@@ -77,6 +77,10 @@ public:
 
     QGstMutableCaps caps();
 
+    // Formats the renderer accepts in system memory, i.e. that QVideoTextureHelper
+    // can upload and sample without any conversion in the pipeline
+    static QList<QVideoFrameFormat::PixelFormat> supportedPixelFormats();
+
     bool start(GstCaps *caps);
     void stop();
     void unlock();
@@ -43,6 +43,7 @@
 #include "qgstreamerimagecapture_p.h"
 #include <private/qgstreamermediadevices_p.h>
 #include <private/qgstreamerintegration_p.h>
+#include <private/qgstvideorenderersink_p.h>
 #include <qmediacapturesession.h>
 
 #if QT_CONFIG(linux_v4l)
@@ -55,15 +56,16 @@
 QGstreamerCamera::QGstreamerCamera(QCamera *camera)
         : QPlatformCamera(camera)
 {
+    // The camera bin does not convert or scale: every consumer behind the capture
+    // session's tee (video output, image capture, encodebin) converts on its own
+    // if needed, so frames in a format the video sink can render are passed on
+    // untouched.
     gstCamera = QGstElement("videotestsrc");
     gstCapsFilter = QGstElement("capsfilter", "videoCapsFilter");
-    gstDecode = QGstElement("identity");
-    gstVideoConvert = QGstElement("videoconvert", "videoConvert");
-    gstVideoScale = QGstElement("videoscale", "videoScale");
     gstCameraBin = QGstBin("camerabin");
-    gstCameraBin.add(gstCamera, gstCapsFilter, gstDecode, gstVideoConvert, gstVideoScale);
-    gstCamera.link(gstCapsFilter, gstDecode, gstVideoConvert, gstVideoScale);
-    gstCameraBin.addGhostPad(gstVideoScale, "src");
+    gstCameraBin.add(gstCamera, gstCapsFilter);
+    gstCamera.link(gstCapsFilter);
+    gstCameraBin.addGhostPad(gstCapsFilter, "src");
 }
 
 QGstreamerCamera::~QGstreamerCamera()
@@ -93,6 +95,86 @@ void QGstreamerCamera::setActive(bool active)
     emit activeChanged(active);
 }
 
+// Among equally good formats, prefer the ones the video sink can render directly
+// over those that need decoding or conversion.
+static bool isNativeCameraFormat(const QCameraFormat &format)
+{
+    return QGstVideoRenderer::supportedPixelFormats().contains(format.pixelFormat());
+}
+
+// Picks the highest ranked decoder that turns JPEG into raw video. Hardware
+// decoders (v4l2jpegdec, vaapijpegdec, nvjpegdec, ...) usually have a higher rank
+// than the software jpegdec and are preferred when they are installed.
+// QT_GSTREAMER_CAMERA_JPEG_DECODER can be used to force a specific element.
+static GstElementFactory *jpegDecoderFactory()
+{
+    static GstElementFactory *factory = []() -> GstElementFactory * {
+        const QByteArray forced = qgetenv("QT_GSTREAMER_CAMERA_JPEG_DECODER");
+        if (!forced.isEmpty()) {
+            if (auto *f = gst_element_factory_find(forced.constData()))
+                return f;
+            qWarning() << "Requested JPEG decoder" << forced << "is not available";
+        }
+
+        QGstMutableCaps jpegCaps(gst_caps_new_empty_simple("image/jpeg"), QGstMutableCaps::HasRef);
+        QGstMutableCaps rawCaps(gst_caps_new_empty_simple("video/x-raw"), QGstMutableCaps::HasRef);
+
+        GList *decoders = gst_element_factory_list_get_elements(GST_ELEMENT_FACTORY_TYPE_DECODER,
+                                                                GST_RANK_MARGINAL);
+        GList *jpegDecoders = gst_element_factory_list_filter(decoders, jpegCaps.get(), GST_PAD_SINK, false);
+        jpegDecoders = g_list_sort(jpegDecoders, gst_plugin_feature_rank_compare_func);
+
+        GstElementFactory *best = nullptr;
+        for (GList *l = jpegDecoders; l; l = l->next) {
+            auto *f = GST_ELEMENT_FACTORY(l->data);
+            if (gst_element_factory_can_src_any_caps(f, rawCaps.get())) {
+                best = GST_ELEMENT_FACTORY(gst_object_ref(f));
+                break;
+            }
+        }
+        gst_plugin_feature_list_free(jpegDecoders);
+        gst_plugin_feature_list_free(decoders);
+        return best;
+    }();
+    return factory;
+}
+
+// Returns the element needed to turn the camera output into raw video, or a null
+// element if the camera delivers raw video already.
+static QGstElement createDecoder(const QCameraFormat &format)
+{
+    if (format.pixelFormat() != QVideoFrameFormat::Format_Jpeg)
+        return {};
+
+    auto *factory = jpegDecoderFactory();
+    QGstElement decoder = factory ? QGstElement(gst_element_factory_create(factory, nullptr))
+                                  : QGstElement("jpegdec");
+    if (decoder.isNull())
+        return {};
+
+    // Decode on a streaming thread of its own, so that capturing the next frame
+    // overlaps with decoding the current one. The decoded frames feed the
+    // recorder as well, so the queue must not drop any: when decoding falls
+    // behind it blocks, and the camera source drops frames at the device.
+    // Unnamed, setCameraFormat() adds the new decoder before removing the old.
+    QGstBin bin(GST_BIN(gst_bin_new(nullptr)));
+    QGstElement queue("queue");
+    queue.set("max-size-buffers", 2);
+    queue.set("max-size-bytes", 0);
+    queue.set("max-size-time", quint64(0));
+    bin.add(queue, decoder);
+    queue.link(decoder);
+    bin.addGhostPad(queue, "sink");
+    bin.addGhostPad(decoder, "src");
+    return bin;
+}
+
+void QGstreamerCamera::setSourceElement(const QGstElement &element)
+{
+    QGstPad ghostPad = gstCameraBin.staticPad("src");
+    gst_ghost_pad_set_target(GST_GHOST_PAD(ghostPad.pad()), element.staticPad("src").pad());
+}
+
 void QGstreamerCamera::setCamera(const QCameraDevice &camera)
 {
     if (m_cameraDevice == camera)
@@ -112,26 +194,29 @@ void QGstreamerCamera::setCamera(const QCameraDevice &camera)
             m_v4l2Device = QString::fromUtf8(properties["device.path"].toString());
     }
 
-    QCameraFormat f = findBestCameraFormat(camera);
+    QCameraFormat f = findBestCameraFormat(camera, isNativeCameraFormat);
     auto caps = QGstMutableCaps::fromCameraFormat(f);
-    auto gstNewDecode = QGstElement(f.pixelFormat() == QVideoFrameFormat::Format_Jpeg ? "jpegdec" : "identity");
+    auto gstNewDecode = createDecoder(f);
 
     gstCamera.unlink(gstCapsFilter);
-    gstCapsFilter.unlink(gstDecode);
-    gstDecode.unlink(gstVideoConvert);
+    if (!gstDecode.isNull())
+        gstCapsFilter.unlink(gstDecode);
 
     gstCameraBin.remove(gstCamera);
-    gstCameraBin.remove(gstDecode);
-
     gstCamera.setStateSync(GST_STATE_NULL);
-    gstDecode.setStateSync(GST_STATE_NULL);
+    if (!gstDecode.isNull()) {
+        gstCameraBin.remove(gstDecode);
+        gstDecode.setStateSync(GST_STATE_NULL);
+    }
 
     gstCapsFilter.set("caps", caps);
 
-    gstCameraBin.add(gstNewCamera, gstNewDecode);
-
-    gstNewDecode.link(gstVideoConvert);
-    gstCapsFilter.link(gstNewDecode);
+    gstCameraBin.add(gstNewCamera);
+    if (!gstNewDecode.isNull()) {
+        gstCameraBin.add(gstNewDecode);
+        gstCapsFilter.link(gstNewDecode);
+    }
+    setSourceElement(gstNewDecode.isNull() ? gstCapsFilter : gstNewDecode);
 
     if (!gstNewCamera.link(gstCapsFilter))
         qWarning() << "linking camera failed" << gstCamera.name() << caps.toString();
@@ -139,7 +224,8 @@ void QGstreamerCamera::setCamera(const QCameraDevice &camera)
     // Start sending frames once pipeline is linked
     // FIXME: put camera to READY state before linking to decoder as in the NULL state it does not know its true caps
     gstCapsFilter.syncStateWithParent();
-    gstNewDecode.syncStateWithParent();
+    if (!gstNewDecode.isNull())
+        gstNewDecode.syncStateWithParent();
     gstNewCamera.syncStateWithParent();
 
     gstCamera = gstNewCamera;
@@ -155,29 +241,34 @@ bool QGstreamerCamera::setCameraFormat(const QCameraFormat &format)
 
     QCameraFormat f = format;
     if (f.isNull())
-        f = findBestCameraFormat(m_cameraDevice);
+        f = findBestCameraFormat(m_cameraDevice, isNativeCameraFormat);
 
     auto caps = QGstMutableCaps::fromCameraFormat(f);
 
-    auto newGstDecode = QGstElement(f.pixelFormat() == QVideoFrameFormat::Format_Jpeg ? "jpegdec" : "identity");
-    gstCameraBin.add(newGstDecode);
-    newGstDecode.syncStateWithParent();
+    auto newGstDecode = createDecoder(f);
+    if (!newGstDecode.isNull()) {
+        gstCameraBin.add(newGstDecode);
+        newGstDecode.syncStateWithParent();
+    }
 
     gstCamera.staticPad("src").doInIdleProbe([&](){
         gstCamera.unlink(gstCapsFilter);
-        gstCapsFilter.unlink(gstDecode);
-        gstDecode.unlink(gstVideoConvert);
+        if (!gstDecode.isNull())
+            gstCapsFilter.unlink(gstDecode);
 
         gstCapsFilter.set("caps", caps);
 
-        newGstDecode.link(gstVideoConvert);
-        gstCapsFilter.link(newGstDecode);
+        if (!newGstDecode.isNull())
+            gstCapsFilter.link(newGstDecode);
+        setSourceElement(newGstDecode.isNull() ? gstCapsFilter : newGstDecode);
         if (!gstCamera.link(gstCapsFilter))
             qWarning() << "linking filtered camera to decoder failed" << gstCamera.name() << caps.toString();
     });
 
-    gstCameraBin.remove(gstDecode);
-    gstDecode.setStateSync(GST_STATE_NULL);
+    if (!gstDecode.isNull()) {
+        gstCameraBin.remove(gstDecode);
+        gstDecode.setStateSync(GST_STATE_NULL);
+    }
 
     gstDecode = newGstDecode;
 
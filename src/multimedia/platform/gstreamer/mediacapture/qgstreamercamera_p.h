@@ -101,6 +101,7 @@ public:
 
 private:
     void updateCameraProperties();
+    void setSourceElement(const QGstElement &element);
 #if QT_CONFIG(linux_v4l)
     void initV4L2Controls();
     int setV4L2ColorTemperature(int temperature);
@@ -126,8 +127,6 @@ private:
     QGstElement gstCamera;
     QGstElement gstCapsFilter;
     QGstElement gstDecode;
-    QGstElement gstVideoConvert;
-    QGstElement gstVideoScale;
 
     bool m_active = false;
     QString m_v4l2Device;
@@ -0,0 +1,355 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qgstreamerencodersettings_p.h"
+
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qthread.h>
+
+#include <array>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(qLcEncoderSettings, "qt.multimedia.encoder.settings")
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Indexed by QMediaRecorder::Quality
+template <typename T>
+using QualityTable = std::array<T, QMediaRecorder::VeryHighQuality + 1>;
+
+template <typename T>
+T forQuality(const QualityTable<T> &table, QMediaRecorder::Quality quality)
+{
+    return table[qBound(0, int(quality), int(table.size()) - 1)];
+}
+
+// Properties are set from strings, so that the enum nicks and numeric types of
+// the various encoders don't matter. Properties the installed version of an
+// element doesn't have are skipped.
+void setProperty(GstElement *element, const char *name, const QByteArray &value)
+{
+    if (!g_object_class_find_property(G_OBJECT_GET_CLASS(element), name))
+        return;
+    qCDebug(qLcEncoderSettings) << "  " << name << "=" << value;
+    gst_util_set_object_arg(G_OBJECT(element), name, value.constData());
+}
+
+void setProperty(GstElement *element, const char *name, int value)
+{
+    setProperty(element, name, QByteArray::number(value));
+}
+
+// Live encoding can't do two passes, fall back to a bitrate target
+bool usesBitrate(const QMediaEncoderSettings &settings, int bitrate)
+{
+    return settings.encodingMode() != QMediaRecorder::ConstantQualityEncoding && bitrate > 0;
+}
+
+bool isConstantBitrate(const QMediaEncoderSettings &settings)
+{
+    return settings.encodingMode() == QMediaRecorder::ConstantBitRateEncoding;
+}
+
+// All presets lean towards speed, this is used for live capture
+const QualityTable<const char *> x26xSpeedPresets = { "ultrafast", "superfast", "veryfast", "faster", "medium" };
+const QualityTable<int> x26xCrf = { 35, 28, 23, 20, 18 };
+
+void configureX264(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    setProperty(encoder, "tune", "zerolatency");
+    setProperty(encoder, "speed-preset", forQuality(x26xSpeedPresets, settings.quality()));
+    setProperty(encoder, "threads", 0);
+
+    if (usesBitrate(settings, settings.videoBitRate())) {
+        setProperty(encoder, "pass", "cbr");
+        setProperty(encoder, "bitrate", settings.videoBitRate() / 1000);
+        if (isConstantBitrate(settings))
+            setProperty(encoder, "vbv-buf-capacity", 1000);
+    } else {
+        setProperty(encoder, "pass", "qual");
+        setProperty(encoder, "quantizer", forQuality(x26xCrf, settings.quality()));
+    }
+}
+
+void configureX265(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    setProperty(encoder, "tune", "zerolatency");
+    setProperty(encoder, "speed-preset", forQuality(x26xSpeedPresets, settings.quality()));
+
+    if (usesBitrate(settings, settings.videoBitRate()))
+        setProperty(encoder, "bitrate", settings.videoBitRate() / 1000);
+    else
+        setProperty(encoder, "option-string", "crf=" + QByteArray::number(forQuality(x26xCrf, settings.quality())));
+}
+
+void configureVpx(GstElement *encoder, const QMediaEncoderSettings &settings, bool vp9)
+{
+    // Higher cpu-used is faster, VP9 accepts up to 8 in realtime mode, VP8 up to 16
+    static const QualityTable<int> vp8CpuUsed = { 16, 12, 8, 4, 2 };
+    static const QualityTable<int> vp9CpuUsed = { 8, 7, 6, 5, 4 };
+    static const QualityTable<int> cqLevel = { 50, 40, 31, 24, 16 };
+
+    setProperty(encoder, "deadline", 1); // realtime
+    setProperty(encoder, "lag-in-frames", 0);
+    setProperty(encoder, "cpu-used", forQuality(vp9 ? vp9CpuUsed : vp8CpuUsed, settings.quality()));
+    setProperty(encoder, "threads", QThread::idealThreadCount());
+    if (vp9)
+        setProperty(encoder, "row-mt", "true");
+
+    if (usesBitrate(settings, settings.videoBitRate())) {
+        setProperty(encoder, "end-usage", isConstantBitrate(settings) ? "cbr" : "vbr");
+        setProperty(encoder, "target-bitrate", settings.videoBitRate());
+    } else {
+        setProperty(encoder, "end-usage", "cq");
+        setProperty(encoder, "cq-level", forQuality(cqLevel, settings.quality()));
+        setProperty(encoder, "min-quantizer", forQuality(cqLevel, settings.quality()) / 2);
+    }
+}
+
+void configureTheora(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    static const QualityTable<int> quality = { 16, 24, 32, 48, 60 };
+    static const QualityTable<int> speedLevel = { 2, 2, 1, 1, 0 };
+
+    setProperty(encoder, "speed-level", forQuality(speedLevel, settings.quality()));
+    if (usesBitrate(settings, settings.videoBitRate()))
+        setProperty(encoder, "bitrate", settings.videoBitRate() / 1000);
+    else
+        setProperty(encoder, "quality", forQuality(quality, settings.quality()));
+}
+
+void configureHardwareVideo(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    // vaapi and nvenc both take kbit/s
+    static const QualityTable<const char *> nvencPresets = { "low-latency-hp", "low-latency-hp", "low-latency",
+                                                             "low-latency-hq", "low-latency-hq" };
+    static const QualityTable<int> qp = { 38, 32, 26, 22, 18 };
+
+    setProperty(encoder, "preset", forQuality(nvencPresets, settings.quality()));
+    setProperty(encoder, "zerolatency", "true");
+
+    if (usesBitrate(settings, settings.videoBitRate())) {
+        const char *mode = isConstantBitrate(settings) ? "cbr" : "vbr";
+        setProperty(encoder, "rate-control", mode);
+        setProperty(encoder, "rc-mode", mode);
+        setProperty(encoder, "bitrate", settings.videoBitRate() / 1000);
+    } else {
+        setProperty(encoder, "rate-control", "cqp");
+        setProperty(encoder, "rc-mode", "constqp");
+        setProperty(encoder, "init-qp", forQuality(qp, settings.quality()));
+        setProperty(encoder, "qp-const", forQuality(qp, settings.quality()));
+    }
+}
+
+void configureLibav(GstElement *encoder, const QMediaEncoderSettings &settings, bool isVideo)
+{
+    // libav encoders take bit/s
+    static const QualityTable<int> audioBitrates = { 64000, 96000, 128000, 160000, 192000 };
+
+    setProperty(encoder, "threads", 0);
+    int bitrate = isVideo ? settings.videoBitRate() : settings.audioBitRate();
+    if (!isVideo && bitrate <= 0)
+        bitrate = forQuality(audioBitrates, settings.quality());
+    if (bitrate > 0)
+        setProperty(encoder, "bitrate", bitrate);
+}
+
+void configureOpus(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    static const QualityTable<int> bitrates = { 32000, 64000, 96000, 128000, 192000 };
+
+    const bool bitrateMode = usesBitrate(settings, settings.audioBitRate());
+    setProperty(encoder, "bitrate-type", isConstantBitrate(settings) ? "cbr" : bitrateMode ? "constrained-vbr" : "vbr");
+    setProperty(encoder, "bitrate", bitrateMode ? settings.audioBitRate() : forQuality(bitrates, settings.quality()));
+}
+
+void configureVorbis(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    static const QualityTable<const char *> quality = { "0.1", "0.3", "0.4", "0.6", "0.8" };
+
+    if (usesBitrate(settings, settings.audioBitRate())) {
+        setProperty(encoder, "bitrate", settings.audioBitRate());
+        if (isConstantBitrate(settings)) {
+            setProperty(encoder, "min-bitrate", settings.audioBitRate());
+            setProperty(encoder, "max-bitrate", settings.audioBitRate());
+        }
+    } else {
+        setProperty(encoder, "quality", forQuality(quality, settings.quality()));
+    }
+}
+
+void configureLame(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    // 0 is the best VBR quality
+    static const QualityTable<const char *> quality = { "8", "6", "4", "2", "0" };
+    static const QualityTable<const char *> engine = { "fast", "fast", "standard", "standard", "high" };
+
+    setProperty(encoder, "encoding-engine-quality", forQuality(engine, settings.quality()));
+    if (usesBitrate(settings, settings.audioBitRate())) {
+        setProperty(encoder, "target", "bitrate");
+        setProperty(encoder, "bitrate", settings.audioBitRate() / 1000);
+        setProperty(encoder, "cbr", isConstantBitrate(settings) ? "true" : "false");
+    } else {
+        setProperty(encoder, "target", "quality");
+        setProperty(encoder, "quality", forQuality(quality, settings.quality()));
+    }
+}
+
+void configureAac(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    static const QualityTable<int> bitrates = { 64000, 96000, 128000, 160000, 192000 };
+
+    setProperty(encoder, "bitrate", usesBitrate(settings, settings.audioBitRate())
+                        ? settings.audioBitRate() : forQuality(bitrates, settings.quality()));
+}
+
+void configureFlac(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    // Lossless, quality only trades CPU time against file size
+    static const QualityTable<int> compression = { 0, 2, 5, 6, 8 };
+    setProperty(encoder, "quality", forQuality(compression, settings.quality()));
+}
+
+void deepElementAdded(GstBin *, GstBin *, GstElement *element, gpointer userData)
+{
+    auto *settings = static_cast<const QMediaEncoderSettings *>(userData);
+    QGstreamerEncoderSettings::configureEncoder(element, *settings);
+}
+
+}
+
+QGstMutableCaps QGstreamerEncoderSettings::videoRestriction(const QMediaEncoderSettings &settings)
+{
+    const QSize resolution = settings.videoResolution();
+    const qreal frameRate = settings.videoFrameRate();
+    if (!resolution.isValid() && frameRate <= 0)
+        return {};
+
+    GstStructure *structure = gst_structure_new_empty("video/x-raw");
+    if (resolution.isValid())
+        gst_structure_set(structure, "width", G_TYPE_INT, resolution.width(),
+                          "height", G_TYPE_INT, resolution.height(), nullptr);
+    if (frameRate > 0) {
+        int n, d;
+        gst_util_double_to_fraction(frameRate, &n, &d);
+        gst_structure_set(structure, "framerate", GST_TYPE_FRACTION, n, d, nullptr);
+    }
+
+    QGstMutableCaps caps;
+    caps.create();
+    gst_caps_append_structure(caps.get(), structure);
+    return caps;
+}
+
+QGstMutableCaps QGstreamerEncoderSettings::audioRestriction(const QMediaEncoderSettings &settings)
+{
+    const int sampleRate = settings.audioSampleRate();
+    const int channels = settings.audioChannelCount();
+    if (sampleRate <= 0 && channels <= 0)
+        return {};
+
+    GstStructure *structure = gst_structure_new_empty("audio/x-raw");
+    if (sampleRate > 0)
+        gst_structure_set(structure, "rate", G_TYPE_INT, sampleRate, nullptr);
+    if (channels > 0)
+        gst_structure_set(structure, "channels", G_TYPE_INT, channels, nullptr);
+
+    QGstMutableCaps caps;
+    caps.create();
+    gst_caps_append_structure(caps.get(), structure);
+    return caps;
+}
+
+bool QGstreamerEncoderSettings::configureEncoder(GstElement *encoder, const QMediaEncoderSettings &settings)
+{
+    GstElementFactory *factory = gst_element_get_factory(encoder);
+    if (!factory)
+        return false;
+
+    const char *klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+    if (!klass || !strstr(klass, "Encoder"))
+        return false;
+    const bool isVideo = strstr(klass, "Video");
+    const bool isAudio = strstr(klass, "Audio");
+    if (!isVideo && !isAudio)
+        return false;
+
+    const QByteArray name = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory));
+    qCDebug(qLcEncoderSettings) << "configuring" << name << settings.quality() << settings.encodingMode();
+
+    if (name == "x264enc")
+        configureX264(encoder, settings);
+    else if (name == "x265enc")
+        configureX265(encoder, settings);
+    else if (name == "vp8enc" || name == "vp9enc")
+        configureVpx(encoder, settings, name == "vp9enc");
+    else if (name == "theoraenc")
+        configureTheora(encoder, settings);
+    else if (name.startsWith("vaapi") || name.startsWith("nvh26") || name.startsWith("nvcudah26"))
+        configureHardwareVideo(encoder, settings);
+    else if (name.startsWith("avenc_"))
+        configureLibav(encoder, settings, isVideo);
+    else if (name == "opusenc")
+        configureOpus(encoder, settings);
+    else if (name == "vorbisenc")
+        configureVorbis(encoder, settings);
+    else if (name == "lamemp3enc")
+        configureLame(encoder, settings);
+    else if (name == "fdkaacenc" || name == "voaacenc" || name == "faac")
+        configureAac(encoder, settings);
+    else if (name == "flacenc")
+        configureFlac(encoder, settings);
+    else
+        return false;
+
+    return true;
+}
+
+void QGstreamerEncoderSettings::install(QGstElement encodeBin, const QMediaEncoderSettings &settings)
+{
+    g_signal_connect_data(encodeBin.object(), "deep-element-added", G_CALLBACK(deepElementAdded),
+                          new QMediaEncoderSettings(settings),
+                          [](gpointer data, GClosure *) { delete static_cast<QMediaEncoderSettings *>(data); },
+                          GConnectFlags(0));
+}
+
+QT_END_NAMESPACE
@@ -48,17 +48,26 @@
 
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
+#include <QtCore/QFileInfo>
 #include <qstandardpaths.h>
 
 #include <qloggingcategory.h>
 
+#include <gst/app/gstappsrc.h>
+
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(qLcImageCapture, "qt.multimedia.imageCapture")
 
+// encoded images, that may wait to be written before encoding blocks
+static constexpr int MaxPendingWrites = 8;
+// previews are scaled down to fit into this size
+static constexpr QSize MaxPreviewSize(1920, 1080);
+
 QGstreamerImageCapture::QGstreamerImageCapture(QImageCapture *parent)
   : QPlatformImageCapture(parent),
-    QGstreamerBufferProbe(ProbeBuffers)
+    QGstreamerBufferProbe(ProbeBuffers),
+    m_writeQueue(MaxPendingWrites)
 {
     bin = QGstBin("imageCaptureBin");
 
@@ -70,32 +79,94 @@ QGstreamerImageCapture::QGstreamerImageCapture(QImageCapture *parent)
     queue.set("max-size-bytes", uint(0));
     queue.set("max-size-time", quint64(0));
 
-    videoConvert = QGstElement("videoconvert", "imageCaptureConvert");
-    encoder = QGstElement("jpegenc", "jpegEncoder");
-    muxer = QGstElement("jifmux", "jpegMuxer");
     sink = QGstElement("fakesink","imageCaptureSink");
     // imageCaptureSink do not wait for a preroll buffer when going READY -> PAUSED
-    // as no buffer will arrive until capture() is called
+    // as captured frames are handed to the encoder slots and never reach it
     sink.set("async", false);
 
-    bin.add(queue, videoConvert, encoder, muxer, sink);
-    queue.link(videoConvert, encoder, muxer, sink);
+    bin.add(queue, sink);
+    queue.link(sink);
     bin.addGhostPad(queue, "sink");
 
     addProbeToPad(queue.staticPad("src").pad(), false);
 
-    sink.set("signal-handoffs", true);
-    g_signal_connect(sink.object(), "handoff", G_CALLBACK(&QGstreamerImageCapture::saveImageFilter), this);
+    addEncoderSlot();
 }
 
 QGstreamerImageCapture::~QGstreamerImageCapture()
 {
     bin.setStateSync(GST_STATE_NULL);
+    m_workers.waitForDone();
+}
+
+void QGstreamerImageCapture::addEncoderSlot()
+{
+    auto slot = std::make_unique<EncoderSlot>();
+    const QByteArray index = QByteArray::number(int(encoderSlots.size()));
+
+    slot->capture = this;
+    slot->appSrc = QGstElement("appsrc", QByteArray("imageCaptureSrc" + index).constData());
+    slot->appSrc.set("is-live", true);
+    slot->appSrc.set("format", int(GST_FORMAT_TIME));
+    slot->videoConvert = QGstElement("videoconvert", QByteArray("imageCaptureConvert" + index).constData());
+    slot->encoder = QGstElement("jpegenc", QByteArray("jpegEncoder" + index).constData());
+    slot->muxer = QGstElement("jifmux", QByteArray("jpegMuxer" + index).constData());
+    slot->sink = QGstElement("fakesink", QByteArray("imageEncoderSink" + index).constData());
+    slot->sink.set("async", false);
+    slot->sink.set("sync", false);
+
+    bin.add(slot->appSrc, slot->videoConvert, slot->encoder, slot->muxer, slot->sink);
+    slot->appSrc.link(slot->videoConvert, slot->encoder, slot->muxer, slot->sink);
+
+    slot->sink.set("signal-handoffs", true);
+    g_signal_connect(slot->sink.object(), "handoff", G_CALLBACK(&QGstreamerImageCapture::saveImageFilter), slot.get());
+
+    for (auto *element : { &slot->appSrc, &slot->videoConvert, &slot->encoder, &slot->muxer, &slot->sink })
+        element->syncStateWithParent();
+
+    QMutexLocker locker(&m_mutex);
+    encoderSlots.push_back(std::move(slot));
 }
 
 bool QGstreamerImageCapture::isReadyForCapture() const
 {
-    return m_session && !passImage && cameraActive;
+    return canCapture();
+}
+
+bool QGstreamerImageCapture::canCapture() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_session && cameraActive && m_pendingCount < m_maximumPendingImages;
+}
+
+void QGstreamerImageCapture::updateReadyForCapture()
+{
+    const bool ready = isReadyForCapture();
+    if (m_readyForCapture == ready)
+        return;
+    m_readyForCapture = ready;
+    qCDebug(qLcImageCapture) << "isReady" << ready;
+    emit readyForCaptureChanged(ready);
+}
+
+int QGstreamerImageCapture::maximumPendingImages() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maximumPendingImages;
+}
+
+void QGstreamerImageCapture::setMaximumPendingImages(int count)
+{
+    count = qMax(count, 1);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_maximumPendingImages = count;
+    }
+    // slots are only ever added, spare ones just stay idle
+    while (int(encoderSlots.size()) < count)
+        addEncoderSlot();
+
+    updateReadyForCapture();
 }
 
 int QGstreamerImageCapture::capture(const QString &fileName)
@@ -109,9 +180,30 @@ int QGstreamerImageCapture::captureToBuffer()
     return doCapture(QString());
 }
 
-int QGstreamerImageCapture::doCapture(const QString &fileName)
+int QGstreamerImageCapture::captureBurst(int count, int frameInterval, const QString &fileName)
 {
-    qCDebug(qLcImageCapture) << "do capture";
+    QString path = QMediaStorageLocation::generateFileName(fileName, QStandardPaths::PicturesLocation, QLatin1String("jpg"));
+    return doCapture(path, count, frameInterval);
+}
+
+int QGstreamerImageCapture::captureBurstToBuffer(int count, int frameInterval)
+{
+    return doCapture(QString(), count, frameInterval);
+}
+
+static QString burstFileName(const QString &fileName, int index)
+{
+    const QFileInfo info(fileName);
+    QString name = info.path() + QLatin1Char('/') + info.completeBaseName()
+            + QStringLiteral("_%1").arg(index, 4, 10, QLatin1Char('0'));
+    if (!info.suffix().isEmpty())
+        name += QLatin1Char('.') + info.suffix();
+    return name;
+}
+
+int QGstreamerImageCapture::doCapture(const QString &fileName, int count, int frameInterval)
+{
+    qCDebug(qLcImageCapture) << "do capture" << count << frameInterval;
     if (!m_session) {
         //emit error in the next event loop,
         //so application can associate it with returned request id.
@@ -134,7 +226,7 @@ int QGstreamerImageCapture::doCapture(const QString &fileName)
         qCDebug(qLcImageCapture) << "error 2";
         return -1;
     }
-    if (passImage) {
+    if (!canCapture()) {
         //emit error in the next event loop,
         //so application can associate it with returned request id.
         QMetaObject::invokeMethod(this, "error", Qt::QueuedConnection,
@@ -145,25 +237,53 @@ int QGstreamerImageCapture::doCapture(const QString &fileName)
         qCDebug(qLcImageCapture) << "error 3";
         return -1;
     }
-    m_lastId++;
 
-    pendingImages.enqueue({m_lastId, fileName, QMediaMetaData{}});
-    // let one image pass the pipeline
-    passImage = true;
+    const int firstId = m_lastId + 1;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int i = 0; i < count; ++i) {
+            const QString name = (count > 1 && !fileName.isEmpty()) ? burstFileName(fileName, i) : fileName;
+            pendingImages.enqueue({++m_lastId, name, QMediaMetaData{}, i ? frameInterval - 1 : 0});
+        }
+        m_pendingCount += count;
+    }
 
-    emit readyForCaptureChanged(false);
-    return m_lastId;
+    updateReadyForCapture();
+    return firstId;
 }
 
 bool QGstreamerImageCapture::probeBuffer(GstBuffer *buffer)
 {
-    if (!passImage)
-        return false;
-    qCDebug(qLcImageCapture) << "probe buffer";
+    EncoderSlot *slot = nullptr;
+    PendingImage imageData;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (pendingImages.isEmpty())
+            return false;
+
+        auto &next = pendingImages.head();
+        if (next.skipFrames > 0) {
+            --next.skipFrames;
+            return false;
+        }
 
-    passImage = false;
+        if (!next.filename.isEmpty()) {
+            const int slotCount = qMin(m_maximumPendingImages, int(encoderSlots.size()));
+            for (int i = 0; i < slotCount && !slot; ++i) {
+                if (!encoderSlots[i]->busy)
+                    slot = encoderSlots[i].get();
+            }
+            // all encoders are busy, the image gets taken from a later frame
+            if (!slot)
+                return false;
+            slot->busy = true;
+        }
+        imageData = pendingImages.dequeue();
+    }
 
-    emit readyForCaptureChanged(isReadyForCapture());
+    QElapsedTimer exposed;
+    exposed.start();
+    qCDebug(qLcImageCapture) << "probe buffer" << imageData.id;
 
     QGstCaps caps = gst_pad_get_current_caps(bin.staticPad("sink").pad());
     GstVideoInfo previewInfo;
@@ -174,33 +294,76 @@ bool QGstreamerImageCapture::probeBuffer(GstBuffer *buffer)
     auto *sink = m_session->gstreamerVideoSink();
     auto *gstBuffer = new QGstVideoBuffer(buffer, previewInfo, sink, fmt, memoryFormat);
     QVideoFrame frame(gstBuffer, fmt);
-    QImage img = frame.toImage();
-    if (img.isNull()) {
-        qDebug() << "received a null image";
-        return true;
-    }
-
-    auto &imageData = pendingImages.head();
 
     emit imageExposed(imageData.id);
 
     qCDebug(qLcImageCapture) << "Image available!";
     emit imageAvailable(imageData.id, frame);
 
-    emit imageCaptured(imageData.id, img);
+    // converting a full resolution frame takes too long for the streaming
+    // thread, so it is only done on demand and on a worker thread
+    const bool previewRequested = isPreviewRequested();
+    if (previewRequested) {
+        m_workers.start([this, frame, id = imageData.id, exposed, finish = !slot]() {
+            generatePreview(frame, id, exposed, finish);
+        });
+    }
 
     QMediaMetaData metaData = this->metaData();
     metaData.insert(QMediaMetaData::Date, QDateTime::currentDateTime());
     metaData.insert(QMediaMetaData::Resolution, frame.size());
     imageData.metaData = metaData;
 
+    emit imageMetadataAvailable(imageData.id, metaData);
+
+    if (!slot) {
+        // captured to buffer only, nothing left to encode
+        if (!previewRequested)
+            finishImage(imageData.id, exposed.nsecsElapsed() / 1000);
+        return false;
+    }
+
     // ensure taginject injects this metaData
     const auto &md = static_cast<const QGstreamerMetaData &>(metaData);
-    md.setMetaData(muxer.element());
+    md.setMetaData(slot->muxer.element());
 
-    emit imageMetadataAvailable(imageData.id, metaData);
+    slot->image = imageData;
+    slot->exposed = exposed;
+
+    auto *appSrc = GST_APP_SRC(slot->appSrc.element());
+    gst_app_src_set_caps(appSrc, caps.get());
+    gst_app_src_push_buffer(appSrc, gst_buffer_ref(buffer));
 
-    return true;
+    return false;
+}
+
+void QGstreamerImageCapture::generatePreview(const QVideoFrame &frame, int id,
+                                             const QElapsedTimer &exposed, bool finish)
+{
+    QImage preview = frame.toImage();
+    if (preview.isNull()) {
+        qDebug() << "received a null image";
+    } else {
+        if (preview.width() > MaxPreviewSize.width() || preview.height() > MaxPreviewSize.height())
+            preview = preview.scaled(MaxPreviewSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        emit imageCaptured(id, preview);
+    }
+
+    if (finish)
+        finishImage(id, exposed.nsecsElapsed() / 1000);
+}
+
+void QGstreamerImageCapture::finishImage(int id, qint64 latency)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pendingCount = qMax(m_pendingCount - 1, 0);
+    }
+
+    QMetaObject::invokeMethod(this, [this, id, latency]() {
+        emit imageProcessed(id, latency);
+        updateReadyForCapture();
+    }, Qt::QueuedConnection);
 }
 
 void QGstreamerImageCapture::setCaptureSession(QPlatformMediaCaptureSession *session)
@@ -209,24 +372,24 @@ void QGstreamerImageCapture::setCaptureSession(QPlatformMediaCaptureSession *ses
     if (m_session == captureSession)
         return;
 
-    bool readyForCapture = isReadyForCapture();
     if (m_session) {
         disconnect(m_session, nullptr, this, nullptr);
         m_lastId = 0;
+        QMutexLocker locker(&m_mutex);
         pendingImages.clear();
-        passImage = false;
+        m_pendingCount = 0;
         cameraActive = false;
     }
 
     m_session = captureSession;
     if (!m_session) {
-        if (readyForCapture)
-            emit readyForCaptureChanged(false);
+        updateReadyForCapture();
         return;
     }
 
     connect(m_session, &QPlatformMediaCaptureSession::cameraChanged, this, &QGstreamerImageCapture::onCameraChanged);
     onCameraChanged();
+    updateReadyForCapture();
 }
 
 void QGstreamerImageCapture::cameraActiveChanged(bool active)
@@ -235,8 +398,7 @@ void QGstreamerImageCapture::cameraActiveChanged(bool active)
     if (cameraActive == active)
         return;
     cameraActive = active;
-    qCDebug(qLcImageCapture) << "isReady" << isReadyForCapture();
-    emit readyForCaptureChanged(isReadyForCapture());
+    updateReadyForCapture();
 }
 
 void QGstreamerImageCapture::onCameraChanged()
@@ -256,19 +418,33 @@ gboolean QGstreamerImageCapture::saveImageFilter(GstElement *element,
 {
     Q_UNUSED(element);
     Q_UNUSED(pad);
-    QGstreamerImageCapture *capture = static_cast<QGstreamerImageCapture *>(appdata);
-
-    capture->passImage = false;
-
-    if (capture->pendingImages.isEmpty()) {
-        return true;
+    auto *slot = static_cast<EncoderSlot *>(appdata);
+    QGstreamerImageCapture *capture = slot->capture;
+
+    const PendingImage imageData = slot->image;
+    const qint64 latency = slot->exposed.nsecsElapsed() / 1000;
+
+    // hand the file to a worker, this only waits if the writes fall far
+    // behind, and then it blocks this encoder, not the camera
+    capture->m_writeQueue.acquire();
+    gst_buffer_ref(buffer);
+    capture->m_workers.start([capture, buffer, imageData]() {
+        capture->writeImage(buffer, imageData);
+        gst_buffer_unref(buffer);
+        capture->m_writeQueue.release();
+    });
+
+    {
+        QMutexLocker locker(&capture->m_mutex);
+        slot->busy = false;
     }
+    capture->finishImage(imageData.id, latency);
 
-    auto imageData = capture->pendingImages.dequeue();
-    if (imageData.filename.isEmpty()) {
-        return true;
-    }
+    return TRUE;
+}
 
+void QGstreamerImageCapture::writeImage(GstBuffer *buffer, const PendingImage &imageData)
+{
     qCDebug(qLcImageCapture) << "saving image as" << imageData.filename;
 
     QFile f(imageData.filename);
@@ -281,15 +457,13 @@ gboolean QGstreamerImageCapture::saveImageFilter(GstElement *element,
         f.close();
 
         static QMetaMethod savedSignal = QMetaMethod::fromSignal(&QGstreamerImageCapture::imageSaved);
-        savedSignal.invoke(capture,
+        savedSignal.invoke(this,
                            Qt::QueuedConnection,
                            Q_ARG(int, imageData.id),
                            Q_ARG(QString, imageData.filename));
     } else {
         qCDebug(qLcImageCapture) << "   could not open image file for writing";
     }
-
-    return TRUE;
 }
 
 QImageEncoderSettings QGstreamerImageCapture::imageSettings() const
@@ -57,6 +57,13 @@
 #include "private/qgstreamerbufferprobe_p.h"
 
 #include <qqueue.h>
+#include <qmutex.h>
+#include <qsemaphore.h>
+#include <qthreadpool.h>
+#include <qelapsedtimer.h>
+
+#include <memory>
+#include <vector>
 
 #include <private/qgst_p.h>
 #include <gst/video/video.h>
@@ -74,6 +81,11 @@ public:
     bool isReadyForCapture() const override;
     int capture(const QString &fileName) override;
     int captureToBuffer() override;
+    int captureBurst(int count, int frameInterval, const QString &fileName) override;
+    int captureBurstToBuffer(int count, int frameInterval) override;
+
+    int maximumPendingImages() const override;
+    void setMaximumPendingImages(int count) override;
 
     QImageEncoderSettings imageSettings() const override;
     void setImageSettings(const QImageEncoderSettings &settings) override;
@@ -89,7 +101,16 @@ public Q_SLOTS:
     void onCameraChanged();
 
 private:
-    int doCapture(const QString &fileName);
+    struct PendingImage;
+    struct EncoderSlot;
+
+    int doCapture(const QString &fileName, int count = 1, int frameInterval = 1);
+    bool canCapture() const;
+    void updateReadyForCapture();
+    void finishImage(int id, qint64 latency);
+    void addEncoderSlot();
+    void generatePreview(const QVideoFrame &frame, int id, const QElapsedTimer &exposed, bool finish);
+    void writeImage(GstBuffer *buffer, const PendingImage &imageData);
     static gboolean saveImageFilter(GstElement *element, GstBuffer *buffer, GstPad *pad, void *appdata);
 
     QGstreamerMediaCapture *m_session = nullptr;
@@ -100,19 +121,43 @@ private:
         int id;
         QString filename;
         QMediaMetaData metaData;
+        // frames to let pass before this image gets captured, used in bursts
+        int skipFrames = 0;
     };
 
+    // an appsrc ! videoconvert ! jpegenc ! jifmux ! fakesink branch. appsrc
+    // pushes from its own thread, so every slot encodes in parallel.
+    struct EncoderSlot {
+        QGstreamerImageCapture *capture = nullptr;
+        QGstElement appSrc;
+        QGstElement videoConvert;
+        QGstElement encoder;
+        QGstElement muxer;
+        QGstElement sink;
+        PendingImage image;
+        QElapsedTimer exposed;
+        bool busy = false;
+    };
+
+    // guards pendingImages, encoderSlots and m_pendingCount, which are used
+    // from the capture and the encoder streaming threads
+    mutable QMutex m_mutex;
     QQueue<PendingImage> pendingImages;
+    std::vector<std::unique_ptr<EncoderSlot>> encoderSlots;
+    // requested images, that have not been processed yet
+    int m_pendingCount = 0;
+    int m_maximumPendingImages = 1;
+
+    // converts previews and writes files, so neither blocks a streaming thread
+    QThreadPool m_workers;
+    // bounds the number of encoded images waiting to be written
+    QSemaphore m_writeQueue;
 
     QGstBin bin;
     QGstElement queue;
-    QGstElement videoConvert;
-    QGstElement encoder;
-    QGstElement muxer;
     QGstElement sink;
-    QGstPad videoSrcPad;
 
-    bool passImage = false;
+    bool m_readyForCapture = false;
     bool cameraActive = false;
 };
 
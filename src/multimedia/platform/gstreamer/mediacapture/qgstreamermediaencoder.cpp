@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include "qgstreamermediaencoder_p.h"
+#include "qgstreamerencodersettings_p.h"
 #include "private/qgstreamerintegration_p.h"
 #include "private/qgstreamerformatinfo_p.h"
 #include "private/qgstpipeline_p.h"
@@ -48,14 +49,19 @@
 
 #include <qdebug.h>
 #include <qeventloop.h>
+#include <qfileinfo.h>
 #include <qstandardpaths.h>
 #include <qmimetype.h>
 #include <qloggingcategory.h>
 
+#include <algorithm>
+#include <utility>
+
 #include <gst/gsttagsetter.h>
 #include <gst/gstversion.h>
 #include <gst/video/video.h>
 #include <gst/pbutils/encoding-profile.h>
+#include <gst/app/gstappsink.h>
 
 Q_LOGGING_CATEGORY(qLcMediaEncoder, "qt.multimedia.encoder")
 
@@ -70,7 +76,9 @@ QGstreamerMediaEncoder::QGstreamerMediaEncoder(QMediaRecorder *parent)
 
 QGstreamerMediaEncoder::~QGstreamerMediaEncoder()
 {
+    m_preRecordSettings.reset();
     if (!gstPipeline.isNull()) {
+        stopPreRecording();
         finalize();
         gstPipeline.removeMessageFilter(this);
         gstPipeline.setStateSync(GST_STATE_NULL);
@@ -111,6 +119,19 @@ bool QGstreamerMediaEncoder::processBusMessage(const QGstreamerMessage &message)
             return false;
     }
 
+    if (msg.type() == GST_MESSAGE_ELEMENT) {
+        QGstStructure s = msg.structure();
+        const bool opened = s.name() == "splitmuxsink-fragment-opened";
+        if (opened || s.name() == "splitmuxsink-fragment-closed") {
+            const QUrl location = QUrl::fromLocalFile(QString::fromUtf8(s["location"].toString()));
+            qCDebug(qLcMediaEncoder) << (opened ? "opened segment" : "closed segment") << location;
+            if (opened)
+                actualLocationChanged(location);
+            else
+                segmentFinished(location);
+        }
+    }
+
     if (msg.type() == GST_MESSAGE_EOS) {
         qCDebug(qLcMediaEncoder) << "received EOS from" << msg.source().name();
         finalize();
@@ -118,6 +139,9 @@ bool QGstreamerMediaEncoder::processBusMessage(const QGstreamerMessage &message)
     }
 
     if (msg.type() == GST_MESSAGE_ERROR) {
+        // Don't restart background encoding into the same error
+        m_preRecordSettings.reset();
+        stopPreRecording();
         GError *err;
         gchar *debug;
         gst_message_parse_error(msg.rawMessage(), &err, &debug);
@@ -160,14 +184,17 @@ static GstEncodingProfile *createVideoProfile(const QMediaEncoderSettings &setti
     if (caps.isNull())
         return nullptr;
 
+    QGstMutableCaps restriction = QGstreamerEncoderSettings::videoRestriction(settings);
+
     GstEncodingVideoProfile *profile = gst_encoding_video_profile_new(
         const_cast<GstCaps *>(caps.get()),
         nullptr,
-        nullptr, //restriction
+        restriction.get(),
         0); //presence
 
     gst_encoding_video_profile_set_pass(profile, 0);
-    gst_encoding_video_profile_set_variableframerate(profile, TRUE);
+    // encodebin only inserts videorate if the frame rate is not variable
+    gst_encoding_video_profile_set_variableframerate(profile, settings.videoFrameRate() <= 0);
 
     return (GstEncodingProfile *)profile;
 }
@@ -180,10 +207,12 @@ static GstEncodingProfile *createAudioProfile(const QMediaEncoderSettings &setti
     if (caps.isNull())
         return nullptr;
 
+    QGstMutableCaps restriction = QGstreamerEncoderSettings::audioRestriction(settings);
+
     GstEncodingProfile *profile = (GstEncodingProfile *)gst_encoding_audio_profile_new(
         const_cast<GstCaps *>(caps.get()),
         nullptr, //preset
-        nullptr,   //restriction
+        restriction.get(),
         0);     //presence
 
     return profile;
@@ -228,6 +257,109 @@ void QGstreamerMediaEncoder::PauseControl::reset()
     pauseStartPts.reset();
     duration = 0;
     firstBufferPts.reset();
+    preRecordDuration = 0;
+}
+
+static QGstElement findMuxer(const QGstBin &bin)
+{
+    QGstElement muxer;
+    GstIterator *elements = gst_bin_iterate_elements(bin.bin());
+    GValue item = G_VALUE_INIT;
+    while (muxer.isNull() && gst_iterator_next(elements, &item) == GST_ITERATOR_OK) {
+        auto *element = GST_ELEMENT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(element);
+        const char *klass = factory ? gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS) : nullptr;
+        if (klass && strstr(klass, "Muxer"))
+            muxer = QGstElement(element, QGstElement::NeedsRef);
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(elements);
+    return muxer;
+}
+
+// A muxer writing to a device can't go back to update headers
+static void makeStreamable(const QGstBin &encodeBin)
+{
+    // Fragments are what makes MP4 playable while it is being written
+    constexpr uint fragmentDuration = 1000; // ms
+
+    QGstElement muxer = findMuxer(encodeBin);
+    if (muxer.isNull())
+        return;
+    GObjectClass *klass = G_OBJECT_GET_CLASS(muxer.object());
+    if (g_object_class_find_property(klass, "streamable"))
+        muxer.set("streamable", true);
+    if (g_object_class_find_property(klass, "fragment-duration"))
+        muxer.set("fragment-duration", fragmentDuration);
+}
+
+static bool isKeyFrame(GstBuffer *buffer)
+{
+    return !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+}
+
+GstPadProbeReturn QGstreamerMediaEncoder::PreRecordBuffer::processBuffer(QGstPad pad, GstPadProbeInfo *info)
+{
+    auto buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!buffer || passThrough)
+        return GST_PAD_PROBE_OK;
+
+    if (!release.loadAcquire()) {
+        store(gst_buffer_ref(buffer));
+        return GST_PAD_PROBE_DROP;
+    }
+
+    // The muxer has to start with a key frame
+    if (buffers.empty() && !isKeyFrame(buffer))
+        return GST_PAD_PROBE_DROP;
+
+    // Recording has started, hand the history to the muxer ahead of this buffer
+    passThrough = true;
+    QGstPad muxerPad = pad.peer();
+    for (GstBuffer *stored : buffers)
+        gst_pad_chain(muxerPad.pad(), stored);
+    buffers.clear();
+    return GST_PAD_PROBE_OK;
+}
+
+void QGstreamerMediaEncoder::PreRecordBuffer::store(GstBuffer *buffer)
+{
+    if (buffers.empty() && !isKeyFrame(buffer)) {
+        gst_buffer_unref(buffer);
+        return;
+    }
+    buffers.push_back(buffer);
+
+    const GstClockTime newest = GST_BUFFER_DTS_OR_PTS(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(newest))
+        return;
+
+    // Drop whole groups of pictures from the front as long as what remains
+    // still covers the duration
+    for (;;) {
+        auto next = std::find_if(buffers.begin() + 1, buffers.end(), isKeyFrame);
+        if (next == buffers.end())
+            break;
+        const GstClockTime start = GST_BUFFER_DTS_OR_PTS(*next);
+        if (!GST_CLOCK_TIME_IS_VALID(start) || newest < start + duration)
+            break;
+        std::for_each(buffers.begin(), next, gst_buffer_unref);
+        buffers.erase(buffers.begin(), next);
+    }
+
+    // The encoder hasn't produced a key frame in a long time, keep memory
+    // bounded and start over with the next one
+    const GstClockTime oldest = GST_BUFFER_DTS_OR_PTS(buffers.front());
+    if (GST_CLOCK_TIME_IS_VALID(oldest) && newest > oldest + 4 * duration)
+        clear();
+}
+
+void QGstreamerMediaEncoder::PreRecordBuffer::clear()
+{
+    for (GstBuffer *buffer : buffers)
+        gst_buffer_unref(buffer);
+    buffers.clear();
 }
 
 void QGstreamerMediaEncoder::PauseControl::installOn(QGstPad pad)
@@ -253,6 +385,10 @@ GstPadProbeReturn QGstreamerMediaEncoder::PauseControl::processBuffer(QGstPad, G
 
     if (!firstBufferPts)
         firstBufferPts = GST_BUFFER_PTS(buffer);
+    if (preRecordDuration && encoder.state() == QMediaRecorder::StoppedState
+        && GST_BUFFER_PTS(buffer) > *firstBufferPts + preRecordDuration) {
+        firstBufferPts = GST_BUFFER_PTS(buffer) - preRecordDuration;
+    }
 
     if (encoder.state() == QMediaRecorder::PausedState) {
         if (!pauseStartPts)
@@ -285,6 +421,13 @@ void QGstreamerMediaEncoder::record(QMediaEncoderSettings &settings)
         return;
     }
 
+    QIODevice *device = outputDevice();
+    if (device && !device->isWritable()) {
+        error(QMediaRecorder::LocationNotWritable, QMediaRecorder::tr("Output device not writable"));
+        return;
+    }
+    m_deviceFailed = false;
+
     const auto audioOnly = settings.videoCodec() == QMediaFormat::VideoCodec::Unspecified;
 
     auto primaryLocation = audioOnly ? QStandardPaths::MusicLocation : QStandardPaths::MoviesLocation;
@@ -296,14 +439,48 @@ void QGstreamerMediaEncoder::record(QMediaEncoderSettings &settings)
 
     Q_ASSERT(!actualSink.isEmpty());
 
-    gstEncoder = QGstElement("encodebin", "encodebin");
-    auto *encodingProfile = createEncodingProfile(settings);
-    g_object_set (gstEncoder.object(), "profile", encodingProfile, nullptr);
-    gst_encoding_profile_unref(encodingProfile);
+    if (m_preRecording) {
+        // The encoders are already running, write their history and everything
+        // after it to the file
+        m_preRecording = false;
+        if (device)
+            makeStreamable(gstEncoder);
+        gstFileSink = createOutputSink(actualSink.toLocalFile());
+        gstPipeline.add(gstFileSink);
+        gstEncoder.link(gstFileSink);
+        gstFileSink.syncStateWithParent();
+        m_metaData.setMetaData(gstEncoder.bin());
+        for (auto &buffer : m_preRecordBuffers)
+            buffer->release.storeRelease(1);
+
+        signalDurationChangedTimer.start();
+        gstPipeline.dumpGraph("recording");
+        stateChanged(QMediaRecorder::RecordingState);
+        if (!device)
+            actualLocationChanged(QUrl::fromLocalFile(location));
+        return;
+    }
+
+    createEncoder(settings);
+
+    if (settings.isSegmented() && device)
+        qWarning() << "QGstreamerMediaEncoder: segments are not supported when recording to a device";
 
-    gstFileSink = QGstElement("filesink", "filesink");
-    gstFileSink.set("location", QFile::encodeName(actualSink.toLocalFile()).constData());
-    gstFileSink.set("async", false);
+    if (settings.isSegmented() && !device) {
+        gstFileSink = QGstElement("filesink", "filesink");
+        gstFileSink.set("async", false);
+        gstSegmentSink = createSegmentSink(settings, actualSink.toLocalFile());
+        if (gstSegmentSink.isNull()) {
+            gstFileSink = {};
+            gstEncoder = {};
+            error(QMediaRecorder::ResourceError, QMediaRecorder::tr("Segmented recording is not supported"));
+            return;
+        }
+    } else {
+        gstFileSink = createOutputSink(actualSink.toLocalFile());
+    }
+    // splitmuxsink forwards its request pads to encodebin
+    QGstElement recordingSink = gstSegmentSink.isNull() ? QGstElement(gstEncoder) : gstSegmentSink;
 
     QGstPad audioSink = {};
     QGstPad videoSink = {};
@@ -312,7 +489,7 @@ void QGstreamerMediaEncoder::record(QMediaEncoderSettings &settings)
     videoPauseControl.reset();
 
     if (hasAudio) {
-        audioSink = gstEncoder.getRequestPad("audio_%u");
+        audioSink = recordingSink.getRequestPad("audio_%u");
         if (audioSink.isNull())
             qWarning() << "Unsupported audio codec";
         else
@@ -320,28 +497,256 @@ void QGstreamerMediaEncoder::record(QMediaEncoderSettings &settings)
     }
 
     if (hasVideo) {
-        videoSink = gstEncoder.getRequestPad("video_%u");
+        videoSink = recordingSink.getRequestPad(gstSegmentSink.isNull() ? "video_%u" : "video");
         if (videoSink.isNull())
             qWarning() << "Unsupported video codec";
         else
             videoPauseControl.installOn(videoSink);
     }
 
-    gstPipeline.add(gstEncoder, gstFileSink);
-    gstEncoder.link(gstFileSink);
+    if (gstSegmentSink.isNull()) {
+        if (device)
+            makeStreamable(gstEncoder);
+        gstPipeline.add(gstEncoder, gstFileSink);
+        gstEncoder.link(gstFileSink);
+    } else {
+        gstPipeline.add(gstSegmentSink);
+    }
     m_metaData.setMetaData(gstEncoder.bin());
 
     m_session->linkEncoder(audioSink, videoSink);
 
-    gstEncoder.syncStateWithParent();
-    gstFileSink.syncStateWithParent();
+    if (gstSegmentSink.isNull()) {
+        gstEncoder.syncStateWithParent();
+        gstFileSink.syncStateWithParent();
+    } else {
+        gstSegmentSink.syncStateWithParent();
+    }
 
     signalDurationChangedTimer.start();
     gstPipeline.dumpGraph("recording");
 
     durationChanged(0);
     stateChanged(QMediaRecorder::RecordingState);
-    actualLocationChanged(QUrl::fromLocalFile(location));
+    // With segments, the location changes whenever splitmuxsink opens a new file
+    if (gstSegmentSink.isNull() && !device)
+        actualLocationChanged(QUrl::fromLocalFile(location));
+}
+
+QGstElement QGstreamerMediaEncoder::createOutputSink(const QString &location)
+{
+    if (!outputDevice()) {
+        QGstElement sink("filesink", "filesink");
+        sink.set("location", QFile::encodeName(location).constData());
+        sink.set("async", false);
+        return sink;
+    }
+
+    // Bounded, so that a slow device throttles the muxer instead of piling up
+    // data. Samples are pulled on the recorder's thread.
+    QGstElement sink("appsink", "devicesink");
+    sink.set("sync", false);
+    sink.set("async", false);
+    sink.set("max-buffers", 64u);
+    sink.set("drop", false);
+    sink.set("enable-last-sample", false);
+
+    GstAppSinkCallbacks callbacks = {};
+    callbacks.new_sample = newDeviceSample;
+    gst_app_sink_set_callbacks(GST_APP_SINK(sink.element()), &callbacks, this, nullptr);
+    return sink;
+}
+
+GstFlowReturn QGstreamerMediaEncoder::newDeviceSample(GstAppSink *, gpointer userData)
+{
+    auto *encoder = static_cast<QGstreamerMediaEncoder *>(userData);
+    if (encoder->m_deviceWritePending.testAndSetRelease(0, 1))
+        QMetaObject::invokeMethod(encoder->mediaRecorder(), [encoder]() { encoder->writeToDevice(); },
+                                  Qt::QueuedConnection);
+    return GST_FLOW_OK;
+}
+
+void QGstreamerMediaEncoder::writeToDevice()
+{
+    m_deviceWritePending.storeRelease(0);
+    if (gstFileSink.isNull() || !GST_IS_APP_SINK(gstFileSink.element()))
+        return;
+
+    auto *appSink = GST_APP_SINK(gstFileSink.element());
+    while (GstSample *sample = gst_app_sink_try_pull_sample(appSink, 0)) {
+        GstBuffer *buffer = gst_sample_get_buffer(sample);
+        GstMapInfo map;
+        if (!m_deviceFailed && buffer && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+            QIODevice *device = outputDevice();
+            const qint64 size = qint64(map.size);
+            if (!device || device->write(reinterpret_cast<const char *>(map.data), size) != size) {
+                m_deviceFailed = true;
+                handleSessionError(QMediaRecorder::ResourceError,
+                                   device ? device->errorString() : QMediaRecorder::tr("Output device was deleted"));
+            }
+            gst_buffer_unmap(buffer, &map);
+        }
+        gst_sample_unref(sample);
+    }
+}
+
+bool QGstreamerMediaEncoder::createEncoder(const QMediaEncoderSettings &settings)
+{
+    gstEncoder = QGstElement("encodebin", "encodebin");
+    if (gstEncoder.isNull())
+        return false;
+    // Has to happen before the pads are requested, that's when the encoders get created
+    QGstreamerEncoderSettings::install(gstEncoder, settings);
+    auto *encodingProfile = createEncodingProfile(settings);
+    g_object_set (gstEncoder.object(), "profile", encodingProfile, nullptr);
+    gst_encoding_profile_unref(encodingProfile);
+    return true;
+}
+
+void QGstreamerMediaEncoder::startPreRecording()
+{
+    if (!m_session || m_preRecording || !m_preRecordSettings)
+        return;
+
+    const auto hasVideo = m_session->camera() && m_session->camera()->isActive();
+    const auto hasAudio = m_session->audioInput() != nullptr;
+    if (!hasVideo && !hasAudio) {
+        qCDebug(qLcMediaEncoder) << "nothing to pre-record";
+        return;
+    }
+
+    const QMediaEncoderSettings &settings = *m_preRecordSettings;
+    if (!createEncoder(settings))
+        return;
+
+    const GstClockTime duration = GstClockTime(settings.preRecordDuration()) * GST_MSECOND;
+    audioPauseControl.reset();
+    videoPauseControl.reset();
+    audioPauseControl.preRecordDuration = duration;
+    videoPauseControl.preRecordDuration = duration;
+
+    QGstPad audioSink = hasAudio ? gstEncoder.getRequestPad("audio_%u") : QGstPad();
+    if (!audioSink.isNull())
+        audioPauseControl.installOn(audioSink);
+    QGstPad videoSink = hasVideo && settings.videoCodec() != QMediaFormat::VideoCodec::Unspecified
+            ? gstEncoder.getRequestPad("video_%u") : QGstPad();
+    if (!videoSink.isNull())
+        videoPauseControl.installOn(videoSink);
+
+    // encodebin links the encoders to the muxer when the pads are requested.
+    // Everything reaching the muxer is held back until recording starts.
+    QGstElement muxer = findMuxer(gstEncoder);
+    if (muxer.isNull() || (audioSink.isNull() && videoSink.isNull())) {
+        qWarning() << "QGstreamerMediaEncoder: pre-recording is not supported for this format";
+        gstEncoder = {};
+        return;
+    }
+    GstIterator *pads = gst_element_iterate_sink_pads(muxer.element());
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(pads, &item) == GST_ITERATOR_OK) {
+        QGstPad muxerPad(GST_PAD(g_value_get_object(&item)));
+        QGstPad peer = muxerPad.peer();
+        if (!peer.isNull()) {
+            m_preRecordBuffers.push_back(std::make_unique<PreRecordBuffer>(duration));
+            peer.addProbe<&PreRecordBuffer::processBuffer>(m_preRecordBuffers.back().get(),
+                                                           GST_PAD_PROBE_TYPE_BUFFER);
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(pads);
+
+    qCDebug(qLcMediaEncoder) << "pre-recording" << settings.preRecordDuration() << "ms";
+    gstPipeline.add(gstEncoder);
+    m_session->linkEncoder(audioSink, videoSink);
+    gstEncoder.syncStateWithParent();
+    m_preRecording = true;
+    gstPipeline.dumpGraph("pre-recording");
+}
+
+void QGstreamerMediaEncoder::stopPreRecording()
+{
+    if (!m_preRecording)
+        return;
+
+    qCDebug(qLcMediaEncoder) << "stop pre-recording";
+    m_preRecording = false;
+    m_session->unlinkEncoder();
+    gstPipeline.remove(gstEncoder);
+    gstEncoder.setStateSync(GST_STATE_NULL);
+    gstEncoder = {};
+    m_preRecordBuffers.clear();
+}
+
+void QGstreamerMediaEncoder::setPreRecording(const QMediaEncoderSettings &settings)
+{
+    if (settings.preRecordDuration() > 0 && settings.isSegmented())
+        qWarning() << "QGstreamerMediaEncoder: pre-recording is not supported together with segments";
+
+    if (settings.preRecordDuration() > 0 && !settings.isSegmented())
+        m_preRecordSettings = settings;
+    else
+        m_preRecordSettings.reset();
+
+    // Otherwise this is applied when the current recording has been finalized
+    if (!m_session || m_finalizing || state() != QMediaRecorder::StoppedState)
+        return;
+
+    stopPreRecording();
+    startPreRecording();
+}
+
+QGstElement QGstreamerMediaEncoder::createSegmentSink(const QMediaEncoderSettings &settings, const QString &location)
+{
+    QGstElement segmentSink("splitmuxsink", "segmentsink");
+    if (segmentSink.isNull())
+        return {};
+
+    const QFileInfo info(location);
+    m_segmentBaseName = info.dir().absoluteFilePath(info.completeBaseName());
+    m_segmentSuffix = info.suffix();
+    g_signal_connect(segmentSink.object(), "format-location", G_CALLBACK(formatSegmentLocation), this);
+
+    // encodebin acts as the muxer. splitmuxsink restarts it for every segment,
+    // so each segment starts with a fresh key frame and, as splitmuxsink sees raw
+    // frames, it can cut at any frame without waiting or dropping anything.
+    segmentSink.set("muxer", gstEncoder);
+    segmentSink.set("sink", gstFileSink);
+    if (settings.maximumSegmentDuration() > 0)
+        segmentSink.set("max-size-time", quint64(settings.maximumSegmentDuration()) * GST_MSECOND);
+
+    // max-size-bytes would count the raw input, so watch what actually gets
+    // written instead and ask for a split once the limit has been reached
+    m_maximumSegmentSize = settings.maximumSegmentSize();
+    m_segmentBytes.storeRelaxed(0);
+    if (m_maximumSegmentSize > 0)
+        gstFileSink.sink().addProbe<&QGstreamerMediaEncoder::countSegmentBytes>(this, GST_PAD_PROBE_TYPE_BUFFER);
+
+    return segmentSink;
+}
+
+gchar *QGstreamerMediaEncoder::formatSegmentLocation(GstElement *, guint index, gpointer userData)
+{
+    auto *encoder = static_cast<QGstreamerMediaEncoder *>(userData);
+    const QString location = QStringLiteral("%1_%2.%3")
+            .arg(encoder->m_segmentBaseName)
+            .arg(index, 4, 10, QLatin1Char('0'))
+            .arg(encoder->m_segmentSuffix);
+    return g_strdup(QFile::encodeName(location).constData());
+}
+
+GstPadProbeReturn QGstreamerMediaEncoder::countSegmentBytes(QGstPad, GstPadProbeInfo *info)
+{
+    auto buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!buffer)
+        return GST_PAD_PROBE_OK;
+
+    const qint64 size = gst_buffer_get_size(buffer);
+    if (m_segmentBytes.fetchAndAddRelaxed(size) + size >= m_maximumSegmentSize) {
+        m_segmentBytes.storeRelaxed(0);
+        g_signal_emit_by_name(gstSegmentSink.object(), "split-now");
+    }
+    return GST_PAD_PROBE_OK;
 }
 
 void QGstreamerMediaEncoder::pause()
@@ -372,7 +777,10 @@ void QGstreamerMediaEncoder::stop()
     signalDurationChangedTimer.stop();
 
     qCDebug(qLcMediaEncoder) << ">>>>>>>>>>>>> sending EOS";
-    gstEncoder.sendEos();
+    if (gstSegmentSink.isNull())
+        gstEncoder.sendEos();
+    else
+        gstSegmentSink.sendEos();
 }
 
 void QGstreamerMediaEncoder::finalize()
@@ -382,14 +790,29 @@ void QGstreamerMediaEncoder::finalize()
 
     qCDebug(qLcMediaEncoder) << "finalize";
 
-    gstPipeline.remove(gstEncoder);
-    gstPipeline.remove(gstFileSink);
-    gstEncoder.setStateSync(GST_STATE_NULL);
-    gstFileSink.setStateSync(GST_STATE_NULL);
+    // Everything up to EOS is queued in the appsink
+    writeToDevice();
+
+    if (gstSegmentSink.isNull()) {
+        gstPipeline.remove(gstEncoder);
+        if (!gstFileSink.isNull())
+            gstPipeline.remove(gstFileSink);
+        gstEncoder.setStateSync(GST_STATE_NULL);
+        if (!gstFileSink.isNull())
+            gstFileSink.setStateSync(GST_STATE_NULL);
+    } else {
+        gstPipeline.remove(gstSegmentSink);
+        gstSegmentSink.setStateSync(GST_STATE_NULL);
+        gstSegmentSink = {};
+    }
     gstFileSink = {};
     gstEncoder = {};
+    m_preRecordBuffers.clear();
     m_finalizing = false;
     stateChanged(QMediaRecorder::StoppedState);
+
+    // Keep the history for the next recording
+    startPreRecording();
 }
 
 void QGstreamerMediaEncoder::setMetaData(const QMediaMetaData &metaData)
@@ -410,7 +833,11 @@ void QGstreamerMediaEncoder::setCaptureSession(QPlatformMediaCaptureSession *ses
     if (m_session == captureSession)
         return;
 
+    // The history belongs to the old pipeline. Keep finalize() from restarting
+    // it there, and start it again once the new session is in place.
+    auto preRecordSettings = std::exchange(m_preRecordSettings, std::nullopt);
     if (m_session) {
+        stopPreRecording();
         stop();
         if (m_finalizing) {
             QEventLoop loop;
@@ -423,10 +850,12 @@ void QGstreamerMediaEncoder::setCaptureSession(QPlatformMediaCaptureSession *ses
     }
 
     m_session = captureSession;
+    m_preRecordSettings = std::move(preRecordSettings);
     if (!m_session)
         return;
 
     gstPipeline = captureSession->gstPipeline;
     gstPipeline.set("message-forward", true);
     gstPipeline.installMessageFilter(this);
+    startPreRecording();
 }
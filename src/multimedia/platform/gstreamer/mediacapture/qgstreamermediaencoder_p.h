@@ -58,9 +58,16 @@
 
 #include <QtCore/qurl.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qatomic.h>
 #include <qelapsedtimer.h>
 #include <qtimer.h>
 
+#include <gst/app/gstappsink.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class QMediaMetaData;
@@ -73,6 +80,7 @@ public:
     virtual ~QGstreamerMediaEncoder();
 
     bool isLocationWritable(const QUrl &sink) const override;
+    bool supportsOutputDevice() const override { return true; }
 
     qint64 duration() const override;
 
@@ -80,6 +88,7 @@ public:
     void pause() override;
     void resume() override;
     void stop() override;
+    void setPreRecording(const QMediaEncoderSettings &settings) override;
 
     void setMetaData(const QMediaMetaData &) override;
     QMediaMetaData metaData() const override;
@@ -103,21 +112,65 @@ private:
         std::optional<GstClockTime> pauseStartPts;
         std::optional<GstClockTime> firstBufferPts;
         qint64 duration = 0;
+        // While pre-recording, only this much of the stream ends up in the file
+        GstClockTime preRecordDuration = 0;
     };
 
     PauseControl audioPauseControl;
     PauseControl videoPauseControl;
 
+    // Holds the encoded stream going into one of the muxer's pads while
+    // pre-recording, trimmed to whole groups of pictures
+    struct PreRecordBuffer {
+        PreRecordBuffer(GstClockTime duration) : duration(duration) {}
+        ~PreRecordBuffer() { clear(); }
+
+        GstPadProbeReturn processBuffer(QGstPad pad, GstPadProbeInfo *info);
+        void store(GstBuffer *buffer);
+        void clear();
+
+        const GstClockTime duration;
+        std::deque<GstBuffer *> buffers;
+        // Set when recording starts, the next buffer flushes the history
+        QAtomicInt release = 0;
+        bool passThrough = false;
+    };
+    std::vector<std::unique_ptr<PreRecordBuffer>> m_preRecordBuffers;
+    std::optional<QMediaEncoderSettings> m_preRecordSettings;
+    bool m_preRecording = false;
+
     void handleSessionError(QMediaRecorder::Error code, const QString &description);
     void finalize();
 
+    bool createEncoder(const QMediaEncoderSettings &settings);
+    void startPreRecording();
+    void stopPreRecording();
+
+    QGstElement createOutputSink(const QString &location);
+    static GstFlowReturn newDeviceSample(GstAppSink *, gpointer userData);
+    void writeToDevice();
+
+    QGstElement createSegmentSink(const QMediaEncoderSettings &settings, const QString &location);
+    static gchar *formatSegmentLocation(GstElement *, guint index, gpointer userData);
+    GstPadProbeReturn countSegmentBytes(QGstPad pad, GstPadProbeInfo *info);
+
     QGstreamerMediaCapture *m_session = nullptr;
     QGstreamerMetaData m_metaData;
     QTimer signalDurationChangedTimer;
 
     QGstPipeline gstPipeline;
     QGstBin gstEncoder;
+    // filesink, or an appsink when writing to outputDevice()
     QGstElement gstFileSink;
+    QAtomicInt m_deviceWritePending = 0;
+    bool m_deviceFailed = false;
+    // splitmuxsink wrapping gstEncoder and gstFileSink when recording in segments
+    QGstElement gstSegmentSink;
+
+    QString m_segmentBaseName;
+    QString m_segmentSuffix;
+    qint64 m_maximumSegmentSize = 0;
+    QAtomicInteger<qint64> m_segmentBytes = 0;
 
     bool m_finalizing = false;
 };
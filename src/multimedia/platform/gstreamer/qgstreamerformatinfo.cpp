@@ -41,8 +41,19 @@
 
 #include "private/qgstutils_p.h"
 
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qstandardpaths.h>
+
 QT_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(qLcFormatInfo, "qt.multimedia.formatinfo")
+
 QMediaFormat::AudioCodec QGstreamerFormatInfo::audioCodecForCaps(QGstStructure structure)
 {
     const char *name = structure.name().data();
@@ -173,7 +184,10 @@ QImageCapture::FileFormat QGstreamerFormatInfo::imageFormatForCaps(QGstStructure
     return QImageCapture::UnspecifiedFormat;
 }
 
-static QPair<QList<QMediaFormat::AudioCodec>, QList<QMediaFormat::VideoCodec>> getCodecsList(bool decode)
+// When imageFormats is given, image encoders found while walking the encoder
+// list are collected as well, so that we don't need a separate registry pass.
+static QPair<QList<QMediaFormat::AudioCodec>, QList<QMediaFormat::VideoCodec>> getCodecsList(bool decode,
+                                                                                          QList<QImageCapture::FileFormat> *imageFormats = nullptr)
 {
     QList<QMediaFormat::AudioCodec> audio;
     QList<QMediaFormat::VideoCodec> video;
@@ -204,6 +218,11 @@ static QPair<QList<QMediaFormat::AudioCodec>, QList<QMediaFormat::VideoCodec>> g
                     auto v = QGstreamerFormatInfo::videoCodecForCaps(structure);
                     if (v != QMediaFormat::VideoCodec::Unspecified && !video.contains(v))
                         video.append(v);
+                    if (imageFormats) {
+                        auto f = QGstreamerFormatInfo::imageFormatForCaps(structure);
+                        if (f != QImageCapture::UnspecifiedFormat && !imageFormats->contains(f))
+                            imageFormats->append(f);
+                    }
                 }
             }
         }
@@ -308,41 +327,6 @@ QList<QGstreamerFormatInfo::CodecMap> QGstreamerFormatInfo::getMuxerList(bool de
     return muxers;
 }
 
-static QList<QImageCapture::FileFormat> getImageFormatList()
-{
-    QSet<QImageCapture::FileFormat> formats;
-
-    GList *elementList = gst_element_factory_list_get_elements(GST_ELEMENT_FACTORY_TYPE_ENCODER,
-                                                               GST_RANK_MARGINAL);
-
-    GList *element = elementList;
-    while (element) {
-        GstElementFactory *factory = (GstElementFactory *)element->data;
-        element = element->next;
-
-        const GList *padTemplates = gst_element_factory_get_static_pad_templates(factory);
-        while (padTemplates) {
-            GstStaticPadTemplate *padTemplate = (GstStaticPadTemplate *)padTemplates->data;
-            padTemplates = padTemplates->next;
-
-            if (padTemplate->direction == GST_PAD_SRC) {
-                QGstMutableCaps caps = gst_static_caps_get(&padTemplate->static_caps);
-
-                for (int i = 0; i < caps.size(); i++) {
-                    QGstStructure structure = caps.at(i);
-                    auto f = QGstreamerFormatInfo::imageFormatForCaps(structure);
-                    if (f != QImageCapture::UnspecifiedFormat) {
-//                        qDebug() << structure.toString() << f;
-                        formats.insert(f);
-                    }
-                }
-            }
-        }
-    }
-    gst_plugin_feature_list_free(elementList);
-    return formats.values();
-}
-
 #if 0
 static void dumpAudioCodecs(const QList<QMediaFormat::AudioCodec> &codecList)
 {
@@ -373,22 +357,167 @@ static void dumpMuxers(const QList<QPlatformMediaFormatInfo::CodecMap> &muxerLis
 }
 #endif
 
-QGstreamerFormatInfo::QGstreamerFormatInfo()
+static constexpr quint32 cacheMagic = 0x51474649; // "QGFI"
+static constexpr quint32 cacheVersion = 1;
+
+static QString cacheFileName()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (dir.isEmpty())
+        return {};
+    return dir + QLatin1String("/qtmultimedia/gstreamer-formatinfo.cache");
+}
+
+// Identifies the state of the GStreamer registry the cached data was computed from.
+// Any plugin being added, removed or updated, or an element factory changing its
+// rank (e.g. through GST_PLUGIN_FEATURE_RANK) results in a different key.
+static QByteArray registryKey()
 {
-    auto codecs = getCodecsList(/*decode = */ true);
-    decoders = getMuxerList(true, codecs.first, codecs.second);
+    QList<QByteArray> entries;
+
+    GList *plugins = gst_registry_get_plugin_list(gst_registry_get());
+    for (GList *p = plugins; p; p = p->next) {
+        GstPlugin *plugin = GST_PLUGIN(p->data);
+        entries.append(QByteArray("plugin:") + gst_plugin_get_name(plugin) + ':'
+                       + gst_plugin_get_version(plugin) + ':' + gst_plugin_get_filename(plugin));
+    }
+    gst_plugin_list_free(plugins);
+
+    GList *features = gst_registry_get_feature_list(gst_registry_get(), GST_TYPE_ELEMENT_FACTORY);
+    for (GList *f = features; f; f = f->next) {
+        GstPluginFeature *feature = GST_PLUGIN_FEATURE(f->data);
+        entries.append(QByteArray("feature:") + gst_plugin_feature_get_name(feature) + ':'
+                       + QByteArray::number(gst_plugin_feature_get_rank(feature)));
+    }
+    gst_plugin_feature_list_free(features);
+
+    std::sort(entries.begin(), entries.end());
+
+    guint major, minor, micro, nano;
+    gst_version(&major, &minor, &micro, &nano);
 
-    codecs = getCodecsList(/*decode = */ false);
-    encoders = getMuxerList(/* demuxer = */false, codecs.first, codecs.second);
-//    dumpAudioCodecs(codecs.first);
-//    dumpVideoCodecs(codecs.second);
-//    dumpMuxers(encoders);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(major) + '.' + QByteArray::number(minor) + '.'
+                 + QByteArray::number(micro) + '.' + QByteArray::number(nano));
+    for (const auto &e : qAsConst(entries))
+        hash.addData(e);
+    return hash.result();
+}
+
+static QDataStream &operator<<(QDataStream &stream, const QPlatformMediaFormatInfo::CodecMap &map)
+{
+    return stream << map.format << map.audio << map.video;
+}
 
-    imageFormats = getImageFormatList();
+static QDataStream &operator>>(QDataStream &stream, QPlatformMediaFormatInfo::CodecMap &map)
+{
+    return stream >> map.format >> map.audio >> map.video;
 }
 
+QGstreamerFormatInfo::QGstreamerFormatInfo() = default;
+
 QGstreamerFormatInfo::~QGstreamerFormatInfo() = default;
 
+void QGstreamerFormatInfo::ensureCodecMap(QMediaFormat::ConversionMode mode) const
+{
+    QMutexLocker locker(&m_mutex);
+    loadCache();
+
+    if (mode == QMediaFormat::Decode) {
+        if (m_hasDecoders)
+            return;
+        auto codecs = getCodecsList(/*decode = */ true);
+        decoders = getMuxerList(true, codecs.first, codecs.second);
+        m_hasDecoders = true;
+    } else {
+        if (m_hasEncoders)
+            return;
+        QList<QImageCapture::FileFormat> images;
+        auto codecs = getCodecsList(/*decode = */ false, &images);
+        encoders = getMuxerList(/* demuxer = */false, codecs.first, codecs.second);
+//        dumpAudioCodecs(codecs.first);
+//        dumpVideoCodecs(codecs.second);
+//        dumpMuxers(encoders);
+        imageFormats = images;
+        m_hasEncoders = true;
+    }
+    saveCache();
+}
+
+void QGstreamerFormatInfo::ensureImageFormats() const
+{
+    // Image encoders are discovered in the same registry pass as the audio and video ones
+    ensureCodecMap(QMediaFormat::Encode);
+}
+
+void QGstreamerFormatInfo::loadCache() const
+{
+    if (m_cacheLoaded)
+        return;
+    m_cacheLoaded = true;
+
+    if (qEnvironmentVariableIsSet("QT_GSTREAMER_NO_FORMAT_CACHE"))
+        return;
+
+    m_registryKey = registryKey();
+
+    QFile file(cacheFileName());
+    if (file.fileName().isEmpty() || !file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray key;
+    stream >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion)
+        return;
+    stream >> key;
+    if (key != m_registryKey) {
+        qCDebug(qLcFormatInfo) << "GStreamer registry changed, discarding cached format info";
+        return;
+    }
+
+    bool hasDecoders = false;
+    bool hasEncoders = false;
+    QList<CodecMap> cachedDecoders;
+    QList<CodecMap> cachedEncoders;
+    QList<QImageCapture::FileFormat> cachedImageFormats;
+    stream >> hasDecoders >> cachedDecoders >> hasEncoders >> cachedEncoders >> cachedImageFormats;
+    if (stream.status() != QDataStream::Ok)
+        return;
+
+    if (hasDecoders) {
+        decoders = cachedDecoders;
+        m_hasDecoders = true;
+    }
+    if (hasEncoders) {
+        encoders = cachedEncoders;
+        imageFormats = cachedImageFormats;
+        m_hasEncoders = true;
+    }
+    qCDebug(qLcFormatInfo) << "Loaded format info from" << file.fileName();
+}
+
+void QGstreamerFormatInfo::saveCache() const
+{
+    if (m_registryKey.isEmpty())
+        return;
+
+    const QString fileName = cacheFileName();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << m_registryKey
+           << m_hasDecoders << decoders
+           << m_hasEncoders << encoders << imageFormats;
+    if (!file.commit())
+        qCDebug(qLcFormatInfo) << "Could not write format info cache" << fileName;
+}
+
 QGstMutableCaps QGstreamerFormatInfo::formatCaps(const QMediaFormat &f) const
 {
     auto format = f.fileFormat();
@@ -54,6 +54,7 @@
 #include <private/qplatformmediaformatinfo_p.h>
 #include <qhash.h>
 #include <qlist.h>
+#include <qmutex.h>
 #include <private/qgstutils_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -73,7 +74,24 @@ public:
     static QMediaFormat::FileFormat fileFormatForCaps(QGstStructure structure);
     static QImageCapture::FileFormat imageFormatForCaps(QGstStructure structure);
 
-    QList<CodecMap> getMuxerList(bool demuxer, QList<QMediaFormat::AudioCodec> audioCodecs, QList<QMediaFormat::VideoCodec> videoCodecs);
+    static QList<CodecMap> getMuxerList(bool demuxer, QList<QMediaFormat::AudioCodec> audioCodecs, QList<QMediaFormat::VideoCodec> videoCodecs);
+
+protected:
+    void ensureCodecMap(QMediaFormat::ConversionMode mode) const override;
+    void ensureImageFormats() const override;
+
+private:
+    void loadCache() const;
+    void saveCache() const;
+
+    // Walking the registry and parsing the pad templates of all factories is
+    // expensive, so it is only done on first use and the result is kept in an
+    // on-disk cache keyed by the state of the registry.
+    mutable QMutex m_mutex;
+    mutable QByteArray m_registryKey;
+    mutable bool m_cacheLoaded = false;
+    mutable bool m_hasDecoders = false;
+    mutable bool m_hasEncoders = false;
 };
 
 QT_END_NAMESPACE
@@ -42,6 +42,7 @@
 #include "private/qgstreamermediaplayer_p.h"
 #include "private/qgstreamermediacapture_p.h"
 #include "private/qgstreameraudiodecoder_p.h"
+#include "private/qgstreamermetadatascanner_p.h"
 #include "private/qgstreamercamera_p.h"
 #include "private/qgstreamermediaencoder_p.h"
 #include "private/qgstreamerimagecapture_p.h"
@@ -80,6 +81,11 @@ QPlatformAudioDecoder *QGstreamerIntegration::createAudioDecoder(QAudioDecoder *
     return new QGstreamerAudioDecoder(decoder);
 }
 
+QPlatformMetaDataScanner *QGstreamerIntegration::createMetaDataScanner(QMediaMetaDataScanner *scanner)
+{
+    return new QGstreamerMetaDataScanner(scanner);
+}
+
 QPlatformMediaCaptureSession *QGstreamerIntegration::createCaptureSession()
 {
     return new QGstreamerMediaCapture();
@@ -134,57 +134,90 @@ QList<QAudioDevice> QGstreamerMediaDevices::audioOutputs() const
 
 QList<QCameraDevice> QGstreamerMediaDevices::videoInputs() const
 {
-    QList<QCameraDevice> devices;
+    return m_videoInputs;
+}
 
-    for (auto *d : qAsConst(m_videoSources)) {
-        QGstStructure properties = gst_device_get_properties(d);
-        if (!properties.isNull()) {
-            QCameraDevicePrivate *info = new QCameraDevicePrivate;
-            auto *desc = gst_device_get_display_name(d);
-            info->description = QString::fromUtf8(desc);
-            g_free(desc);
-
-            info->id = properties["device.path"].toString();
-            auto def = properties["is-default"].toBool();
-            info->isDefault = def && *def;
-            if (def)
-                devices.prepend(info->create());
-            else
-                devices.append(info->create());
-            properties.free();
-            QGstCaps caps = gst_device_get_caps(d);
-            if (!caps.isNull()) {
-                QList<QCameraFormat> formats;
-                QSet<QSize> photoResolutions;
-
-                int size = caps.size();
-                for (int i = 0; i < size; ++i) {
-                    auto cap = caps.at(i);
-
-                    QSize resolution = cap.resolution();
-                    if (!resolution.isValid())
-                        continue;
-
-                    auto pixelFormat = cap.pixelFormat();
-                    auto frameRate = cap.frameRateRange();
-
-                    auto *f = new QCameraFormatPrivate{
-                        QSharedData(),
-                        pixelFormat,
-                        resolution,
-                        frameRate.min,
-                        frameRate.max
-                    };
-                    formats << f->create();
-                    photoResolutions.insert(resolution);
-                }
-                info->videoFormats = formats;
-                // ### sort resolutions?
-                info->photoResolutions = photoResolutions.values();
-            }
+static bool cameraFormatLessThan(const QCameraFormat &a, const QCameraFormat &b)
+{
+    if (a.pixelFormat() != b.pixelFormat())
+        return a.pixelFormat() < b.pixelFormat();
+    if (a.resolution().width() != b.resolution().width())
+        return a.resolution().width() < b.resolution().width();
+    if (a.resolution().height() != b.resolution().height())
+        return a.resolution().height() < b.resolution().height();
+    if (a.maxFrameRate() != b.maxFrameRate())
+        return a.maxFrameRate() < b.maxFrameRate();
+    return a.minFrameRate() < b.minFrameRate();
+}
+
+static QCameraDevice createCameraDevice(GstDevice *d)
+{
+    QGstStructure properties = gst_device_get_properties(d);
+    if (properties.isNull())
+        return {};
+
+    QCameraDevicePrivate *info = new QCameraDevicePrivate;
+    auto *desc = gst_device_get_display_name(d);
+    info->description = QString::fromUtf8(desc);
+    g_free(desc);
+
+    info->id = properties["device.path"].toString();
+    auto def = properties["is-default"].toBool();
+    info->isDefault = def && *def;
+    properties.free();
+
+    QGstCaps caps = gst_device_get_caps(d);
+    if (!caps.isNull()) {
+        QList<QCameraFormat> formats;
+        QList<QSize> photoResolutions;
+
+        int size = caps.size();
+        for (int i = 0; i < size; ++i) {
+            auto cap = caps.at(i);
+
+            QSize resolution = cap.resolution();
+            if (!resolution.isValid())
+                continue;
+
+            auto pixelFormat = cap.pixelFormat();
+            auto frameRate = cap.frameRateRange();
+
+            auto *f = new QCameraFormatPrivate{
+                QSharedData(),
+                pixelFormat,
+                resolution,
+                frameRate.min,
+                frameRate.max
+            };
+            formats << f->create();
+            photoResolutions << resolution;
         }
+
+        // Devices often report the same format several times (e.g. once per
+        // colorimetry), so sort and drop the duplicates once here.
+        std::sort(formats.begin(), formats.end(), cameraFormatLessThan);
+        formats.erase(std::unique(formats.begin(), formats.end()), formats.end());
+        info->videoFormats = formats;
+
+        std::sort(photoResolutions.begin(), photoResolutions.end(), [](const QSize &a, const QSize &b) {
+            return a.width() != b.width() ? a.width() < b.width() : a.height() < b.height();
+        });
+        photoResolutions.erase(std::unique(photoResolutions.begin(), photoResolutions.end()),
+                               photoResolutions.end());
+        info->photoResolutions = photoResolutions;
+    }
+    return info->create();
+}
+
+void QGstreamerMediaDevices::updateVideoInputs()
+{
+    m_videoInputs.clear();
+    for (const auto &source : qAsConst(m_videoSources)) {
+        if (source.cameraDevice.isDefault())
+            m_videoInputs.prepend(source.cameraDevice);
+        else
+            m_videoInputs.append(source.cameraDevice);
     }
-    return devices;
 }
 
 QPlatformAudioSource *QGstreamerMediaDevices::createAudioSource(const QAudioDevice &deviceInfo)
@@ -203,8 +236,16 @@ void QGstreamerMediaDevices::addDevice(GstDevice *device)
 //    qDebug() << "adding device:" << device << type << gst_device_get_display_name(device) << gst_structure_to_string(gst_device_get_properties(device));
     gst_object_ref(device);
     if (!strcmp(type, "Video/Source")) {
-        m_videoSources.insert(device);
-        videoInputsChanged();
+        // Querying the caps and building the format list is expensive for cameras
+        // with many modes, so do it once per device instead of in videoInputs()
+        auto cameraDevice = createCameraDevice(device);
+        if (cameraDevice.isNull()) {
+            gst_object_unref(device);
+        } else {
+            m_videoSources.append({ device, cameraDevice });
+            updateVideoInputs();
+            videoInputsChanged();
+        }
     } else if (!strcmp(type, "Audio/Source")) {
         m_audioSources.insert(device);
         audioInputsChanged();
@@ -220,7 +261,9 @@ void QGstreamerMediaDevices::addDevice(GstDevice *device)
 void QGstreamerMediaDevices::removeDevice(GstDevice *device)
 {
 //    qDebug() << "removing device:" << device << gst_device_get_display_name(device);
-    if (m_videoSources.remove(device)) {
+    auto isDevice = [device](const VideoSource &source) { return source.gstDevice == device; };
+    if (m_videoSources.removeIf(isDevice)) {
+        updateVideoInputs();
         videoInputsChanged();
     } else if (m_audioSources.remove(device)) {
         audioInputsChanged();
@@ -259,7 +302,11 @@ GstDevice *QGstreamerMediaDevices::audioDevice(const QByteArray &id, QAudioDevic
 
 GstDevice *QGstreamerMediaDevices::videoDevice(const QByteArray &id) const
 {
-    return getDevice(m_videoSources, "device.path", id);
+    for (const auto &source : m_videoSources) {
+        if (source.cameraDevice.id() == id)
+            return source.gstDevice;
+    }
+    return nullptr;
 }
 
 QT_END_NAMESPACE
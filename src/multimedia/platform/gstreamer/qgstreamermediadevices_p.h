@@ -55,6 +55,7 @@
 #include <gst/gst.h>
 #include <qset.h>
 #include <qaudiodevice.h>
+#include <qcameradevice.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -76,7 +77,14 @@ public:
     GstDevice *videoDevice(const QByteArray &id) const;
 
 private:
-    QSet<GstDevice *> m_videoSources;
+    void updateVideoInputs();
+
+    struct VideoSource {
+        GstDevice *gstDevice;
+        QCameraDevice cameraDevice;
+    };
+    QList<VideoSource> m_videoSources;
+    QList<QCameraDevice> m_videoInputs;
     QSet<GstDevice *> m_audioSources;
     QSet<GstDevice *> m_audioSinks;
 };
@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNULLAUDIOCLOCK_H
+#define QNULLAUDIOCLOCK_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qnullmediadevices_p.h"
+
+#include <qaudioformat.h>
+#include <qelapsedtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+// Decides how much audio the null devices process per period. In real time
+// mode this follows the wall clock, so the amount does not drift when timer
+// events are late.
+class QNullAudioClock
+{
+public:
+    void start(const QAudioFormat &format, const QNullAudioConfig &config)
+    {
+        m_format = format;
+        m_freeRunning = config.clock == QNullAudioConfig::FreeRunning;
+        m_periodUSecs = qMax(config.periodUSecs, 1);
+        m_clockBytes = 0;
+        m_offsetUSecs = 0;
+        m_wallClock.start();
+        m_timer.start();
+    }
+
+    // the timer interval in msecs, zero processes periods back to back
+    int interval() const { return m_freeRunning ? 0 : qMax(m_periodUSecs / 1000, 1); }
+
+    qint64 periodBytes() const { return bytesForDuration(m_periodUSecs); }
+
+    // bytes, that are due since the last period
+    qint64 bytesDue() const
+    {
+        if (m_freeRunning)
+            return periodBytes();
+        return bytesForDuration(m_offsetUSecs + m_timer.nsecsElapsed() / 1000) - m_clockBytes;
+    }
+
+    // accounts for bytes, whether they carried audio or were lost to an underrun
+    void advance(qint64 bytes) { m_clockBytes += bytes; }
+
+    void suspend() { m_offsetUSecs += m_timer.nsecsElapsed() / 1000; }
+    void resume() { m_timer.start(); }
+
+    qint64 elapsedUSecs() const { return m_wallClock.nsecsElapsed() / 1000; }
+
+    qint64 bytesForDuration(qint64 usecs) const
+    {
+        return usecs * m_format.sampleRate() / 1000000 * m_format.bytesPerFrame();
+    }
+
+    qint64 durationForBytes(qint64 bytes) const
+    {
+        const qint64 bytesPerSecond = qint64(m_format.sampleRate()) * m_format.bytesPerFrame();
+        return bytesPerSecond ? bytes * 1000000 / bytesPerSecond : 0;
+    }
+
+private:
+    QAudioFormat m_format;
+    QElapsedTimer m_wallClock;
+    QElapsedTimer m_timer;
+    qint64 m_clockBytes = 0;
+    qint64 m_offsetUSecs = 0;
+    int m_periodUSecs = 10000;
+    bool m_freeRunning = false;
+};
+
+QT_END_NAMESPACE
+
+#endif
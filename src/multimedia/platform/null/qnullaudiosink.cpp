@@ -0,0 +1,354 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qnullaudiosink_p.h"
+#include "qnullmediadevices_p.h"
+
+#include <private/qaudiohelpers_p.h>
+
+#include <qdebug.h>
+
+QT_BEGIN_NAMESPACE
+
+QNullAudioSink::QNullAudioSink(QNullMediaDevices *devices)
+    : m_devices(devices)
+{
+    m_periodTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_periodTimer, &QTimer::timeout, this, &QNullAudioSink::processPeriod);
+}
+
+QNullAudioSink::~QNullAudioSink()
+{
+    close();
+    if (!m_pullMode)
+        delete m_audioSource;
+}
+
+void QNullAudioSink::setError(QAudio::Error error)
+{
+    if (m_errorState == error)
+        return;
+
+    m_errorState = error;
+    emit errorChanged(error);
+}
+
+QAudio::Error QNullAudioSink::error() const
+{
+    return m_errorState;
+}
+
+void QNullAudioSink::setState(QAudio::State state)
+{
+    if (m_deviceState == state)
+        return;
+
+    m_deviceState = state;
+    emit stateChanged(state);
+}
+
+QAudio::State QNullAudioSink::state() const
+{
+    return m_deviceState;
+}
+
+void QNullAudioSink::start(QIODevice *device)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    // Handle change of mode
+    if (m_audioSource && !m_pullMode)
+        delete m_audioSource;
+    m_audioSource = nullptr;
+
+    close();
+
+    m_pullMode = true;
+    m_audioSource = device;
+
+    if (!open()) {
+        m_audioSource = nullptr;
+        return;
+    }
+
+    setState(QAudio::ActiveState);
+}
+
+QIODevice *QNullAudioSink::start()
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    // Handle change of mode
+    if (m_audioSource && !m_pullMode)
+        delete m_audioSource;
+    m_audioSource = nullptr;
+
+    close();
+
+    m_pullMode = false;
+
+    if (!open())
+        return nullptr;
+
+    m_audioSource = new NullOutputPrivate(this);
+    m_audioSource->open(QIODevice::WriteOnly|QIODevice::Unbuffered);
+
+    setState(QAudio::IdleState);
+
+    return m_audioSource;
+}
+
+bool QNullAudioSink::open()
+{
+    if (!m_format.isValid()) {
+        setError(QAudio::OpenError);
+        setState(QAudio::StoppedState);
+        return false;
+    }
+
+    m_config = m_devices->config();
+
+    if (!m_config.outputFileName.isEmpty()) {
+        m_outputFile.setFileName(m_config.outputFileName);
+        if (!m_outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "QNullAudioSink: could not open" << m_config.outputFileName;
+            setError(QAudio::OpenError);
+            setState(QAudio::StoppedState);
+            return false;
+        }
+    }
+
+    m_clock.start(m_format, m_config);
+    if (m_bufferSize <= 0)
+        m_bufferSize = 4 * m_clock.periodBytes();
+    m_buffer.clear();
+    m_buffer.reserve(m_bufferSize);
+    m_processedBytes = 0;
+    elapsedTime.restart();
+
+    m_periodTimer.start(m_clock.interval());
+    return true;
+}
+
+void QNullAudioSink::close()
+{
+    m_periodTimer.stop();
+    m_outputFile.close();
+    m_buffer.clear();
+}
+
+void QNullAudioSink::stop()
+{
+    if (m_deviceState == QAudio::StoppedState)
+        return;
+
+    close();
+
+    setError(QAudio::NoError);
+    setState(QAudio::StoppedState);
+}
+
+void QNullAudioSink::reset()
+{
+    m_buffer.clear();
+    stop();
+}
+
+void QNullAudioSink::suspend()
+{
+    if (m_deviceState == QAudio::ActiveState || m_deviceState == QAudio::IdleState) {
+        m_periodTimer.stop();
+        m_clock.suspend();
+        setState(QAudio::SuspendedState);
+    }
+}
+
+void QNullAudioSink::resume()
+{
+    if (m_deviceState == QAudio::SuspendedState) {
+        m_clock.resume();
+        m_periodTimer.start(m_clock.interval());
+        setState(m_pullMode ? QAudio::ActiveState : QAudio::IdleState);
+        setError(QAudio::NoError);
+    }
+}
+
+qsizetype QNullAudioSink::bytesFree() const
+{
+    if (m_deviceState != QAudio::ActiveState && m_deviceState != QAudio::IdleState)
+        return 0;
+    return qMax(m_bufferSize - m_buffer.size(), qsizetype(0));
+}
+
+void QNullAudioSink::setBufferSize(qsizetype value)
+{
+    m_bufferSize = value;
+}
+
+qsizetype QNullAudioSink::bufferSize() const
+{
+    return m_bufferSize;
+}
+
+qint64 QNullAudioSink::processedUSecs() const
+{
+    return m_clock.durationForBytes(m_processedBytes);
+}
+
+void QNullAudioSink::setFormat(const QAudioFormat &format)
+{
+    m_format = format;
+}
+
+QAudioFormat QNullAudioSink::format() const
+{
+    return m_format;
+}
+
+void QNullAudioSink::setVolume(qreal vol)
+{
+    m_volume = qBound(qreal(0), vol, qreal(1));
+}
+
+qreal QNullAudioSink::volume() const
+{
+    return m_volume;
+}
+
+qint64 QNullAudioSink::write(const char *data, qint64 len)
+{
+    len = qMin(len, qint64(bytesFree()));
+    if (len <= 0)
+        return 0;
+
+    m_buffer.append(data, len);
+    if (m_deviceState == QAudio::IdleState) {
+        setError(QAudio::NoError);
+        setState(QAudio::ActiveState);
+    }
+    return len;
+}
+
+void QNullAudioSink::processPeriod()
+{
+    const qint64 due = m_clock.bytesDue();
+    if (due <= 0)
+        return;
+
+    // the clock keeps running through underruns, like a sound card would
+    m_clock.advance(due);
+
+    const char *data = nullptr;
+    qint64 len = 0;
+    if (m_pullMode) {
+        if (m_periodBuffer.size() < due)
+            m_periodBuffer.resize(due);
+        len = qMax(m_audioSource->read(m_periodBuffer.data(), due), qint64(0));
+        data = m_periodBuffer.constData();
+    } else {
+        len = qMin(due, qint64(m_buffer.size()));
+        data = m_buffer.constData();
+    }
+
+    if (len > 0) {
+        if (m_volume < 1.0) {
+            if (m_pullMode) {
+                QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, m_periodBuffer.data(), int(len));
+            } else {
+                QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, m_buffer.data(), int(len));
+                data = m_buffer.constData();
+            }
+        }
+        if (m_outputFile.isOpen())
+            m_outputFile.write(data, len);
+        if (m_config.captureOutput)
+            m_devices->appendOutputData(data, len);
+        m_processedBytes += len;
+    }
+
+    if (!m_pullMode)
+        m_buffer.remove(0, len);
+
+    if (m_config.periodHook) {
+        QNullAudioPeriod period;
+        period.mode = QAudioDevice::Output;
+        period.processedUSecs = processedUSecs();
+        period.elapsedUSecs = m_clock.elapsedUSecs();
+        period.bufferedUSecs = m_clock.durationForBytes(m_buffer.size());
+        period.bytes = len;
+        m_config.periodHook(period);
+    }
+
+    if (len < due && m_deviceState == QAudio::ActiveState) {
+        setError(QAudio::UnderrunError);
+        setState(QAudio::IdleState);
+    } else if (len > 0 && m_deviceState == QAudio::IdleState) {
+        setError(QAudio::NoError);
+        setState(QAudio::ActiveState);
+    }
+}
+
+NullOutputPrivate::NullOutputPrivate(QNullAudioSink *audio)
+{
+    m_audioDevice = audio;
+}
+
+qint64 NullOutputPrivate::readData(char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+
+    return 0;
+}
+
+qint64 NullOutputPrivate::writeData(const char *data, qint64 len)
+{
+    if (m_audioDevice->m_deviceState != QAudio::ActiveState
+        && m_audioDevice->m_deviceState != QAudio::IdleState)
+        return 0;
+
+    return m_audioDevice->write(data, len);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qnullaudiosink_p.cpp"
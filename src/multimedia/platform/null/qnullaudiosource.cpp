@@ -0,0 +1,358 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qnullaudiosource_p.h"
+#include "qnullmediadevices_p.h"
+
+#include <private/qaudiohelpers_p.h>
+
+#include <qdebug.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+QNullAudioSource::QNullAudioSource(QNullMediaDevices *devices)
+    : m_devices(devices)
+{
+    m_periodTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_periodTimer, &QTimer::timeout, this, &QNullAudioSource::processPeriod);
+}
+
+QNullAudioSource::~QNullAudioSource()
+{
+    close();
+    if (!m_pullMode)
+        delete m_audioSource;
+}
+
+void QNullAudioSource::setError(QAudio::Error error)
+{
+    if (m_errorState == error)
+        return;
+
+    m_errorState = error;
+    emit errorChanged(error);
+}
+
+QAudio::Error QNullAudioSource::error() const
+{
+    return m_errorState;
+}
+
+void QNullAudioSource::setState(QAudio::State state)
+{
+    if (m_deviceState == state)
+        return;
+
+    m_deviceState = state;
+    emit stateChanged(state);
+}
+
+QAudio::State QNullAudioSource::state() const
+{
+    return m_deviceState;
+}
+
+void QNullAudioSource::start(QIODevice *device)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    if (!m_pullMode && m_audioSource) {
+        delete m_audioSource;
+        m_audioSource = nullptr;
+    }
+
+    close();
+
+    if (!open())
+        return;
+
+    m_pullMode = true;
+    m_audioSource = device;
+
+    setState(QAudio::ActiveState);
+}
+
+QIODevice *QNullAudioSource::start()
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    if (!m_pullMode && m_audioSource) {
+        delete m_audioSource;
+        m_audioSource = nullptr;
+    }
+
+    close();
+
+    if (!open())
+        return nullptr;
+
+    m_pullMode = false;
+    m_audioSource = new NullInputPrivate(this);
+    m_audioSource->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    setState(QAudio::IdleState);
+
+    return m_audioSource;
+}
+
+bool QNullAudioSource::open()
+{
+    if (!m_format.isValid()) {
+        setError(QAudio::OpenError);
+        setState(QAudio::StoppedState);
+        return false;
+    }
+
+    m_config = m_devices->config();
+
+    if (!m_config.inputFileName.isEmpty()) {
+        m_inputFile.setFileName(m_config.inputFileName);
+        if (!m_inputFile.open(QIODevice::ReadOnly) || m_inputFile.size() == 0) {
+            qWarning() << "QNullAudioSource: could not read" << m_config.inputFileName;
+            m_inputFile.close();
+            setError(QAudio::OpenError);
+            setState(QAudio::StoppedState);
+            return false;
+        }
+    }
+    m_inputPosition = 0;
+
+    m_clock.start(m_format, m_config);
+    if (m_bufferSize <= 0)
+        m_bufferSize = 4 * m_clock.periodBytes();
+    m_buffer.clear();
+    m_buffer.reserve(m_bufferSize);
+    m_processedBytes = 0;
+    elapsedTime.restart();
+
+    m_periodTimer.start(m_clock.interval());
+    return true;
+}
+
+void QNullAudioSource::close()
+{
+    m_periodTimer.stop();
+    m_inputFile.close();
+    m_buffer.clear();
+}
+
+void QNullAudioSource::stop()
+{
+    if (m_deviceState == QAudio::StoppedState)
+        return;
+
+    close();
+
+    setError(QAudio::NoError);
+    setState(QAudio::StoppedState);
+}
+
+void QNullAudioSource::reset()
+{
+    m_buffer.clear();
+}
+
+void QNullAudioSource::suspend()
+{
+    if (m_deviceState == QAudio::ActiveState || m_deviceState == QAudio::IdleState) {
+        m_periodTimer.stop();
+        m_clock.suspend();
+        setState(QAudio::SuspendedState);
+    }
+}
+
+void QNullAudioSource::resume()
+{
+    if (m_deviceState == QAudio::SuspendedState) {
+        m_clock.resume();
+        m_periodTimer.start(m_clock.interval());
+        setState(QAudio::ActiveState);
+        setError(QAudio::NoError);
+    }
+}
+
+qsizetype QNullAudioSource::bytesReady() const
+{
+    return m_buffer.size();
+}
+
+void QNullAudioSource::setBufferSize(qsizetype value)
+{
+    m_bufferSize = value;
+}
+
+qsizetype QNullAudioSource::bufferSize() const
+{
+    return m_bufferSize;
+}
+
+qint64 QNullAudioSource::processedUSecs() const
+{
+    return m_clock.durationForBytes(m_processedBytes);
+}
+
+void QNullAudioSource::setFormat(const QAudioFormat &format)
+{
+    m_format = format;
+}
+
+QAudioFormat QNullAudioSource::format() const
+{
+    return m_format;
+}
+
+void QNullAudioSource::setVolume(qreal vol)
+{
+    m_volume = qBound(qreal(0), vol, qreal(1));
+}
+
+qreal QNullAudioSource::volume() const
+{
+    return m_volume;
+}
+
+qint64 QNullAudioSource::read(char *data, qint64 len)
+{
+    len = qMin(len, qint64(m_buffer.size()));
+    if (len <= 0)
+        return 0;
+
+    memcpy(data, m_buffer.constData(), len);
+    m_buffer.remove(0, len);
+    return len;
+}
+
+void QNullAudioSource::generate(char *data, qint64 len)
+{
+    if (m_inputFile.isOpen()) {
+        while (len > 0) {
+            const qint64 read = m_inputFile.read(data, len);
+            if (read <= 0) {
+                m_inputFile.seek(0);
+                continue;
+            }
+            data += read;
+            len -= read;
+        }
+    } else if (!m_config.inputData.isEmpty()) {
+        const QByteArray &input = m_config.inputData;
+        while (len > 0) {
+            const qint64 chunk = qMin(len, qint64(input.size() - m_inputPosition));
+            memcpy(data, input.constData() + m_inputPosition, chunk);
+            m_inputPosition = (m_inputPosition + chunk) % input.size();
+            data += chunk;
+            len -= chunk;
+        }
+    } else {
+        // unsigned 8 bit samples are silent at their midpoint
+        memset(data, m_format.sampleFormat() == QAudioFormat::UInt8 ? 0x80 : 0, len);
+    }
+}
+
+void QNullAudioSource::processPeriod()
+{
+    const qint64 due = m_clock.bytesDue();
+    if (due <= 0)
+        return;
+
+    m_clock.advance(due);
+
+    if (m_periodBuffer.size() < due)
+        m_periodBuffer.resize(due);
+    char *data = m_periodBuffer.data();
+    generate(data, due);
+    if (m_volume < 1.0)
+        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, data, int(due));
+
+    qint64 len = due;
+    if (m_pullMode) {
+        len = qMax(m_audioSource->write(data, due), qint64(0));
+    } else {
+        // like a sound card, drop what does not fit into the buffer
+        len = qMin(due, qint64(m_bufferSize - m_buffer.size()));
+        if (len > 0)
+            m_buffer.append(data, len);
+    }
+    m_processedBytes += len;
+
+    if (m_config.periodHook) {
+        QNullAudioPeriod period;
+        period.mode = QAudioDevice::Input;
+        period.processedUSecs = processedUSecs();
+        period.elapsedUSecs = m_clock.elapsedUSecs();
+        period.bufferedUSecs = m_clock.durationForBytes(m_buffer.size());
+        period.bytes = len;
+        m_config.periodHook(period);
+    }
+
+    if (len < due)
+        setError(QAudio::OverrunError);
+
+    if (!m_pullMode && len > 0) {
+        setState(QAudio::ActiveState);
+        emit m_audioSource->readyRead();
+    }
+}
+
+NullInputPrivate::NullInputPrivate(QNullAudioSource *audio)
+{
+    m_audioDevice = audio;
+}
+
+qint64 NullInputPrivate::readData(char *data, qint64 len)
+{
+    return m_audioDevice->read(data, len);
+}
+
+qint64 NullInputPrivate::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+
+    return 0;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qnullaudiosource_p.cpp"
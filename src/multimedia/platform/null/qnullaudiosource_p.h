@@ -0,0 +1,144 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNULLAUDIOSOURCE_H
+#define QNULLAUDIOSOURCE_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qnullaudioclock_p.h"
+
+#include <private/qaudiosystem_p.h>
+
+#include <qfile.h>
+#include <qtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QNullMediaDevices;
+
+class QNullAudioSource : public QPlatformAudioSource
+{
+    friend class NullInputPrivate;
+    Q_OBJECT
+
+public:
+    QNullAudioSource(QNullMediaDevices *devices);
+    ~QNullAudioSource();
+
+    void start(QIODevice *device) override;
+    QIODevice *start() override;
+    void stop() override;
+    void reset() override;
+    void suspend() override;
+    void resume() override;
+    qsizetype bytesReady() const override;
+    void setBufferSize(qsizetype value) override;
+    qsizetype bufferSize() const override;
+    qint64 processedUSecs() const override;
+    QAudio::Error error() const override;
+    QAudio::State state() const override;
+    void setFormat(const QAudioFormat &format) override;
+    QAudioFormat format() const override;
+
+    void setVolume(qreal volume) override;
+    qreal volume() const override;
+
+private:
+    void setState(QAudio::State state);
+    void setError(QAudio::Error error);
+
+    bool open();
+    void close();
+    qint64 read(char *data, qint64 len);
+    void generate(char *data, qint64 len);
+
+private Q_SLOTS:
+    void processPeriod();
+
+private:
+    QNullMediaDevices *m_devices;
+    QNullAudioConfig m_config;
+    QNullAudioClock m_clock;
+    QAudioFormat m_format;
+    QAudio::Error m_errorState = QAudio::NoError;
+    QAudio::State m_deviceState = QAudio::StoppedState;
+    bool m_pullMode = true;
+    QIODevice *m_audioSource = nullptr;
+    QTimer m_periodTimer;
+    QFile m_inputFile;
+    qsizetype m_inputPosition = 0;
+    // recorded data, that has not been read from start()'s device yet
+    QByteArray m_buffer;
+    QByteArray m_periodBuffer;
+    qsizetype m_bufferSize = 0;
+    qint64 m_processedBytes = 0;
+    qreal m_volume = 1.0;
+};
+
+class NullInputPrivate : public QIODevice
+{
+    friend class QNullAudioSource;
+    Q_OBJECT
+
+public:
+    NullInputPrivate(QNullAudioSource *audio);
+    ~NullInputPrivate() override = default;
+
+protected:
+    qint64 readData(char *data, qint64 len) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    QNullAudioSource *m_audioDevice;
+};
+
+QT_END_NAMESPACE
+
+#endif
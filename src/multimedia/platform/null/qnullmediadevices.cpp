@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qnullmediadevices_p.h"
+#include "qnullaudiosink_p.h"
+#include "qnullaudiosource_p.h"
+
+#include <private/qaudiodevice_p.h>
+#include <qcameradevice.h>
+
+QT_BEGIN_NAMESPACE
+
+static QAudioDevice nullAudioDevice(QAudioDevice::Mode mode)
+{
+    auto *dev = new QAudioDevicePrivate("null", mode);
+    dev->description = mode == QAudioDevice::Input
+            ? QStringLiteral("Null Audio Input")
+            : QStringLiteral("Null Audio Output");
+    dev->isDefault = true;
+    dev->minimumSampleRate = 1;
+    dev->maximumSampleRate = 384000;
+    dev->minimumChannelCount = 1;
+    dev->maximumChannelCount = 32;
+    dev->supportedSampleFormats = { QAudioFormat::UInt8, QAudioFormat::Int16,
+                                    QAudioFormat::Int32, QAudioFormat::Float };
+    dev->preferredFormat.setSampleRate(48000);
+    dev->preferredFormat.setChannelCount(2);
+    dev->preferredFormat.setSampleFormat(QAudioFormat::Int16);
+    return dev->create();
+}
+
+QNullMediaDevices::QNullMediaDevices() = default;
+
+QNullMediaDevices::~QNullMediaDevices() = default;
+
+QList<QAudioDevice> QNullMediaDevices::audioInputs() const
+{
+    return { nullAudioDevice(QAudioDevice::Input) };
+}
+
+QList<QAudioDevice> QNullMediaDevices::audioOutputs() const
+{
+    return { nullAudioDevice(QAudioDevice::Output) };
+}
+
+QList<QCameraDevice> QNullMediaDevices::videoInputs() const
+{
+    return {};
+}
+
+QPlatformAudioSource *QNullMediaDevices::createAudioSource(const QAudioDevice &deviceInfo)
+{
+    Q_UNUSED(deviceInfo);
+    return new QNullAudioSource(this);
+}
+
+QPlatformAudioSink *QNullMediaDevices::createAudioSink(const QAudioDevice &deviceInfo)
+{
+    Q_UNUSED(deviceInfo);
+    return new QNullAudioSink(this);
+}
+
+QT_END_NAMESPACE
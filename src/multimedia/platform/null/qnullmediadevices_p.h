@@ -0,0 +1,145 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNULLMEDIADEVICES_H
+#define QNULLMEDIADEVICES_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qplatformmediadevices_p.h>
+#include <qaudiodevice.h>
+#include <qbytearray.h>
+#include <qmutex.h>
+#include <qstring.h>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+struct QNullAudioPeriod
+{
+    QAudioDevice::Mode mode = QAudioDevice::Output;
+    // audio played or recorded since the start
+    qint64 processedUSecs = 0;
+    // wall clock time since the start
+    qint64 elapsedUSecs = 0;
+    // audio waiting in the buffer, the latency of the newest sample
+    qint64 bufferedUSecs = 0;
+    // bytes consumed or produced in this period
+    qint64 bytes = 0;
+};
+
+struct QNullAudioConfig
+{
+    enum Clock {
+        // consumes and produces audio at the rate of the audio format
+        RealTime,
+        // processes one period per event loop iteration
+        FreeRunning
+    };
+
+    Clock clock = RealTime;
+    int periodUSecs = 10000;
+
+    // sinks write all consumed data to this file
+    QString outputFileName;
+    // sinks keep all consumed data, see QNullMediaDevices::outputData()
+    bool captureOutput = false;
+
+    // sources loop the raw PCM data from this file, or from inputData,
+    // or produce silence
+    QString inputFileName;
+    QByteArray inputData;
+
+    // called from the thread of the sink or source after each period
+    std::function<void(const QNullAudioPeriod &)> periodHook;
+};
+
+class Q_MULTIMEDIA_EXPORT QNullMediaDevices : public QPlatformMediaDevices
+{
+public:
+    QNullMediaDevices();
+    ~QNullMediaDevices();
+
+    QList<QAudioDevice> audioInputs() const override;
+    QList<QAudioDevice> audioOutputs() const override;
+    QList<QCameraDevice> videoInputs() const override;
+    QPlatformAudioSource *createAudioSource(const QAudioDevice &deviceInfo) override;
+    QPlatformAudioSink *createAudioSink(const QAudioDevice &deviceInfo) override;
+
+    // applies to sinks and sources started afterwards
+    void setConfig(const QNullAudioConfig &config) { m_config = config; }
+    const QNullAudioConfig &config() const { return m_config; }
+
+    // sinks append from their own thread
+    QByteArray outputData() const
+    {
+        QMutexLocker locker(&m_outputMutex);
+        return m_outputData;
+    }
+    void clearOutputData()
+    {
+        QMutexLocker locker(&m_outputMutex);
+        m_outputData.clear();
+    }
+    void appendOutputData(const char *data, qint64 len)
+    {
+        QMutexLocker locker(&m_outputMutex);
+        m_outputData.append(data, len);
+    }
+
+private:
+    QNullAudioConfig m_config;
+    mutable QMutex m_outputMutex;
+    QByteArray m_outputData;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,77 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qnullmediaintegration_p.h"
+#include "qnullmediadevices_p.h"
+
+#include <private/qplatformmediaformatinfo_p.h>
+
+QT_BEGIN_NAMESPACE
+
+QNullMediaIntegration::QNullMediaIntegration()
+{
+}
+
+QNullMediaIntegration::~QNullMediaIntegration()
+{
+    delete m_devices;
+    delete m_formatInfo;
+}
+
+QPlatformMediaDevices *QNullMediaIntegration::devices()
+{
+    return nullDevices();
+}
+
+QNullMediaDevices *QNullMediaIntegration::nullDevices()
+{
+    if (!m_devices)
+        m_devices = new QNullMediaDevices();
+    return m_devices;
+}
+
+QPlatformMediaFormatInfo *QNullMediaIntegration::formatInfo()
+{
+    if (!m_formatInfo)
+        m_formatInfo = new QPlatformMediaFormatInfo();
+    return m_formatInfo;
+}
+
+QT_END_NAMESPACE
@@ -41,14 +41,47 @@
 
 #include <qaudiodevice.h>
 #include <QTimer>
+#include <QtCore/qthread.h>
 #include "qaudioengine_pulse_p.h"
 #include "qpulseaudiodevice_p.h"
 #include "qpulsehelpers_p.h"
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
+static bool updateDefaultDevice(QMap<int, QAudioDevice> &devices, const QByteArray &defaultId,
+                                QAudioDevice::Mode mode)
+{
+    bool changed = false;
+    for (auto it = devices.begin(); it != devices.end(); ++it) {
+        const bool isDefault = it->id() == defaultId;
+        if (it->isDefault() == isDefault)
+            continue;
+        auto *dinfo = new QPulseAudioDeviceInfo(it->id().constData(), it->description().toUtf8().constData(),
+                                                isDefault, mode);
+        *it = dinfo->create();
+        changed = true;
+    }
+    return changed;
+}
+
+static bool insertDevice(QMap<int, QAudioDevice> &devices, int index, const char *name,
+                         const char *description, bool isDefault, QAudioDevice::Mode mode)
+{
+    auto existing = devices.constFind(index);
+    if (existing != devices.constEnd() && existing->id() == name
+        && existing->description() == QString::fromUtf8(description)
+        && existing->isDefault() == isDefault) {
+        return false;
+    }
+    auto *dinfo = new QPulseAudioDeviceInfo(name, description, isDefault, mode);
+    devices.insert(index, dinfo->create());
+    return true;
+}
+
 static void serverInfoCallback(pa_context *context, const pa_server_info *info, void *userdata)
 {
     if (!info) {
@@ -81,12 +114,28 @@ static void serverInfoCallback(pa_context *context, const pa_server_info *info,
 #endif
 
     QPulseAudioEngine *pulseEngine = static_cast<QPulseAudioEngine*>(userdata);
+    QByteArray defaultSink = info->default_sink_name;
+    QByteArray defaultSource = info->default_source_name;
+
     pulseEngine->m_serverLock.lockForWrite();
-    pulseEngine->m_defaultSink = info->default_sink_name;
-    pulseEngine->m_defaultSource = info->default_source_name;
-    // ### ensure the QAudioDevices are updated if default changes and emit changed signal in the device manager
+    const bool sinkChanged = pulseEngine->m_defaultSink != defaultSink;
+    const bool sourceChanged = pulseEngine->m_defaultSource != defaultSource;
+    pulseEngine->m_defaultSink = defaultSink;
+    pulseEngine->m_defaultSource = defaultSource;
     pulseEngine->m_serverLock.unlock();
 
+    // Refresh the isDefault flag of the devices we already know about
+    if (sinkChanged) {
+        QWriteLocker locker(&pulseEngine->m_sinkLock);
+        if (updateDefaultDevice(pulseEngine->m_sinks, defaultSink, QAudioDevice::Output))
+            emit pulseEngine->audioOutputsChanged();
+    }
+    if (sourceChanged) {
+        QWriteLocker locker(&pulseEngine->m_sourceLock);
+        if (updateDefaultDevice(pulseEngine->m_sources, defaultSource, QAudioDevice::Input))
+            emit pulseEngine->audioInputsChanged();
+    }
+
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
 
@@ -100,6 +149,10 @@ static void sinkInfoCallback(pa_context *context, const pa_sink_info *info, int
     }
 
     if (isLast) {
+        if (pulseEngine->m_sinksChanged) {
+            pulseEngine->m_sinksChanged = false;
+            emit pulseEngine->audioOutputsChanged();
+        }
         pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
         return;
     }
@@ -123,18 +176,29 @@ static void sinkInfoCallback(pa_context *context, const pa_sink_info *info, int
                   info->description);
 #endif
 
+    QReadLocker serverLocker(&pulseEngine->m_serverLock);
     QWriteLocker locker(&pulseEngine->m_sinkLock);
     bool isDefault = pulseEngine->m_defaultSink == info->name;
-    auto *dinfo = new QPulseAudioDeviceInfo(info->name, info->description, isDefault, QAudioDevice::Output);
-    pulseEngine->m_sinks.insert(info->index, dinfo->create());
+    if (insertDevice(pulseEngine->m_sinks, info->index, info->name, info->description, isDefault,
+                     QAudioDevice::Output)) {
+        pulseEngine->m_sinksChanged = true;
+    }
 }
 
 static void sourceInfoCallback(pa_context *context, const pa_source_info *info, int isLast, void *userdata)
 {
-    Q_UNUSED(context);
     QPulseAudioEngine *pulseEngine = static_cast<QPulseAudioEngine*>(userdata);
 
+    if (isLast < 0) {
+        qWarning() << QString::fromLatin1("Failed to get source information: %s").arg(QString::fromUtf8(pa_strerror(pa_context_errno(context))));
+        return;
+    }
+
     if (isLast) {
+        if (pulseEngine->m_sourcesChanged) {
+            pulseEngine->m_sourcesChanged = false;
+            emit pulseEngine->audioInputsChanged();
+        }
         pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
         return;
     }
@@ -158,13 +222,29 @@ static void sourceInfoCallback(pa_context *context, const pa_source_info *info,
               info->description);
 #endif
 
-    QWriteLocker locker(&pulseEngine->m_sourceLock);
     // skip monitor channels
     if (info->monitor_of_sink != PA_INVALID_INDEX)
         return;
-    bool isDefault = pulseEngine->m_defaultSink == info->name;
-    auto *dinfo = new QPulseAudioDeviceInfo(info->name, info->description, isDefault, QAudioDevice::Input);
-    pulseEngine->m_sources.insert(info->index, dinfo->create());
+
+    QReadLocker serverLocker(&pulseEngine->m_serverLock);
+    QWriteLocker locker(&pulseEngine->m_sourceLock);
+    bool isDefault = pulseEngine->m_defaultSource == info->name;
+    if (insertDevice(pulseEngine->m_sources, info->index, info->name, info->description, isDefault,
+                     QAudioDevice::Input)) {
+        pulseEngine->m_sourcesChanged = true;
+    }
+}
+
+// The replies to the initial list requests. Sources are listed last, so the
+// first enumeration is complete once their list has arrived.
+static void sourceListCallback(pa_context *context, const pa_source_info *info, int isLast, void *userdata)
+{
+    sourceInfoCallback(context, info, isLast, userdata);
+    if (isLast) {
+        QPulseAudioEngine *pulseEngine = static_cast<QPulseAudioEngine*>(userdata);
+        pulseEngine->m_devicesListed = true;
+        pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+    }
 }
 
 static void event_cb(pa_context* context, pa_subscription_event_type_t t, uint32_t index, void* userdata)
@@ -208,16 +288,22 @@ static void event_cb(pa_context* context, pa_subscription_event_type_t t, uint32
         break;
     case PA_SUBSCRIPTION_EVENT_REMOVE:
         switch (facility) {
-        case PA_SUBSCRIPTION_EVENT_SINK:
+        case PA_SUBSCRIPTION_EVENT_SINK: {
             pulseEngine->m_sinkLock.lockForWrite();
-            pulseEngine->m_sinks.remove(index);
+            bool removed = pulseEngine->m_sinks.remove(index);
             pulseEngine->m_sinkLock.unlock();
+            if (removed)
+                emit pulseEngine->audioOutputsChanged();
             break;
-        case PA_SUBSCRIPTION_EVENT_SOURCE:
+        }
+        case PA_SUBSCRIPTION_EVENT_SOURCE: {
             pulseEngine->m_sourceLock.lockForWrite();
-            pulseEngine->m_sources.remove(index);
+            bool removed = pulseEngine->m_sources.remove(index);
             pulseEngine->m_sourceLock.unlock();
+            if (removed)
+                emit pulseEngine->audioInputsChanged();
             break;
+        }
         default:
             break;
         }
@@ -227,27 +313,165 @@ static void event_cb(pa_context* context, pa_subscription_event_type_t t, uint32
     }
 }
 
-static void contextStateCallbackInit(pa_context *context, void *userdata)
+static void contextStateCallback(pa_context *c, void *userdata)
 {
-    Q_UNUSED(context);
+    QPulseAudioEngine *self = reinterpret_cast<QPulseAudioEngine*>(userdata);
+    pa_context_state_t state = pa_context_get_state(c);
+
 #ifdef DEBUG_PULSE
-    qDebug() << QPulseAudioInternal::stateToQString(pa_context_get_state(context));
+    qDebug() << QPulseAudioInternal::stateToQString(state);
 #endif
-    QPulseAudioEngine *pulseEngine = reinterpret_cast<QPulseAudioEngine*>(userdata);
-    pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+
+    switch (state) {
+    case PA_CONTEXT_READY: {
+#ifdef DEBUG_PULSE
+        qDebug("Connection established.");
+#endif
+        pa_context_set_subscribe_callback(c, event_cb, self);
+        pa_operation *op = pa_context_subscribe(c,
+                                                pa_subscription_mask_t(PA_SUBSCRIPTION_MASK_SINK |
+                                                                       PA_SUBSCRIPTION_MASK_SOURCE |
+                                                                       PA_SUBSCRIPTION_MASK_SERVER),
+                                                nullptr, nullptr);
+        if (op)
+            pa_operation_unref(op);
+        else
+            qWarning("PulseAudioService: failed to subscribe to context notifications");
+
+        // Replies arrive in request order, so the default devices are known
+        // by the time the device lists come in.
+        op = pa_context_get_server_info(c, serverInfoCallback, self);
+        if (op)
+            pa_operation_unref(op);
+        else
+            qWarning("PulseAudioService: failed to get server info");
+
+        op = pa_context_get_sink_info_list(c, sinkInfoCallback, self);
+        if (op)
+            pa_operation_unref(op);
+        else
+            qWarning("PulseAudioService: failed to get sink info");
+
+        op = pa_context_get_source_info_list(c, sourceListCallback, self);
+        if (op) {
+            pa_operation_unref(op);
+        } else {
+            qWarning("PulseAudioService: failed to get source info");
+            self->m_devicesListed = true;
+        }
+        break;
+    }
+    case PA_CONTEXT_TERMINATED:
+        qCritical("PulseAudioService: Context terminated.");
+        break;
+    case PA_CONTEXT_FAILED:
+        qCritical() << QString::fromLatin1("PulseAudioService: Connection failure: %1")
+                        .arg(QString::fromUtf8(pa_strerror(pa_context_errno(c))));
+        QMetaObject::invokeMethod(self, "onContextFailed", Qt::QueuedConnection);
+        break;
+    default:
+        break;
+    }
+
+    pa_threaded_mainloop_signal(self->mainloop(), 0);
 }
 
-static void contextStateCallback(pa_context *c, void *userdata)
+static int maxStreamContexts()
 {
-    QPulseAudioEngine *self = reinterpret_cast<QPulseAudioEngine*>(userdata);
-    pa_context_state_t state = pa_context_get_state(c);
+    static const int count = [] {
+        bool ok = false;
+        int n = qEnvironmentVariableIntValue("QT_PA_STREAM_CONTEXTS", &ok);
+        if (!ok || n <= 0)
+            n = qBound(1, QThread::idealThreadCount(), 8);
+        return n;
+    }();
+    return count;
+}
+
+std::shared_ptr<QPulseAudioContext> QPulseAudioContext::create(QPulseAudioEngine *engine, int index)
+{
+    std::shared_ptr<QPulseAudioContext> self(new QPulseAudioContext);
+    self->m_engine = engine;
+
+    self->m_mainLoop = pa_threaded_mainloop_new();
+    if (self->m_mainLoop == nullptr) {
+        qWarning("PulseAudioService: unable to create pulseaudio mainloop");
+        return {};
+    }
+
+    if (pa_threaded_mainloop_start(self->m_mainLoop) != 0) {
+        qWarning("PulseAudioService: unable to start pulseaudio mainloop");
+        return {};
+    }
+
+    self->lock();
+
+    const QByteArray name = QString(QLatin1String("QtPulseAudio:%1:%2")).arg(::getpid()).arg(index).toLatin1();
+    self->m_context = pa_context_new(pa_threaded_mainloop_get_api(self->m_mainLoop), name.constData());
+    if (self->m_context == nullptr) {
+        qWarning("PulseAudioService: Unable to create new pulseaudio context");
+        self->unlock();
+        return {};
+    }
+
+    pa_context_set_state_callback(self->m_context, stateCallback, self.get());
+
+    if (pa_context_connect(self->m_context, nullptr, (pa_context_flags_t)0, nullptr) < 0) {
+        qWarning("PulseAudioService: pa_context_connect() failed");
+        self->unlock();
+        return {};
+    }
+
+    self->unlock();
+
+    return self;
+}
+
+QPulseAudioContext::~QPulseAudioContext()
+{
+    if (m_context) {
+        lock();
+        pa_context_set_state_callback(m_context, nullptr, nullptr);
+        pa_context_disconnect(m_context);
+        pa_context_unref(m_context);
+        unlock();
+    }
+
+    if (m_mainLoop) {
+        pa_threaded_mainloop_stop(m_mainLoop);
+        pa_threaded_mainloop_free(m_mainLoop);
+    }
+}
+
+void QPulseAudioContext::stateCallback(pa_context *context, void *userdata)
+{
+    QPulseAudioContext *self = static_cast<QPulseAudioContext *>(userdata);
+    pa_context_state_t state = pa_context_get_state(context);
 
 #ifdef DEBUG_PULSE
     qDebug() << QPulseAudioInternal::stateToQString(state);
 #endif
 
-    if (state == PA_CONTEXT_FAILED)
-        QMetaObject::invokeMethod(self, "onContextFailed", Qt::QueuedConnection);
+    if (state == PA_CONTEXT_FAILED) {
+        qWarning() << QString::fromLatin1("PulseAudioService: Stream context failure: %1")
+                      .arg(QString::fromUtf8(pa_strerror(pa_context_errno(context))));
+        QMetaObject::invokeMethod(self->m_engine, "onStreamContextFailed", Qt::QueuedConnection);
+    }
+
+    pa_threaded_mainloop_signal(self->m_mainLoop, 0);
+}
+
+bool QPulseAudioContext::waitForReady()
+{
+    lock();
+    pa_context_state_t state = pa_context_get_state(m_context);
+    while (PA_CONTEXT_IS_GOOD(state) && state != PA_CONTEXT_READY) {
+        pa_threaded_mainloop_wait(m_mainLoop);
+        state = pa_context_get_state(m_context);
+    }
+    unlock();
+
+    return state == PA_CONTEXT_READY;
 }
 
 Q_GLOBAL_STATIC(QPulseAudioEngine, pulseEngine);
@@ -269,9 +493,6 @@ QPulseAudioEngine::~QPulseAudioEngine()
 
 void QPulseAudioEngine::prepare()
 {
-    bool keepGoing = true;
-    bool ok = true;
-
     m_mainLoop = pa_threaded_mainloop_new();
     if (m_mainLoop == nullptr) {
         qWarning("PulseAudioService: unable to create pulseaudio mainloop");
@@ -289,91 +510,63 @@ void QPulseAudioEngine::prepare()
 
     lock();
 
+    m_devicesListed = false;
     m_context = pa_context_new(m_mainLoopApi, QString(QLatin1String("QtPulseAudio:%1")).arg(::getpid()).toLatin1().constData());
 
     if (m_context == nullptr) {
         qWarning("PulseAudioService: Unable to create new pulseaudio context");
         pa_threaded_mainloop_unlock(m_mainLoop);
+        pa_threaded_mainloop_stop(m_mainLoop);
         pa_threaded_mainloop_free(m_mainLoop);
         m_mainLoop = nullptr;
         onContextFailed();
         return;
     }
 
-    pa_context_set_state_callback(m_context, contextStateCallbackInit, this);
+    // The connection is established asynchronously; contextStateCallback()
+    // subscribes to server events and fetches the device lists once the
+    // context is ready, and emits the change signals when they arrive.
+    pa_context_set_state_callback(m_context, contextStateCallback, this);
 
     if (pa_context_connect(m_context, nullptr, (pa_context_flags_t)0, nullptr) < 0) {
         qWarning("PulseAudioService: pa_context_connect() failed");
         pa_context_unref(m_context);
         pa_threaded_mainloop_unlock(m_mainLoop);
+        pa_threaded_mainloop_stop(m_mainLoop);
         pa_threaded_mainloop_free(m_mainLoop);
         m_mainLoop = nullptr;
         m_context = nullptr;
         return;
     }
 
-    pa_threaded_mainloop_wait(m_mainLoop);
+    unlock();
 
-    while (keepGoing) {
-        switch (pa_context_get_state(m_context)) {
-            case PA_CONTEXT_CONNECTING:
-            case PA_CONTEXT_AUTHORIZING:
-            case PA_CONTEXT_SETTING_NAME:
-                break;
+    QMutexLocker locker(&m_streamContextsLock);
+    m_prepared = true;
+}
 
-            case PA_CONTEXT_READY:
-#ifdef DEBUG_PULSE
-                qDebug("Connection established.");
-#endif
-                keepGoing = false;
-                break;
-
-            case PA_CONTEXT_TERMINATED:
-                qCritical("PulseAudioService: Context terminated.");
-                keepGoing = false;
-                ok = false;
-                break;
-
-            case PA_CONTEXT_FAILED:
-            default:
-                qCritical() << QString::fromLatin1("PulseAudioService: Connection failure: %1")
-                                .arg(QString::fromUtf8(pa_strerror(pa_context_errno(m_context))));
-                keepGoing = false;
-                ok = false;
+std::shared_ptr<QPulseAudioContext> QPulseAudioEngine::streamContext()
+{
+    QMutexLocker locker(&m_streamContextsLock);
+    if (!m_prepared)
+        return {};
+
+    // Every user of a context holds a reference to it, the engine holds one more
+    auto least = std::min_element(m_streamContexts.cbegin(), m_streamContexts.cend(),
+                                  [](const auto &a, const auto &b) { return a.use_count() < b.use_count(); });
+
+    if (least == m_streamContexts.cend()
+        || (least->use_count() > 1 && int(m_streamContexts.size()) < maxStreamContexts())) {
+        auto context = QPulseAudioContext::create(this, int(m_streamContexts.size()));
+        if (context) {
+            m_streamContexts.push_back(context);
+            return context;
         }
-
-        if (keepGoing)
-            pa_threaded_mainloop_wait(m_mainLoop);
+        if (least == m_streamContexts.cend())
+            return {};
     }
 
-    if (ok) {
-        pa_context_set_state_callback(m_context, contextStateCallback, this);
-
-        pa_context_set_subscribe_callback(m_context, event_cb, this);
-        pa_operation *op = pa_context_subscribe(m_context,
-                                                pa_subscription_mask_t(PA_SUBSCRIPTION_MASK_SINK |
-                                                                       PA_SUBSCRIPTION_MASK_SOURCE |
-                                                                       PA_SUBSCRIPTION_MASK_SERVER),
-                                                nullptr, nullptr);
-        if (op)
-            pa_operation_unref(op);
-        else
-            qWarning("PulseAudioService: failed to subscribe to context notifications");
-    } else {
-        pa_context_unref(m_context);
-        m_context = nullptr;
-    }
-
-    unlock();
-
-    if (ok) {
-        updateDevices();
-        m_prepared = true;
-    } else {
-        pa_threaded_mainloop_free(m_mainLoop);
-        m_mainLoop = nullptr;
-        onContextFailed();
-    }
+    return *least;
 }
 
 void QPulseAudioEngine::release()
@@ -381,6 +574,13 @@ void QPulseAudioEngine::release()
     if (!m_prepared)
         return;
 
+    {
+        // Streams that are still open keep their context alive until they are closed
+        QMutexLocker locker(&m_streamContextsLock);
+        m_streamContexts.clear();
+        m_prepared = false;
+    }
+
     if (m_context) {
         pa_context_disconnect(m_context);
         pa_context_unref(m_context);
@@ -392,45 +592,6 @@ void QPulseAudioEngine::release()
         pa_threaded_mainloop_free(m_mainLoop);
         m_mainLoop = nullptr;
     }
-
-    m_prepared = false;
-}
-
-void QPulseAudioEngine::updateDevices()
-{
-    lock();
-
-    // Get default input and output devices
-    pa_operation *operation = pa_context_get_server_info(m_context, serverInfoCallback, this);
-    if (operation) {
-        while (pa_operation_get_state(operation) == PA_OPERATION_RUNNING)
-            pa_threaded_mainloop_wait(m_mainLoop);
-        pa_operation_unref(operation);
-    } else {
-        qWarning("PulseAudioService: failed to get server info");
-    }
-
-    // Get output devices
-    operation = pa_context_get_sink_info_list(m_context, sinkInfoCallback, this);
-    if (operation) {
-        while (pa_operation_get_state(operation) == PA_OPERATION_RUNNING)
-            pa_threaded_mainloop_wait(m_mainLoop);
-        pa_operation_unref(operation);
-    } else {
-        qWarning("PulseAudioService: failed to get sink info");
-    }
-
-    // Get input devices
-    operation = pa_context_get_source_info_list(m_context, sourceInfoCallback, this);
-    if (operation) {
-        while (pa_operation_get_state(operation) == PA_OPERATION_RUNNING)
-            pa_threaded_mainloop_wait(m_mainLoop);
-        pa_operation_unref(operation);
-    } else {
-        qWarning("PulseAudioService: failed to get source info");
-    }
-
-    unlock();
 }
 
 void QPulseAudioEngine::onContextFailed()
@@ -440,10 +601,36 @@ void QPulseAudioEngine::onContextFailed()
 
     release();
 
+    // Devices are re-enumerated once the new context is ready
+    m_sinksChanged = false;
+    m_sourcesChanged = false;
+    bool hadSinks, hadSources;
+    {
+        QWriteLocker locker(&m_sinkLock);
+        hadSinks = !m_sinks.isEmpty();
+        m_sinks.clear();
+    }
+    {
+        QWriteLocker locker(&m_sourceLock);
+        hadSources = !m_sources.isEmpty();
+        m_sources.clear();
+    }
+    if (hadSinks)
+        emit audioOutputsChanged();
+    if (hadSources)
+        emit audioInputsChanged();
+
     // Try to reconnect later
     QTimer::singleShot(3000, this, SLOT(prepare()));
 }
 
+void QPulseAudioEngine::onStreamContextFailed()
+{
+    // Every stream context reports the same server going away, only reconnect once
+    if (m_prepared)
+        onContextFailed();
+}
+
 QPulseAudioEngine *QPulseAudioEngine::instance()
 {
     return pulseEngine();
@@ -473,7 +660,19 @@ QList<QAudioDevice> QPulseAudioEngine::availableDevices(QAudioDevice::Mode mode)
 
 QByteArray QPulseAudioEngine::defaultDevice(QAudioDevice::Mode mode) const
 {
+    QReadLocker locker(&m_serverLock);
     return (mode == QAudioDevice::Output) ? m_defaultSink : m_defaultSource;
 }
 
+void QPulseAudioEngine::waitForDevices()
+{
+    if (!m_mainLoop || !m_context)
+        return;
+
+    lock();
+    while (!m_devicesListed && PA_CONTEXT_IS_GOOD(pa_context_get_state(m_context)))
+        pa_threaded_mainloop_wait(m_mainLoop);
+    unlock();
+}
+
 QT_END_NAMESPACE
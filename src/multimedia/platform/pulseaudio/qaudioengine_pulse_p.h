@@ -54,12 +54,53 @@
 #include <QtCore/qmap.h>
 #include <QtCore/qbytearray.h>
 #include <QtCore/qreadwritelock.h>
+#include <QtCore/qmutex.h>
 #include <pulse/pulseaudio.h>
 #include "qpulsehelpers_p.h"
 #include <qaudioformat.h>
 
+#include <memory>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
+class QPulseAudioEngine;
+
+// A server connection with its own mainloop thread and lock, used to run streams.
+// Streams are spread over a few of these, so that feeding one stream does not
+// contend with every other stream in the process on a single mainloop lock.
+class QPulseAudioContext
+{
+public:
+    ~QPulseAudioContext();
+
+    pa_threaded_mainloop *mainloop() const { return m_mainLoop; }
+    pa_context *context() const { return m_context; }
+
+    inline void lock() { pa_threaded_mainloop_lock(m_mainLoop); }
+    inline void unlock() { pa_threaded_mainloop_unlock(m_mainLoop); }
+
+    inline void wait(pa_operation *op)
+    {
+        while (pa_operation_get_state(op) == PA_OPERATION_RUNNING)
+            pa_threaded_mainloop_wait(m_mainLoop);
+    }
+
+    // Blocks until the context is connected, returns false if the connection failed
+    bool waitForReady();
+
+private:
+    friend class QPulseAudioEngine;
+    static std::shared_ptr<QPulseAudioContext> create(QPulseAudioEngine *engine, int index);
+    static void stateCallback(pa_context *context, void *userdata);
+
+    QPulseAudioContext() = default;
+
+    QPulseAudioEngine *m_engine = nullptr;
+    pa_threaded_mainloop *m_mainLoop = nullptr;
+    pa_context *m_context = nullptr;
+};
+
 class QPulseAudioEngine : public QObject
 {
     Q_OBJECT
@@ -90,18 +131,26 @@ public:
             pa_threaded_mainloop_wait(m_mainLoop);
     }
 
+    // Returns the least used stream context, or nullptr if the engine is not connected
+    std::shared_ptr<QPulseAudioContext> streamContext();
+
     QList<QAudioDevice> availableDevices(QAudioDevice::Mode mode) const;
     QByteArray defaultDevice(QAudioDevice::Mode mode) const;
+    // Blocks until the device lists of the current connection have arrived,
+    // or the connection failed
+    void waitForDevices();
 
 Q_SIGNALS:
     void contextFailed();
+    void audioInputsChanged();
+    void audioOutputsChanged();
 
 private Q_SLOTS:
     void prepare();
     void onContextFailed();
+    void onStreamContextFailed();
 
 private:
-    void updateDevices();
     void release();
 
 public:
@@ -115,11 +164,20 @@ public:
     mutable QReadWriteLock m_sourceLock;
     mutable QReadWriteLock m_serverLock;
 
+    // Only touched from the mainloop thread
+    bool m_sinksChanged = false;
+    bool m_sourcesChanged = false;
+    // Guarded by the mainloop lock
+    bool m_devicesListed = false;
+
 private:
     pa_mainloop_api *m_mainLoopApi;
     pa_threaded_mainloop *m_mainLoop;
     pa_context *m_context;
     bool m_prepared;
+
+    QMutex m_streamContextsLock;
+    std::vector<std::shared_ptr<QPulseAudioContext>> m_streamContexts;
  };
 
 QT_END_NAMESPACE
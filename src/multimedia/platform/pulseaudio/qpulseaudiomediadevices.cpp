@@ -52,6 +52,20 @@ QPulseAudioMediaDevices::QPulseAudioMediaDevices(QPulseAudioEngine *engine)
     : QPlatformMediaDevices(),
       pulseEngine(engine)
 {
+    // The engine enumerates devices asynchronously, so the initial lists may still be
+    // empty here. Forward its change notifications once the data has arrived.
+    m_inputsChangedConnection =
+            QObject::connect(pulseEngine, &QPulseAudioEngine::audioInputsChanged, pulseEngine,
+                             [this]() { audioInputsChanged(); }, Qt::QueuedConnection);
+    m_outputsChangedConnection =
+            QObject::connect(pulseEngine, &QPulseAudioEngine::audioOutputsChanged, pulseEngine,
+                             [this]() { audioOutputsChanged(); }, Qt::QueuedConnection);
+}
+
+QPulseAudioMediaDevices::~QPulseAudioMediaDevices()
+{
+    QObject::disconnect(m_inputsChangedConnection);
+    QObject::disconnect(m_outputsChangedConnection);
 }
 
 QList<QAudioDevice> QPulseAudioMediaDevices::audioInputs() const
@@ -64,6 +78,11 @@ QList<QAudioDevice> QPulseAudioMediaDevices::audioOutputs() const
     return pulseEngine->availableDevices(QAudioDevice::Output);
 }
 
+void QPulseAudioMediaDevices::waitForAudioDevices() const
+{
+    pulseEngine->waitForDevices();
+}
+
 QList<QCameraDevice> QPulseAudioMediaDevices::videoInputs() const
 {
     return {};
@@ -52,6 +52,7 @@
 //
 
 #include <private/qplatformmediadevices_p.h>
+#include <qobject.h>
 #include <qset.h>
 #include <qaudio.h>
 
@@ -63,15 +64,20 @@ class QPulseAudioMediaDevices : public QPlatformMediaDevices
 {
 public:
     QPulseAudioMediaDevices(QPulseAudioEngine *engine);
+    ~QPulseAudioMediaDevices();
 
     QList<QAudioDevice> audioInputs() const override;
     QList<QAudioDevice> audioOutputs() const override;
     QList<QCameraDevice> videoInputs() const override;
     QPlatformAudioSource *createAudioSource(const QAudioDevice &deviceInfo) override;
     QPlatformAudioSink *createAudioSink(const QAudioDevice &deviceInfo) override;
+    void waitForAudioDevices() const override;
 
 private:
     QPulseAudioEngine *pulseEngine;
+    // The engine outlives us, these forward its signals to us
+    QMetaObject::Connection m_inputsChangedConnection;
+    QMetaObject::Connection m_outputsChangedConnection;
 };
 
 QT_END_NAMESPACE
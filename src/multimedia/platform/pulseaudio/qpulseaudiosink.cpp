@@ -59,14 +59,12 @@ static void  outputStreamWriteCallback(pa_stream *stream, size_t length, void *u
 {
     Q_UNUSED(stream);
     Q_UNUSED(length);
-    Q_UNUSED(userdata);
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-    pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+    QPulseAudioSink *audioSink = static_cast<QPulseAudioSink *>(userdata);
+    pa_threaded_mainloop_signal(audioSink->pulseContext()->mainloop(), 0);
 }
 
 static void outputStreamStateCallback(pa_stream *stream, void *userdata)
 {
-    Q_UNUSED(userdata);
     pa_stream_state_t state = pa_stream_get_state(stream);
 #ifdef DEBUG_PULSE
     qDebug() << "Stream state: " << QPulseAudioInternal::stateToQString(state);
@@ -80,8 +78,8 @@ static void outputStreamStateCallback(pa_stream *stream, void *userdata)
         case PA_STREAM_FAILED:
         default:
             qWarning() << QString::fromLatin1("Stream error: %1").arg(QString::fromUtf8(pa_strerror(pa_context_errno(pa_stream_get_context(stream)))));
-            QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-            pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+            QPulseAudioSink *audioSink = static_cast<QPulseAudioSink *>(userdata);
+            pa_threaded_mainloop_signal(audioSink->pulseContext()->mainloop(), 0);
             break;
     }
 }
@@ -120,10 +118,9 @@ static void outputStreamSuccessCallback(pa_stream *stream, int success, void *us
 {
     Q_UNUSED(stream);
     Q_UNUSED(success);
-    Q_UNUSED(userdata);
 
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-    pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+    QPulseAudioSink *audioSink = static_cast<QPulseAudioSink *>(userdata);
+    pa_threaded_mainloop_signal(audioSink->pulseContext()->mainloop(), 0);
 }
 
 static void outputStreamDrainComplete(pa_stream *stream, int success, void *userdata)
@@ -270,7 +267,11 @@ bool QPulseAudioSink::open()
 
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
 
-    if (!pulseEngine->context() || pa_context_get_state(pulseEngine->context()) != PA_CONTEXT_READY) {
+    // Each stream runs on one of a few server connections, so that writing to it
+    // only contends with the other streams on the same connection
+    m_context = pulseEngine->streamContext();
+    if (!m_context || !m_context->waitForReady()) {
+        m_context.reset();
         setError(QAudio::FatalError);
         setState(QAudio::StoppedState);
         emit stateChanged(m_deviceState);
@@ -280,6 +281,7 @@ bool QPulseAudioSink::open()
     pa_sample_spec spec = QPulseAudioInternal::audioFormatToSampleSpec(m_format);
 
     if (!pa_sample_spec_valid(&spec)) {
+        m_context.reset();
         setError(QAudio::OpenError);
         setState(QAudio::StoppedState);
         emit stateChanged(m_deviceState);
@@ -299,8 +301,7 @@ bool QPulseAudioSink::open()
     qDebug() << "Frame size: " << pa_frame_size(&spec);
 #endif
 
-    pulseEngine->lock();
-
+    m_context->lock();
 
     pa_proplist *propList = pa_proplist_new();
 #if 0
@@ -341,10 +342,12 @@ bool QPulseAudioSink::open()
     if (!channelMap)
         qWarning() << "QAudioSink: pa_channel_map_init_extend() Could not initialize channel map";
 
-    m_stream = pa_stream_new_with_proplist(pulseEngine->context(), m_streamName.constData(), &m_spec, channelMap, propList);
+    m_stream = pa_stream_new_with_proplist(m_context->context(), m_streamName.constData(), &m_spec, channelMap, propList);
     if (!m_stream) {
         qWarning() << "QAudioSink: pa_stream_new_with_proplist() failed!";
-        pulseEngine->unlock();
+        pa_proplist_free(propList);
+        m_context->unlock();
+        m_context.reset();
         setError(QAudio::OpenError);
         setState(QAudio::StoppedState);
         emit stateChanged(m_deviceState);
@@ -367,11 +370,14 @@ bool QPulseAudioSink::open()
     requestedBuffer.prebuf = (uint32_t)-1;
     requestedBuffer.tlength = m_bufferSize;
 
-    if (pa_stream_connect_playback(m_stream, m_device.data(), (m_bufferSize > 0) ? &requestedBuffer : nullptr, (pa_stream_flags_t)0, nullptr, nullptr) < 0) {
+    // An empty device lets the server pick its default sink
+    const char *device = m_device.isEmpty() ? nullptr : m_device.constData();
+    if (pa_stream_connect_playback(m_stream, device, (m_bufferSize > 0) ? &requestedBuffer : nullptr, (pa_stream_flags_t)0, nullptr, nullptr) < 0) {
         qWarning() << "pa_stream_connect_playback() failed!";
         pa_stream_unref(m_stream);
         m_stream = nullptr;
-        pulseEngine->unlock();
+        m_context->unlock();
+        m_context.reset();
         setError(QAudio::OpenError);
         setState(QAudio::StoppedState);
         emit stateChanged(m_deviceState);
@@ -379,7 +385,7 @@ bool QPulseAudioSink::open()
     }
 
     while (pa_stream_get_state(m_stream) != PA_STREAM_READY)
-        pa_threaded_mainloop_wait(pulseEngine->mainloop());
+        pa_threaded_mainloop_wait(m_context->mainloop());
 
     const pa_buffer_attr *buffer = pa_stream_get_buffer_attr(m_stream);
     m_periodTime = PeriodTimeMs;
@@ -407,7 +413,7 @@ bool QPulseAudioSink::open()
     qDebug() << "\tFragment size: " << buffer->fragsize;
 #endif
 
-    pulseEngine->unlock();
+    m_context->unlock();
 
     connect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSink::onPulseContextFailed);
 
@@ -430,7 +436,7 @@ void QPulseAudioSink::close()
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
 
     if (m_stream) {
-        pulseEngine->lock();
+        m_context->lock();
 
         pa_stream_set_state_callback(m_stream, nullptr, nullptr);
         pa_stream_set_write_callback(m_stream, nullptr, nullptr);
@@ -446,8 +452,9 @@ void QPulseAudioSink::close()
         pa_stream_unref(m_stream);
         m_stream = nullptr;
 
-        pulseEngine->unlock();
+        m_context->unlock();
     }
+    m_context.reset();
 
     disconnect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSink::onPulseContextFailed);
 
@@ -504,9 +511,7 @@ void QPulseAudioSink::userFeed()
 
 qint64 QPulseAudioSink::write(const char *data, qint64 len)
 {
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-
-    pulseEngine->lock();
+    m_context->lock();
 
     len = qMin(len, static_cast<qint64>(pa_stream_writable_size(m_stream)));
 
@@ -517,7 +522,8 @@ qint64 QPulseAudioSink::write(const char *data, qint64 len)
         size_t nbytes = len;
         if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
             qWarning("QAudioSink(pulseaudio): pa_stream_begin_write, error = %s",
-                     pa_strerror(pa_context_errno(pulseEngine->context())));
+                     pa_strerror(pa_context_errno(m_context->context())));
+            m_context->unlock();
             setError(QAudio::IOError);
             return 0;
         }
@@ -529,12 +535,13 @@ qint64 QPulseAudioSink::write(const char *data, qint64 len)
 
     if (pa_stream_write(m_stream, data, len, nullptr, 0, PA_SEEK_RELATIVE) < 0) {
         qWarning("QAudioSink(pulseaudio): pa_stream_write, error = %s",
-                 pa_strerror(pa_context_errno(pulseEngine->context())));
+                 pa_strerror(pa_context_errno(m_context->context())));
+        m_context->unlock();
         setError(QAudio::IOError);
         return 0;
     }
 
-    pulseEngine->unlock();
+    m_context->unlock();
     m_totalTimeValue += len;
 
     setError(QAudio::NoError);
@@ -559,10 +566,9 @@ qsizetype QPulseAudioSink::bytesFree() const
     if (m_deviceState != QAudio::ActiveState && m_deviceState != QAudio::IdleState)
         return 0;
 
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-    pulseEngine->lock();
+    m_context->lock();
     int writableSize = pa_stream_writable_size(m_stream);
-    pulseEngine->unlock();
+    m_context->unlock();
     return writableSize;
 }
 
@@ -588,19 +594,17 @@ void QPulseAudioSink::resume()
     if (m_deviceState == QAudio::SuspendedState) {
         m_resuming = true;
 
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-
-        pulseEngine->lock();
+        m_context->lock();
 
-        pa_operation *operation = pa_stream_cork(m_stream, 0, outputStreamSuccessCallback, nullptr);
-        pulseEngine->wait(operation);
+        pa_operation *operation = pa_stream_cork(m_stream, 0, outputStreamSuccessCallback, this);
+        m_context->wait(operation);
         pa_operation_unref(operation);
 
-        operation = pa_stream_trigger(m_stream, outputStreamSuccessCallback, nullptr);
-        pulseEngine->wait(operation);
+        operation = pa_stream_trigger(m_stream, outputStreamSuccessCallback, this);
+        m_context->wait(operation);
         pa_operation_unref(operation);
 
-        pulseEngine->unlock();
+        m_context->unlock();
 
         m_tickTimer->start(m_periodTime);
 
@@ -627,16 +631,15 @@ void QPulseAudioSink::suspend()
 
         m_tickTimer->stop();
 
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
         pa_operation *operation;
 
-        pulseEngine->lock();
+        m_context->lock();
 
-        operation = pa_stream_cork(m_stream, 1, outputStreamSuccessCallback, nullptr);
-        pulseEngine->wait(operation);
+        operation = pa_stream_cork(m_stream, 1, outputStreamSuccessCallback, this);
+        m_context->wait(operation);
         pa_operation_unref(operation);
 
-        pulseEngine->unlock();
+        m_context->unlock();
     }
 }
 
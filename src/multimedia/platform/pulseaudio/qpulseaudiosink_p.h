@@ -64,8 +64,12 @@
 
 #include <pulse/pulseaudio.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
+class QPulseAudioContext;
+
 class QPulseAudioSink : public QPlatformAudioSink
 {
     friend class PulseOutputPrivate;
@@ -95,6 +99,7 @@ public:
 
 public:
     void streamUnderflowCallback();
+    QPulseAudioContext *pulseContext() const { return m_context.get(); }
 
 private:
     void setState(QAudio::State state);
@@ -119,6 +124,7 @@ private:
     QIODevice *m_audioSource;
     QTimer m_periodTimer;
     int m_periodTime;
+    std::shared_ptr<QPulseAudioContext> m_context;
     pa_stream *m_stream;
     int m_periodSize;
     int m_bufferSize;
@@ -55,16 +55,17 @@ const int PeriodTimeMs = 50;
 
 static void inputStreamReadCallback(pa_stream *stream, size_t length, void *userdata)
 {
-    Q_UNUSED(userdata);
     Q_UNUSED(length);
     Q_UNUSED(stream);
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-    pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+    // In callback mode the data is handed over right here on the mainloop thread
+    QPulseAudioSource *audioInput = static_cast<QPulseAudioSource *>(userdata);
+    if (audioInput->readToDispatcher())
+        return;
+    pa_threaded_mainloop_signal(audioInput->pulseContext()->mainloop(), 0);
 }
 
 static void inputStreamStateCallback(pa_stream *stream, void *userdata)
 {
-    Q_UNUSED(userdata);
     pa_stream_state_t state = pa_stream_get_state(stream);
 #ifdef DEBUG_PULSE
     qDebug() << "Stream state: " << QPulseAudioInternal::stateToQString(state);
@@ -92,8 +93,8 @@ static void inputStreamStateCallback(pa_stream *stream, void *userdata)
         case PA_STREAM_FAILED:
         default:
             qWarning() << QString::fromLatin1("Stream error: %1").arg(QString::fromUtf8(pa_strerror(pa_context_errno(pa_stream_get_context(stream)))));
-            QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-            pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+            QPulseAudioSource *audioInput = static_cast<QPulseAudioSource *>(userdata);
+            pa_threaded_mainloop_signal(audioInput->pulseContext()->mainloop(), 0);
             break;
     }
 }
@@ -115,14 +116,13 @@ static void inputStreamOverflowCallback(pa_stream *stream, void *userdata)
 static void inputStreamSuccessCallback(pa_stream *stream, int success, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(userdata);
     Q_UNUSED(success);
 
     //if (!success)
     //TODO: Is cork success?  i->operation_success = success;
 
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-    pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+    QPulseAudioSource *audioInput = static_cast<QPulseAudioSource *>(userdata);
+    pa_threaded_mainloop_signal(audioInput->pulseContext()->mainloop(), 0);
 }
 
 QPulseAudioSource::QPulseAudioSource(const QByteArray &device)
@@ -236,6 +236,31 @@ QIODevice *QPulseAudioSource::start()
     return m_audioSource;
 }
 
+void QPulseAudioSource::start(QAudioCaptureDispatcher *dispatcher)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    if (!m_pullMode && m_audioSource) {
+        delete m_audioSource;
+        m_audioSource = nullptr;
+    }
+
+    close();
+
+    m_dispatcher = dispatcher;
+    if (!open()) {
+        m_dispatcher = nullptr;
+        return;
+    }
+
+    // No polling needed, the stream's read callback feeds the dispatcher
+    m_timer->stop();
+    m_pullMode = true;
+
+    setState(QAudio::ActiveState);
+}
+
 void QPulseAudioSource::stop()
 {
     if (m_deviceState == QAudio::StoppedState)
@@ -254,7 +279,11 @@ bool QPulseAudioSource::open()
 
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
 
-    if (!pulseEngine->context() || pa_context_get_state(pulseEngine->context()) != PA_CONTEXT_READY) {
+    // Each stream runs on one of a few server connections, so that reading from it
+    // only contends with the other streams on the same connection
+    m_context = pulseEngine->streamContext();
+    if (!m_context || !m_context->waitForReady()) {
+        m_context.reset();
         setError(QAudio::FatalError);
         setState(QAudio::StoppedState);
         return false;
@@ -263,6 +292,7 @@ bool QPulseAudioSource::open()
     pa_sample_spec spec = QPulseAudioInternal::audioFormatToSampleSpec(m_format);
 
     if (!pa_sample_spec_valid(&spec)) {
+        m_context.reset();
         setError(QAudio::OpenError);
         setState(QAudio::StoppedState);
         return false;
@@ -285,7 +315,7 @@ bool QPulseAudioSource::open()
         qDebug() << "Frame size: " << pa_frame_size(&spec);
 #endif
 
-    pulseEngine->lock();
+    m_context->lock();
     pa_channel_map channel_map;
 
     pa_channel_map_init_extend(&channel_map, spec.channels, PA_CHANNEL_MAP_DEFAULT);
@@ -293,7 +323,7 @@ bool QPulseAudioSource::open()
     if (!pa_channel_map_compatible(&channel_map, &spec))
         qWarning() << "Channel map doesn't match sample specification!";
 
-    m_stream = pa_stream_new(pulseEngine->context(), m_streamName.constData(), &spec, &channel_map);
+    m_stream = pa_stream_new(m_context->context(), m_streamName.constData(), &spec, &channel_map);
 
     pa_stream_set_state_callback(m_stream, inputStreamStateCallback, this);
     pa_stream_set_read_callback(m_stream, inputStreamReadCallback, this);
@@ -316,18 +346,21 @@ bool QPulseAudioSource::open()
     else
         buffer_attr.fragsize = (uint32_t) m_periodSize;
 
-    if (pa_stream_connect_record(m_stream, m_device.data(), &buffer_attr, (pa_stream_flags_t)flags) < 0) {
+    // An empty device lets the server pick its default source
+    const char *device = m_device.isEmpty() ? nullptr : m_device.constData();
+    if (pa_stream_connect_record(m_stream, device, &buffer_attr, (pa_stream_flags_t)flags) < 0) {
         qWarning() << "pa_stream_connect_record() failed!";
         pa_stream_unref(m_stream);
         m_stream = nullptr;
-        pulseEngine->unlock();
+        m_context->unlock();
+        m_context.reset();
         setError(QAudio::OpenError);
         setState(QAudio::StoppedState);
         return false;
     }
 
     while (pa_stream_get_state(m_stream) != PA_STREAM_READY)
-        pa_threaded_mainloop_wait(pulseEngine->mainloop());
+        pa_threaded_mainloop_wait(m_context->mainloop());
 
     const pa_buffer_attr *actualBufferAttr = pa_stream_get_buffer_attr(m_stream);
     m_periodSize = actualBufferAttr->fragsize;
@@ -335,7 +368,7 @@ bool QPulseAudioSource::open()
     if (actualBufferAttr->tlength != (uint32_t)-1)
         m_bufferSize = actualBufferAttr->tlength;
 
-    pulseEngine->unlock();
+    m_context->unlock();
 
     connect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSource::onPulseContextFailed);
 
@@ -358,7 +391,7 @@ void QPulseAudioSource::close()
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
 
     if (m_stream) {
-        pulseEngine->lock();
+        m_context->lock();
 
         pa_stream_set_state_callback(m_stream, nullptr, nullptr);
         pa_stream_set_read_callback(m_stream, nullptr, nullptr);
@@ -369,8 +402,9 @@ void QPulseAudioSource::close()
         pa_stream_unref(m_stream);
         m_stream = nullptr;
 
-        pulseEngine->unlock();
+        m_context->unlock();
     }
+    m_context.reset();
 
     disconnect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSource::onPulseContextFailed);
 
@@ -378,6 +412,7 @@ void QPulseAudioSource::close()
         delete m_audioSource;
         m_audioSource = nullptr;
     }
+    m_dispatcher = nullptr;
     m_opened = false;
 }
 
@@ -419,6 +454,9 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
         m_tempBuffer.clear();
     }
 
+    // Drain everything that is available in one go instead of taking the lock per fragment
+    m_context->lock();
+
     while (pa_stream_readable_size(m_stream) > 0) {
         size_t readLength = 0;
 
@@ -426,9 +464,6 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
         qDebug() << "QPulseAudioSource::read -- " << pa_stream_readable_size(m_stream) << " bytes available from pulse audio";
 #endif
 
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-        pulseEngine->lock();
-
         const void *audioBuffer;
 
         // Second and third parameters (audioBuffer and length) to pa_stream_peek are output parameters,
@@ -437,7 +472,7 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
         if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0) {
             qWarning() << QString::fromLatin1("pa_stream_peek() failed: %1")
                           .arg(QString::fromUtf8(pa_strerror(pa_context_errno(pa_stream_get_context(m_stream)))));
-            pulseEngine->unlock();
+            m_context->unlock();
             return 0;
         }
 
@@ -448,7 +483,7 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
             actualLength = m_audioSource->write(adjusted);
 
             if (actualLength < qint64(readLength)) {
-                pulseEngine->unlock();
+                m_context->unlock();
 
                 setError(QAudio::UnderrunError);
                 setState(QAudio::IdleState);
@@ -479,12 +514,13 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
         readBytes += actualLength;
 
         pa_stream_drop(m_stream);
-        pulseEngine->unlock();
 
         if (!m_pullMode && readBytes >= len)
             break;
     }
 
+    m_context->unlock();
+
 #ifdef DEBUG_PULSE
     qDebug() << "QPulseAudioSource::read -- returning after reading " << readBytes << " bytes";
 #endif
@@ -492,6 +528,35 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
     return readBytes;
 }
 
+// Called on the mainloop thread, which already holds the mainloop lock
+bool QPulseAudioSource::readToDispatcher()
+{
+    if (!m_dispatcher)
+        return false;
+
+    while (pa_stream_readable_size(m_stream) > 0) {
+        const void *audioBuffer = nullptr;
+        size_t readLength = 0;
+        if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0)
+            break;
+
+        // audioBuffer is null for holes in the stream
+        if (audioBuffer && readLength > 0) {
+            if (m_volume < 1.f) {
+                if (size_t(m_dispatchBuffer.size()) < readLength)
+                    m_dispatchBuffer.resize(readLength);
+                applyVolume(audioBuffer, m_dispatchBuffer.data(), readLength);
+                m_dispatcher->push(m_dispatchBuffer.constData(), readLength);
+            } else {
+                m_dispatcher->push(static_cast<const char *>(audioBuffer), readLength);
+            }
+        }
+
+        pa_stream_drop(m_stream);
+    }
+    return true;
+}
+
 void QPulseAudioSource::applyVolume(const void *src, void *dest, int len)
 {
     if (m_volume < 1.f)
@@ -503,18 +568,18 @@ void QPulseAudioSource::applyVolume(const void *src, void *dest, int len)
 void QPulseAudioSource::resume()
 {
     if (m_deviceState == QAudio::SuspendedState || m_deviceState == QAudio::IdleState) {
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
         pa_operation *operation;
 
-        pulseEngine->lock();
+        m_context->lock();
 
-        operation = pa_stream_cork(m_stream, 0, inputStreamSuccessCallback, nullptr);
-        pulseEngine->wait(operation);
+        operation = pa_stream_cork(m_stream, 0, inputStreamSuccessCallback, this);
+        m_context->wait(operation);
         pa_operation_unref(operation);
 
-        pulseEngine->unlock();
+        m_context->unlock();
 
-        m_timer->start(m_periodTime);
+        if (!m_dispatcher)
+            m_timer->start(m_periodTime);
 
         setState(QAudio::ActiveState);
         setError(QAudio::NoError);
@@ -547,7 +612,7 @@ qsizetype QPulseAudioSource::bufferSize() const
 qint64 QPulseAudioSource::processedUSecs() const
 {
     pa_sample_spec spec = QPulseAudioInternal::audioFormatToSampleSpec(m_format);
-    qint64 result = pa_bytes_to_usec(m_totalTimeValue, &spec);
+    qint64 result = pa_bytes_to_usec(m_dispatcher ? m_dispatcher->processedBytes() : m_totalTimeValue, &spec);
 
     return result;
 }
@@ -560,16 +625,15 @@ void QPulseAudioSource::suspend()
 
         m_timer->stop();
 
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
         pa_operation *operation;
 
-        pulseEngine->lock();
+        m_context->lock();
 
-        operation = pa_stream_cork(m_stream, 1, inputStreamSuccessCallback, nullptr);
-        pulseEngine->wait(operation);
+        operation = pa_stream_cork(m_stream, 1, inputStreamSuccessCallback, this);
+        m_context->wait(operation);
         pa_operation_unref(operation);
 
-        pulseEngine->unlock();
+        m_context->unlock();
     }
 }
 
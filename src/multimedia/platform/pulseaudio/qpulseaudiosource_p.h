@@ -64,8 +64,12 @@
 
 #include <pulse/pulseaudio.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
+class QPulseAudioContext;
+
 class PulseInputPrivate;
 
 class QPulseAudioSource : public QPlatformAudioSource
@@ -77,9 +81,12 @@ public:
     ~QPulseAudioSource();
 
     qint64 read(char *data, qint64 len);
+    bool readToDispatcher();
+    QPulseAudioContext *pulseContext() const { return m_context.get(); }
 
     void start(QIODevice *device) override;
     QIODevice *start() override;
+    void start(QAudioCaptureDispatcher *dispatcher) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -98,6 +105,7 @@ public:
 
     qint64 m_totalTimeValue;
     QIODevice *m_audioSource;
+    QAudioCaptureDispatcher *m_dispatcher = nullptr;
     QAudioFormat m_format;
     QAudio::Error m_errorState;
     QAudio::State m_deviceState;
@@ -126,10 +134,12 @@ private:
     unsigned int m_periodTime;
     QTimer *m_timer;
     qint64 m_elapsedTimeOffset;
+    std::shared_ptr<QPulseAudioContext> m_context;
     pa_stream *m_stream;
     QByteArray m_streamName;
     QByteArray m_device;
     QByteArray m_tempBuffer;
+    QByteArray m_dispatchBuffer;
     pa_sample_spec m_spec;
 };
 
@@ -65,17 +65,22 @@ QPlatformCamera::QPlatformCamera(QCamera *parent)
 {
 }
 
-QCameraFormat QPlatformCamera::findBestCameraFormat(const QCameraDevice &camera)
+QCameraFormat QPlatformCamera::findBestCameraFormat(const QCameraDevice &camera,
+                                                    const std::function<bool(const QCameraFormat &)> &isPreferred)
 {
     QCameraFormat f;
     const auto formats = camera.videoFormats();
     for (const auto &fmt : formats) {
+        const int area = fmt.resolution().width()*fmt.resolution().height();
+        const int bestArea = f.resolution().width()*f.resolution().height();
         // check if fmt is better. We try to find the highest resolution that offers
         // at least 30 FPS
         if (f.maxFrameRate() < 30 && fmt.maxFrameRate() > f.maxFrameRate())
             f = fmt;
-        else if (f.maxFrameRate() == fmt.maxFrameRate() &&
-                 f.resolution().width()*f.resolution().height() < fmt.resolution().width()*fmt.resolution().height())
+        else if (f.maxFrameRate() == fmt.maxFrameRate() && bestArea < area)
+            f = fmt;
+        else if (isPreferred && f.maxFrameRate() == fmt.maxFrameRate() && bestArea == area
+                 && !isPreferred(f) && isPreferred(fmt))
             f = fmt;
     }
     return f;
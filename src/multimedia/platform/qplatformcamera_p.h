@@ -56,6 +56,8 @@
 
 #include <QtMultimedia/qcamera.h>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 class Q_MULTIMEDIA_EXPORT QPlatformCamera : public QObject
@@ -156,7 +158,9 @@ Q_SIGNALS:
 protected:
     explicit QPlatformCamera(QCamera *parent);
 
-    static QCameraFormat findBestCameraFormat(const QCameraDevice &camera);
+    // Formats for which isPreferred returns true win over otherwise equally good ones
+    static QCameraFormat findBestCameraFormat(const QCameraDevice &camera,
+                                              const std::function<bool(const QCameraFormat &)> &isPreferred = {});
 private:
     QCamera *m_camera = nullptr;
     QCamera::Features m_supportedFeatures = {};
@@ -112,6 +112,67 @@ QPlatformImageCapture::QPlatformImageCapture(QImageCapture *parent)
     with imageExposed(), imageCaptured() and imageSaved() signals.
 */
 
+static int burstNotSupported(QPlatformImageCapture *capture)
+{
+    QMetaObject::invokeMethod(capture, "error", Qt::QueuedConnection,
+                              Q_ARG(int, -1),
+                              Q_ARG(int, QImageCapture::NotSupportedFeatureError),
+                              Q_ARG(QString, QImageCapture::tr("Burst capture is not supported")));
+    return -1;
+}
+
+/*!
+    Initiates the capture of \a count images from consecutive frames, or from
+    every \a frameInterval'th frame, and saves them to files named after
+    \a fileName.
+
+    Returns the request id of the first image, the following images use the
+    ids after it.
+
+    The default implementation reports that bursts are not supported.
+*/
+int QPlatformImageCapture::captureBurst(int count, int frameInterval, const QString &fileName)
+{
+    Q_UNUSED(count);
+    Q_UNUSED(frameInterval);
+    Q_UNUSED(fileName);
+    return burstNotSupported(this);
+}
+
+/*!
+    Initiates the capture of \a count images from consecutive frames, or from
+    every \a frameInterval'th frame, without saving them to files.
+
+    The default implementation reports that bursts are not supported.
+*/
+int QPlatformImageCapture::captureBurstToBuffer(int count, int frameInterval)
+{
+    Q_UNUSED(count);
+    Q_UNUSED(frameInterval);
+    return burstNotSupported(this);
+}
+
+/*!
+    \fn int QPlatformImageCapture::maximumPendingImages() const
+
+    Returns how many captured images can be processed at the same time.
+*/
+
+/*!
+    \fn void QPlatformImageCapture::setMaximumPendingImages(int count)
+
+    Allows up to \a count captured images to be processed at the same time.
+*/
+
+/*!
+    \fn bool QPlatformImageCapture::isPreviewRequested() const
+
+    Returns true if anyone listens to QImageCapture::imageCaptured(). Backends
+    can skip generating preview images otherwise.
+
+    This function is thread-safe.
+*/
+
 /*!
     \fn QPlatformImageCapture::imageExposed(int requestId)
 
@@ -148,6 +209,13 @@ QPlatformImageCapture::QPlatformImageCapture(QImageCapture *parent)
     to \a fileName.
 */
 
+/*!
+    \fn QPlatformImageCapture::imageProcessed(int requestId, qint64 latency)
+
+    Signals that the image with \a requestId has been encoded, \a latency
+    microseconds after it was exposed.
+*/
+
 /*!
     \fn QPlatformImageCapture::imageSettings() const
 
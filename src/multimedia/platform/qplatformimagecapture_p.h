@@ -54,6 +54,7 @@
 #include <QtMultimedia/qimagecapture.h>
 #include <QtMultimedia/qmediametadata.h>
 #include <QtMultimedia/qimagecapture.h>
+#include <QtCore/qatomic.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -95,6 +96,11 @@ public:
 
     virtual int capture(const QString &fileName) = 0;
     virtual int captureToBuffer() = 0;
+    virtual int captureBurst(int count, int frameInterval, const QString &fileName);
+    virtual int captureBurstToBuffer(int count, int frameInterval);
+
+    virtual int maximumPendingImages() const { return 1; }
+    virtual void setMaximumPendingImages(int) {}
 
     virtual QImageEncoderSettings imageSettings() const = 0;
     virtual void setImageSettings(const QImageEncoderSettings &settings) = 0;
@@ -104,6 +110,9 @@ public:
 
     QImageCapture *imageCapture() { return m_imageCapture; }
 
+    bool isPreviewRequested() const { return m_previewRequested.loadRelaxed(); }
+    void setPreviewRequested(bool requested) { m_previewRequested.storeRelaxed(requested); }
+
     static QString msgCameraNotReady();
     static QString msgImageCaptureNotSet();
 
@@ -115,6 +124,7 @@ Q_SIGNALS:
     void imageMetadataAvailable(int id, const QMediaMetaData &);
     void imageAvailable(int requestId, const QVideoFrame &buffer);
     void imageSaved(int requestId, const QString &fileName);
+    void imageProcessed(int requestId, qint64 latency);
 
     void error(int id, int error, const QString &errorString);
 
@@ -123,6 +133,7 @@ protected:
 private:
     QImageCapture *m_imageCapture = nullptr;
     QMediaMetaData m_metaData;
+    QAtomicInteger<bool> m_previewRequested{false};
 };
 
 QT_END_NAMESPACE
@@ -82,6 +82,10 @@ public:
     QPlatformAudioSource *audioInputDevice(const QAudioFormat &format, const QAudioDevice &deviceInfo);
     QPlatformAudioSink *audioOutputDevice(const QAudioFormat &format, const QAudioDevice &deviceInfo);
 
+    // Blocks until the audio devices have been enumerated once, for backends
+    // that enumerate them asynchronously
+    virtual void waitForAudioDevices() const {}
+
     void addDevices(QMediaDevices *m)
     {
         m_devices.append(m);
@@ -46,12 +46,17 @@ QPlatformMediaFormatInfo::QPlatformMediaFormatInfo() = default;
 
 QPlatformMediaFormatInfo::~QPlatformMediaFormatInfo() = default;
 
+const QList<QPlatformMediaFormatInfo::CodecMap> &QPlatformMediaFormatInfo::codecMap(QMediaFormat::ConversionMode m) const
+{
+    ensureCodecMap(m);
+    return (m == QMediaFormat::Encode) ? encoders : decoders;
+}
+
 QList<QMediaFormat::FileFormat> QPlatformMediaFormatInfo::supportedFileFormats(const QMediaFormat &constraints, QMediaFormat::ConversionMode m) const
 {
     QSet<QMediaFormat::FileFormat> formats;
 
-    const auto &codecMap = (m == QMediaFormat::Encode) ? encoders : decoders;
-    for (const auto &m : codecMap) {
+    for (const auto &m : codecMap(m)) {
         if (constraints.audioCodec() != QMediaFormat::AudioCodec::Unspecified && !m.audio.contains(constraints.audioCodec()))
             continue;
         if (constraints.videoCodec() != QMediaFormat::VideoCodec::Unspecified && !m.video.contains(constraints.videoCodec()))
@@ -65,8 +70,7 @@ QList<QMediaFormat::AudioCodec> QPlatformMediaFormatInfo::supportedAudioCodecs(c
 {
     QSet<QMediaFormat::AudioCodec> codecs;
 
-    const auto &codecMap = (m == QMediaFormat::Encode) ? encoders : decoders;
-    for (const auto &m : codecMap) {
+    for (const auto &m : codecMap(m)) {
         if (constraints.fileFormat() != QMediaFormat::UnspecifiedFormat && m.format != constraints.fileFormat())
             continue;
         if (constraints.videoCodec() != QMediaFormat::VideoCodec::Unspecified && !m.video.contains(constraints.videoCodec()))
@@ -81,8 +85,7 @@ QList<QMediaFormat::VideoCodec> QPlatformMediaFormatInfo::supportedVideoCodecs(c
 {
     QSet<QMediaFormat::VideoCodec> codecs;
 
-    const auto &codecMap = (m == QMediaFormat::Encode) ? encoders : decoders;
-    for (const auto &m : codecMap) {
+    for (const auto &m : codecMap(m)) {
         if (constraints.fileFormat() != QMediaFormat::UnspecifiedFormat && m.format != constraints.fileFormat())
             continue;
         if (constraints.audioCodec() != QMediaFormat::AudioCodec::Unspecified && !m.audio.contains(constraints.audioCodec()))
@@ -95,9 +98,7 @@ QList<QMediaFormat::VideoCodec> QPlatformMediaFormatInfo::supportedVideoCodecs(c
 
 bool QPlatformMediaFormatInfo::isSupported(const QMediaFormat &format, QMediaFormat::ConversionMode m) const
 {
-    const auto &codecMap = (m == QMediaFormat::Encode) ? encoders : decoders;
-
-    for (const auto &m : codecMap) {
+    for (const auto &m : codecMap(m)) {
         if (m.format != format.fileFormat())
             continue;
         if (!m.audio.contains(format.audioCodec()))
@@ -109,4 +110,10 @@ bool QPlatformMediaFormatInfo::isSupported(const QMediaFormat &format, QMediaFor
     return false;
 }
 
+QList<QImageCapture::FileFormat> QPlatformMediaFormatInfo::supportedImageFormats() const
+{
+    ensureImageFormats();
+    return imageFormats;
+}
+
 QT_END_NAMESPACE
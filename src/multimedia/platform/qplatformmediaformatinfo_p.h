@@ -69,15 +69,26 @@ public:
 
     bool isSupported(const QMediaFormat &format, QMediaFormat::ConversionMode m) const;
 
+    QList<QImageCapture::FileFormat> supportedImageFormats() const;
+
     struct CodecMap {
         QMediaFormat::FileFormat format;
         QList<QMediaFormat::AudioCodec> audio;
         QList<QMediaFormat::VideoCodec> video;
     };
-    QList<CodecMap> encoders;
-    QList<CodecMap> decoders;
+    mutable QList<CodecMap> encoders;
+    mutable QList<CodecMap> decoders;
+
+    mutable QList<QImageCapture::FileFormat> imageFormats;
+
+protected:
+    // Backends that discover their formats at runtime can override these to fill
+    // encoders/decoders resp. imageFormats on first use instead of in the constructor.
+    virtual void ensureCodecMap(QMediaFormat::ConversionMode) const {}
+    virtual void ensureImageFormats() const {}
 
-    QList<QImageCapture::FileFormat> imageFormats;
+private:
+    const QList<CodecMap> &codecMap(QMediaFormat::ConversionMode m) const;
 };
 
 QT_END_NAMESPACE
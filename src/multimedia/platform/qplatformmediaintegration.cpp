@@ -43,6 +43,7 @@
 #include <qmutex.h>
 #include <qplatformaudioinput_p.h>
 #include <qplatformaudiooutput_p.h>
+#include <private/qnullmediaintegration_p.h>
 
 #if QT_CONFIG(gstreamer)
 #include <private/qgstreamerintegration_p.h>
@@ -98,8 +99,12 @@ QPlatformMediaIntegration *QPlatformMediaIntegration::instance()
 {
     if (!holder.nativeInstance.loadRelaxed()) {
         QMutexLocker locker(&holder.mutex);
-        if (!holder.nativeInstance.loadAcquire())
-            holder.nativeInstance.storeRelease(new PlatformIntegration);
+        if (!holder.nativeInstance.loadAcquire()) {
+            if (qEnvironmentVariable("QT_MEDIA_BACKEND") == QLatin1String("null"))
+                holder.nativeInstance.storeRelease(new QNullMediaIntegration);
+            else
+                holder.nativeInstance.storeRelease(new PlatformIntegration);
+        }
     }
     if (!holder.instance)
         holder.instance = holder.nativeInstance.loadRelaxed();
@@ -57,6 +57,7 @@ QT_BEGIN_NAMESPACE
 
 class QMediaPlayer;
 class QAudioDecoder;
+class QMediaMetaDataScanner;
 class QCamera;
 class QMediaRecorder;
 class QImageCapture;
@@ -65,6 +66,7 @@ class QPlatformMediaDevices;
 class QPlatformMediaCaptureSession;
 class QPlatformMediaPlayer;
 class QPlatformAudioDecoder;
+class QPlatformMetaDataScanner;
 class QPlatformCamera;
 class QPlatformMediaRecorder;
 class QPlatformImageCapture;
@@ -90,6 +92,7 @@ public:
     virtual QPlatformMediaFormatInfo *formatInfo() = 0;
 
     virtual QPlatformAudioDecoder *createAudioDecoder(QAudioDecoder *) { return nullptr; }
+    virtual QPlatformMetaDataScanner *createMetaDataScanner(QMediaMetaDataScanner *) { return nullptr; }
     virtual QPlatformMediaCaptureSession *createCaptureSession() { return nullptr; }
     virtual QPlatformMediaPlayer *createPlayer(QMediaPlayer *) { return nullptr; }
     virtual QPlatformCamera *createCamera(QCamera *) { return nullptr; }
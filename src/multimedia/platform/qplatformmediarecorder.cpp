@@ -90,6 +90,27 @@ QPlatformMediaRecorder::QPlatformMediaRecorder(QMediaRecorder *parent)
     with actualLocationChanged() signal.
 */
 
+/*!
+    \fn QIODevice *QPlatformMediaRecorder::outputDevice() const
+
+    Returns the device recorded media is written to instead of the output
+    location, or \nullptr.
+*/
+
+/*!
+    \fn bool QPlatformMediaRecorder::setOutputDevice(QIODevice *device)
+
+    Makes the recorder write the muxed stream to \a device instead of a file,
+    as it is produced. Returns \c false if the backend doesn't support this.
+*/
+
+/*!
+    \fn bool QPlatformMediaRecorder::supportsOutputDevice() const
+
+    Returns \c true if the backend can record to an output device. The default
+    implementation returns \c false.
+*/
+
 /*!
     \fn QMediaRecorder::RecorderState QPlatformMediaRecorder::state() const
 
@@ -132,6 +153,18 @@ void QPlatformMediaRecorder::resume() {
     Stop media recording
 */
 
+/*!
+    \fn void QPlatformMediaRecorder::setPreRecording(const QMediaEncoderSettings &settings)
+
+    Starts encoding in the background with \a settings while the recorder is
+    stopped, keeping the last \l {QMediaEncoderSettings::}{preRecordDuration()}
+    milliseconds of encoded data. The next call to record() writes that history
+    to the file ahead of the live stream. A pre-record duration of 0 stops
+    background encoding.
+
+    The default implementation does nothing.
+*/
+
 /*!
     \fn void QPlatformMediaRecorder::stateChanged(QMediaRecorder::RecorderState state)
 
@@ -174,6 +207,17 @@ void QPlatformMediaRecorder::actualLocationChanged(const QUrl &location)
     emit q->actualLocationChanged(location);
 }
 
+/*!
+    \fn void QPlatformMediaRecorder::segmentFinished(const QUrl &location)
+
+    Signals that the segment written to \a location is complete and closed.
+    Only emitted when recording with a maximum segment duration or size.
+*/
+void QPlatformMediaRecorder::segmentFinished(const QUrl &location)
+{
+    emit q->segmentFinished(location);
+}
+
 /*!
     \fn void QPlatformMediaRecorder::error(QMediaRecorder::Error error, const QString &errorString)
 
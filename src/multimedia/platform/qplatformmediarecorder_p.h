@@ -54,6 +54,8 @@
 #include <QtCore/qurl.h>
 #include <QtCore/qsize.h>
 #include <QtCore/qmimetype.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qiodevice.h>
 
 #include <QtMultimedia/qmediarecorder.h>
 #include <QtMultimedia/qmediametadata.h>
@@ -79,6 +81,10 @@ class Q_MULTIMEDIA_EXPORT QMediaEncoderSettings
     QSize m_videoResolution = QSize(-1, -1);
     int m_videoFrameRate = -1;
     int m_videoBitRate = -1;
+
+    qint64 m_maximumSegmentDuration = 0;
+    qint64 m_maximumSegmentSize = 0;
+    qint64 m_preRecordDuration = 0;
 public:
 
     QMediaFormat mediaFormat() const { return m_format; }
@@ -115,6 +121,17 @@ public:
     int audioSampleRate() const { return m_audioSampleRate; }
     void setAudioSampleRate(int rate) { m_audioSampleRate = rate; }
 
+    qint64 maximumSegmentDuration() const { return m_maximumSegmentDuration; }
+    void setMaximumSegmentDuration(qint64 msecs) { m_maximumSegmentDuration = msecs; }
+
+    qint64 maximumSegmentSize() const { return m_maximumSegmentSize; }
+    void setMaximumSegmentSize(qint64 bytes) { m_maximumSegmentSize = bytes; }
+
+    bool isSegmented() const { return m_maximumSegmentDuration > 0 || m_maximumSegmentSize > 0; }
+
+    qint64 preRecordDuration() const { return m_preRecordDuration; }
+    void setPreRecordDuration(qint64 msecs) { m_preRecordDuration = msecs; }
+
     bool operator==(const QMediaEncoderSettings &other) const
     {
         return m_format == other.m_format &&
@@ -125,7 +142,10 @@ public:
                m_audioChannels == other.m_audioChannels &&
                m_videoResolution == other.m_videoResolution &&
                m_videoFrameRate == other.m_videoFrameRate &&
-               m_videoBitRate == other.m_videoBitRate;
+               m_videoBitRate == other.m_videoBitRate &&
+               m_maximumSegmentDuration == other.m_maximumSegmentDuration &&
+               m_maximumSegmentSize == other.m_maximumSegmentSize &&
+               m_preRecordDuration == other.m_preRecordDuration;
     }
 
     bool operator!=(const QMediaEncoderSettings &other) const
@@ -144,6 +164,7 @@ public:
     virtual void pause();
     virtual void resume();
     virtual void stop() = 0;
+    virtual void setPreRecording(const QMediaEncoderSettings &) {}
 
     virtual qint64 duration() const = 0;
 
@@ -155,6 +176,15 @@ public:
 
     QUrl outputLocation() const { return m_outputLocation; }
     virtual void setOutputLocation(const QUrl &location) { m_outputLocation = location; }
+    QIODevice *outputDevice() const { return m_outputDevice; }
+    virtual bool supportsOutputDevice() const { return false; }
+    bool setOutputDevice(QIODevice *device)
+    {
+        if (device && !supportsOutputDevice())
+            return false;
+        m_outputDevice = device;
+        return true;
+    }
     QUrl actualLocation() const { return m_actualLocation; }
     void clearActualLocation() { m_actualLocation.clear(); }
     void clearError() { error(QMediaRecorder::NoError, QString()); }
@@ -165,6 +195,7 @@ protected:
     void stateChanged(QMediaRecorder::RecorderState state);
     void durationChanged(qint64 position);
     void actualLocationChanged(const QUrl &location);
+    void segmentFinished(const QUrl &location);
     void error(QMediaRecorder::Error error, const QString &errorString);
     void metaDataChanged();
 
@@ -176,6 +207,7 @@ private:
     QString m_errorString;
     QUrl m_actualLocation;
     QUrl m_outputLocation;
+    QPointer<QIODevice> m_outputDevice;
     qint64 m_duration = 0;
 
     QMediaRecorder::RecorderState m_state = QMediaRecorder::StoppedState;
@@ -0,0 +1,145 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qplatformmetadatascanner_p.h"
+
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QPlatformMetaDataScanner
+    \internal
+
+    \brief The QPlatformMetaDataScanner class queues the files of a
+    QMediaMetaDataScanner and scans them on a thread pool.
+
+    Backends implement scanUrl(), which reads the meta data of one file
+    synchronously and may be called for several files at once.
+*/
+
+QPlatformMetaDataScanner::QPlatformMetaDataScanner(QMediaMetaDataScanner *parent)
+    : QObject(parent)
+    , q(parent)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+void QPlatformMetaDataScanner::scan(const QList<QUrl> &urls)
+{
+    if (m_shutDown)
+        return;
+    m_queue.append(urls);
+    m_batchHasWork = m_batchHasWork || !urls.isEmpty();
+    startScans();
+    emit q->pendingScansChanged();
+}
+
+void QPlatformMetaDataScanner::cancel()
+{
+    ++m_generation;
+    m_batchHasWork = false;
+    if (m_queue.isEmpty())
+        return;
+    m_queue.clear();
+    emit q->pendingScansChanged();
+}
+
+/*
+    Drops the queue and waits for the running scans, so that scanUrl() is not
+    called any more once this returns. Called before the backend is destroyed.
+*/
+void QPlatformMetaDataScanner::shutdown()
+{
+    m_shutDown = true;
+    ++m_generation;
+    m_queue.clear();
+    m_pool.waitForDone();
+}
+
+void QPlatformMetaDataScanner::setMaximumConcurrentScans(int scans)
+{
+    m_pool.setMaxThreadCount(scans);
+    startScans();
+}
+
+void QPlatformMetaDataScanner::startScans()
+{
+    while (!m_shutDown && !m_queue.isEmpty() && m_running < m_pool.maxThreadCount()) {
+        const QUrl url = m_queue.dequeue();
+        const quint64 generation = m_generation;
+        ++m_running;
+        m_pool.start([this, url, generation]() {
+            const Result result = scanUrl(url);
+            QMetaObject::invokeMethod(this, [this, url, generation, result]() {
+                scanFinished(url, generation, result);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void QPlatformMetaDataScanner::scanFinished(const QUrl &url, quint64 generation, const Result &result)
+{
+    --m_running;
+    startScans();
+
+    if (generation == m_generation) {
+        if (result.error != QMediaMetaDataScanner::NoError)
+            emit q->error(url, result.error, result.errorString);
+        else
+            emit q->scanned(url, result.metaData,
+                            result.tracks[QPlatformMediaPlayer::AudioStream],
+                            result.tracks[QPlatformMediaPlayer::VideoStream],
+                            result.tracks[QPlatformMediaPlayer::SubtitleStream]);
+    }
+
+    emit q->pendingScansChanged();
+    // Scans canceled before the current ones were queued may be the last to
+    // finish, it's the queue running empty that counts
+    if (m_batchHasWork && pendingScans() == 0) {
+        m_batchHasWork = false;
+        emit q->finished();
+    }
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qplatformmetadatascanner_p.cpp"
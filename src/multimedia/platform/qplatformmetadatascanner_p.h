@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QPLATFORMMETADATASCANNER_P_H
+#define QPLATFORMMETADATASCANNER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qmediametadatascanner.h>
+#include <private/qplatformmediaplayer_p.h>
+
+#include <QtCore/qqueue.h>
+#include <QtCore/qthreadpool.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_MULTIMEDIA_EXPORT QPlatformMetaDataScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result
+    {
+        QMediaMetaDataScanner::Error error = QMediaMetaDataScanner::NoError;
+        QString errorString;
+        QMediaMetaData metaData;
+        QList<QMediaMetaData> tracks[QPlatformMediaPlayer::NTrackTypes];
+    };
+
+    void scan(const QList<QUrl> &urls);
+    void cancel();
+    void shutdown();
+
+    int pendingScans() const { return int(m_queue.size()) + m_running; }
+    int maximumConcurrentScans() const { return m_pool.maxThreadCount(); }
+    void setMaximumConcurrentScans(int scans);
+
+protected:
+    explicit QPlatformMetaDataScanner(QMediaMetaDataScanner *parent);
+
+    // Called on worker threads, for several urls at the same time
+    virtual Result scanUrl(const QUrl &url) = 0;
+
+private:
+    void startScans();
+    void scanFinished(const QUrl &url, quint64 generation, const Result &result);
+
+    QMediaMetaDataScanner *q = nullptr;
+    QThreadPool m_pool;
+    QQueue<QUrl> m_queue;
+    int m_running = 0;
+    // bumped by cancel(), results of older scans are dropped
+    quint64 m_generation = 0;
+    // whether anything was queued since the last finished() or cancel()
+    bool m_batchHasWork = false;
+    bool m_shutDown = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPLATFORMMETADATASCANNER_P_H
@@ -0,0 +1,235 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qencodedimage_p.h"
+
+#include <QtCore/qbuffer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpromise.h>
+#include <QtCore/qthreadpool.h>
+#include <QtGui/qimagereader.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QEncodedImage
+    \brief The QEncodedImage class holds an image in its compressed form until it is needed.
+    \internal
+
+    Media files embed cover art and thumbnails that may be large, and the
+    backends report them together with the other meta data, often repeatedly.
+    QEncodedImage keeps such images compressed, and decodes them the first
+    time image() is called, or on a worker thread through decode(). Decoded
+    images are cached with the shared data, for the last sizes requested.
+
+    A QVariant holding a QEncodedImage converts to QImage, so
+    \c{metaData.value(QMediaMetaData::CoverArtImage).value<QImage>()} keeps
+    working.
+*/
+
+class QEncodedImagePrivate : public QSharedData
+{
+public:
+    QImage decode(const QSize &size) const;
+    bool cachedImage(const QSize &size, QImage *image) const;
+    void cache(const QSize &size, const QImage &image);
+
+    QByteArray data;
+    QByteArray mimeType;
+
+    static constexpr qsizetype MaxCachedImages = 2;
+
+    mutable QMutex mutex;
+    QList<QPair<QSize, QImage>> images;
+};
+
+QImage QEncodedImagePrivate::decode(const QSize &size) const
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+
+    // image/jpeg -> jpeg, image/x-portable-pixmap -> portable-pixmap
+    QByteArray format = mimeType.mid(mimeType.indexOf('/') + 1);
+    if (format.startsWith("x-"))
+        format = format.mid(2);
+
+    QImageReader reader(&buffer, format);
+    reader.setDecideFormatFromContent(true);
+    if (size.isValid()) {
+        // decoders like the JPEG one scale while decoding
+        QSize scaledSize = reader.size();
+        if (scaledSize.isValid() && (scaledSize.width() > size.width() || scaledSize.height() > size.height())) {
+            scaledSize.scale(size, Qt::KeepAspectRatio);
+            reader.setScaledSize(scaledSize);
+        }
+    }
+    return reader.read();
+}
+
+bool QEncodedImagePrivate::cachedImage(const QSize &size, QImage *image) const
+{
+    QMutexLocker locker(&mutex);
+    for (const auto &entry : images) {
+        if (entry.first == size) {
+            *image = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void QEncodedImagePrivate::cache(const QSize &size, const QImage &image)
+{
+    QMutexLocker locker(&mutex);
+    for (const auto &entry : qAsConst(images)) {
+        if (entry.first == size)
+            return;
+    }
+    // Every full decode is kept for as long as the meta data, so only the
+    // most recent sizes are
+    if (images.size() >= MaxCachedImages)
+        images.removeFirst();
+    images.append({ size, image });
+}
+
+static QImage toImage(const QEncodedImage &image)
+{
+    return image.image();
+}
+
+/*!
+    Constructs a null image.
+*/
+QEncodedImage::QEncodedImage() = default;
+
+/*!
+    Constructs an image from the compressed \a data in the format named by
+    \a mimeType, for example \c{image/jpeg}. The data is not decoded yet.
+*/
+QEncodedImage::QEncodedImage(const QByteArray &data, const QByteArray &mimeType)
+    : d(new QEncodedImagePrivate)
+{
+    static const bool converterRegistered = QMetaType::registerConverter<QEncodedImage, QImage>(toImage);
+    Q_UNUSED(converterRegistered);
+
+    d->data = data;
+    d->mimeType = mimeType;
+}
+
+QEncodedImage::QEncodedImage(const QEncodedImage &other) = default;
+
+QEncodedImage &QEncodedImage::operator=(const QEncodedImage &other) = default;
+
+QEncodedImage::~QEncodedImage() = default;
+
+/*!
+    Returns \c true if the image holds no data.
+*/
+bool QEncodedImage::isNull() const
+{
+    return !d || d->data.isEmpty();
+}
+
+/*!
+    Returns the compressed data.
+*/
+QByteArray QEncodedImage::data() const
+{
+    return d ? d->data : QByteArray();
+}
+
+/*!
+    Returns the MIME type of the compressed data.
+*/
+QByteArray QEncodedImage::mimeType() const
+{
+    return d ? d->mimeType : QByteArray();
+}
+
+/*!
+    Decodes the image on the calling thread and returns it. With a valid
+    \a size, the image is scaled down to fit into it while decoding, keeping
+    its aspect ratio.
+
+    The result is cached, also when decoding failed, so later calls with the
+    same size return it directly.
+*/
+QImage QEncodedImage::image(const QSize &size) const
+{
+    if (isNull())
+        return {};
+
+    QImage image;
+    if (!d->cachedImage(size, &image)) {
+        image = d->decode(size);
+        d->cache(size, image);
+    }
+    return image;
+}
+
+/*!
+    Decodes the image like image() on a thread of the global thread pool, and
+    returns a future for the result. A cached image is returned as a finished
+    future.
+*/
+QFuture<QImage> QEncodedImage::decode(const QSize &size) const
+{
+    if (isNull())
+        return QtFuture::makeReadyFuture(QImage());
+
+    QImage image;
+    if (d->cachedImage(size, &image))
+        return QtFuture::makeReadyFuture(image);
+
+    auto promise = std::make_shared<QPromise<QImage>>();
+    QFuture<QImage> future = promise->future();
+    promise->start();
+    QThreadPool::globalInstance()->start([encoded = *this, size, promise]() {
+        promise->addResult(encoded.image(size));
+        promise->finish();
+    });
+    return future;
+}
+
+QT_END_NAMESPACE
@@ -198,7 +198,12 @@ QList<QCameraDevice> QMediaDevices::videoInputs()
 */
 QAudioDevice QMediaDevices::defaultAudioInput()
 {
-    const auto inputs = audioInputs();
+    auto inputs = audioInputs();
+    if (inputs.isEmpty()) {
+        // The backend may not have listed the devices yet
+        QPlatformMediaIntegration::instance()->devices()->waitForAudioDevices();
+        inputs = audioInputs();
+    }
     if (inputs.isEmpty())
         return {};
     for (const auto &info : inputs)
@@ -223,7 +228,12 @@ QAudioDevice QMediaDevices::defaultAudioInput()
 */
 QAudioDevice QMediaDevices::defaultAudioOutput()
 {
-    const auto outputs = audioOutputs();
+    auto outputs = audioOutputs();
+    if (outputs.isEmpty()) {
+        // The backend may not have listed the devices yet
+        QPlatformMediaIntegration::instance()->devices()->waitForAudioDevices();
+        outputs = audioOutputs();
+    }
     if (outputs.isEmpty())
         return {};
     for (const auto &info : outputs)
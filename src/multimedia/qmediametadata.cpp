@@ -44,6 +44,7 @@
 #include <qdatetime.h>
 #include <qmediaformat.h>
 #include <qsize.h>
+#include <private/qencodedimage_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -213,6 +214,9 @@ QT_BEGIN_NAMESPACE
         \li The name of the GPS area. \li QString
 
     \endtable
+
+    Backends may keep ThumbnailImage and CoverArtImage values compressed until
+    they are used. value() decodes them and returns a QImage.
 */
 
 /*!
@@ -223,11 +227,19 @@ QT_BEGIN_NAMESPACE
 */
 
 /*!
-    \fn QVariant QMediaMetaData::value(QMediaMetaData::Key key) const
-
     Returns the meta data value for Key \a key, or a null QVariant if no
     meta data for the key is available.
 */
+QVariant QMediaMetaData::value(QMediaMetaData::Key key) const
+{
+    QVariant value = data.value(key);
+    // Images kept compressed by the backend are decoded on first use
+    if ((key == ThumbnailImage || key == CoverArtImage)
+        && value.metaType() == QMetaType::fromType<QEncodedImage>()) {
+        return value.value<QEncodedImage>().image();
+    }
+    return value;
+}
 
 /*!
     \qmlmethod bool QtMultimedia::mediaMetaData::isEmpty()
@@ -96,7 +96,7 @@ public:
     static constexpr int NumMetaData = Resolution + 1;
 
 //    QMetaType typeForKey(Key k);
-    Q_INVOKABLE QVariant value(Key k) const { return data.value(k); }
+    Q_INVOKABLE QVariant value(Key k) const;
     Q_INVOKABLE void insert(Key k, const QVariant &value) { data.insert(k, value); }
     Q_INVOKABLE void remove(Key k) { data.remove(k); }
     Q_INVOKABLE QList<Key> keys() const { return data.keys(); }
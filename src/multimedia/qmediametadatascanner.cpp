@@ -0,0 +1,208 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qmediametadatascanner.h"
+
+#include <private/qplatformmetadatascanner_p.h>
+#include <private/qplatformmediaintegration_p.h>
+
+#include <QtCore/qmetaobject.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QMediaMetaDataScanner
+    \brief The QMediaMetaDataScanner class reads the meta data of many media files.
+    \inmodule QtMultimedia
+    \ingroup multimedia
+    \ingroup multimedia_playback
+
+    \preliminary
+
+    QMediaMetaDataScanner is meant for indexing media libraries. It reads the
+    duration, the tracks and the tags of media files without setting up
+    playback, on worker threads, several files at a time.
+
+    URLs passed to scan() are queued and scanned in order, at most
+    maximumConcurrentScans() at once. The result of each file is reported
+    through scanned() or error(), in the order the scans finish, and
+    finished() is emitted once the queue is empty.
+
+    \code
+    auto *scanner = new QMediaMetaDataScanner(this);
+    connect(scanner, &QMediaMetaDataScanner::scanned, this,
+            [](const QUrl &url, const QMediaMetaData &metaData) {
+                qDebug() << url << metaData.stringValue(QMediaMetaData::Title)
+                         << metaData.value(QMediaMetaData::Duration).toLongLong();
+            });
+    scanner->scan(urls);
+    \endcode
+
+    \sa QMediaMetaData
+*/
+
+/*!
+    \enum QMediaMetaDataScanner::Error
+
+    \value NoError              No error occurred.
+    \value ResourceError        The file could not be opened or read.
+    \value FormatError          The format of the file is not supported.
+    \value TimeoutError         Reading the file took too long.
+    \value NotSupportedError    Scanning is not supported on this platform.
+*/
+
+/*!
+    Constructs a scanner with \a parent.
+*/
+QMediaMetaDataScanner::QMediaMetaDataScanner(QObject *parent)
+    : QObject(parent)
+{
+    scanner = QPlatformMediaIntegration::instance()->createMetaDataScanner(this);
+}
+
+/*!
+    Destroys the scanner. Queued scans are dropped, and the destructor waits
+    for the running ones.
+*/
+QMediaMetaDataScanner::~QMediaMetaDataScanner()
+{
+    if (scanner)
+        scanner->shutdown();
+}
+
+/*!
+    Returns \c true if scanning is supported on this platform.
+*/
+bool QMediaMetaDataScanner::isSupported() const
+{
+    return scanner != nullptr;
+}
+
+/*!
+    \property QMediaMetaDataScanner::maximumConcurrentScans
+    \brief the number of files that are scanned at the same time.
+
+    The default is the number of CPU cores.
+*/
+int QMediaMetaDataScanner::maximumConcurrentScans() const
+{
+    return scanner ? scanner->maximumConcurrentScans() : 0;
+}
+
+void QMediaMetaDataScanner::setMaximumConcurrentScans(int scans)
+{
+    if (!scanner || scans < 1 || scans == scanner->maximumConcurrentScans())
+        return;
+    scanner->setMaximumConcurrentScans(scans);
+    emit maximumConcurrentScansChanged();
+}
+
+/*!
+    \property QMediaMetaDataScanner::pendingScans
+    \brief the number of files that are queued or being scanned.
+*/
+int QMediaMetaDataScanner::pendingScans() const
+{
+    return scanner ? scanner->pendingScans() : 0;
+}
+
+/*!
+    Queues \a url for scanning.
+*/
+void QMediaMetaDataScanner::scan(const QUrl &url)
+{
+    scan(QList<QUrl>{ url });
+}
+
+/*!
+    \overload
+
+    Queues all of \a urls for scanning.
+*/
+void QMediaMetaDataScanner::scan(const QList<QUrl> &urls)
+{
+    if (urls.isEmpty())
+        return;
+
+    if (!scanner) {
+        QMetaObject::invokeMethod(this, [this, urls]() {
+            for (const auto &url : urls)
+                emit error(url, NotSupportedError, tr("Meta data scanning is not supported"));
+            emit finished();
+        }, Qt::QueuedConnection);
+        return;
+    }
+    scanner->scan(urls);
+}
+
+/*!
+    Drops all queued scans. Scans that are already running are finished, but
+    their results are not reported.
+*/
+void QMediaMetaDataScanner::cancel()
+{
+    if (scanner)
+        scanner->cancel();
+}
+
+/*!
+    \fn void QMediaMetaDataScanner::scanned(const QUrl &url, const QMediaMetaData &metaData, const QList<QMediaMetaData> &audioTracks, const QList<QMediaMetaData> &videoTracks, const QList<QMediaMetaData> &subtitleTracks)
+
+    Signals that \a url was scanned. \a metaData holds the tags of the file
+    and its duration, \a audioTracks, \a videoTracks and \a subtitleTracks
+    the properties and tags of each of its tracks.
+*/
+
+/*!
+    \fn void QMediaMetaDataScanner::error(const QUrl &url, QMediaMetaDataScanner::Error error, const QString &errorString)
+
+    Signals that \a url could not be scanned because of \a error, described
+    by \a errorString.
+*/
+
+/*!
+    \fn void QMediaMetaDataScanner::finished()
+
+    Signals that all queued files have been scanned.
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qmediametadatascanner.cpp"
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QMEDIAMETADATASCANNER_H
+#define QMEDIAMETADATASCANNER_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qurl.h>
+#include <QtMultimedia/qmediametadata.h>
+#include <QtMultimedia/qmediaenumdebug.h>
+
+QT_BEGIN_NAMESPACE
+
+class QPlatformMetaDataScanner;
+class Q_MULTIMEDIA_EXPORT QMediaMetaDataScanner : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int maximumConcurrentScans READ maximumConcurrentScans WRITE setMaximumConcurrentScans NOTIFY maximumConcurrentScansChanged)
+    Q_PROPERTY(int pendingScans READ pendingScans NOTIFY pendingScansChanged)
+
+public:
+    enum Error
+    {
+        NoError,
+        ResourceError,
+        FormatError,
+        TimeoutError,
+        NotSupportedError
+    };
+    Q_ENUM(Error)
+
+    explicit QMediaMetaDataScanner(QObject *parent = nullptr);
+    ~QMediaMetaDataScanner();
+
+    bool isSupported() const;
+
+    int maximumConcurrentScans() const;
+    void setMaximumConcurrentScans(int scans);
+
+    int pendingScans() const;
+
+public Q_SLOTS:
+    void scan(const QUrl &url);
+    void scan(const QList<QUrl> &urls);
+    void cancel();
+
+Q_SIGNALS:
+    void scanned(const QUrl &url, const QMediaMetaData &metaData,
+                 const QList<QMediaMetaData> &audioTracks,
+                 const QList<QMediaMetaData> &videoTracks,
+                 const QList<QMediaMetaData> &subtitleTracks);
+    void error(const QUrl &url, QMediaMetaDataScanner::Error error, const QString &errorString);
+    void finished();
+
+    void maximumConcurrentScansChanged();
+    void pendingScansChanged();
+
+private:
+    Q_DISABLE_COPY(QMediaMetaDataScanner)
+    QPlatformMetaDataScanner *scanner = nullptr;
+};
+
+QT_END_NAMESPACE
+
+Q_MEDIA_ENUM_DEBUG(QMediaMetaDataScanner, Error)
+
+#endif // QMEDIAMETADATASCANNER_H
@@ -132,6 +132,35 @@ QString QMediaRecorderPrivate::msgFailedStartRecording()
     return QMediaRecorder::tr("Failed to start recording");
 }
 
+QMediaEncoderSettings QMediaRecorderPrivate::resolvedSettings() const
+{
+    QMediaEncoderSettings settings = encoderSettings;
+    auto camera = captureSession ? captureSession->camera() : nullptr;
+    settings.resolveFormat(camera && camera->isActive() ? QMediaFormat::RequiresVideo
+                                                         : QMediaFormat::NoFlags);
+    return settings;
+}
+
+void QMediaRecorderPrivate::applyPreRecording()
+{
+    if (!control || !captureSession)
+        return;
+    control->setPreRecording(resolvedSettings());
+}
+
+void QMediaRecorderPrivate::connectCamera()
+{
+    QObject::disconnect(cameraActiveConnection);
+    auto camera = captureSession ? captureSession->camera() : nullptr;
+    if (!camera)
+        return;
+    // Whether video is pre-recorded depends on the camera being active
+    cameraActiveConnection = QObject::connect(camera, &QCamera::activeChanged, q_ptr, [this] {
+        if (encoderSettings.preRecordDuration() > 0)
+            applyPreRecording();
+    });
+}
+
 /*!
     Constructs a media recorder which records the media produced by a microphone and camera.
     The media recorder is a child of \a{parent}.
@@ -172,7 +201,30 @@ QPlatformMediaRecorder *QMediaRecorder::platformRecoder() const
 void QMediaRecorder::setCaptureSession(QMediaCaptureSession *session)
 {
     Q_D(QMediaRecorder);
+    if (d->captureSession == session)
+        return;
+
+    disconnect(d->cameraChangedConnection);
+    disconnect(d->audioInputChangedConnection);
+    disconnect(d->cameraActiveConnection);
     d->captureSession = session;
+    if (!session)
+        return;
+
+    auto reapply = [d] {
+        if (d->encoderSettings.preRecordDuration() > 0)
+            d->applyPreRecording();
+    };
+    d->cameraChangedConnection = connect(session, &QMediaCaptureSession::cameraChanged, this,
+                                         [d, reapply] {
+        d->connectCamera();
+        reapply();
+    });
+    d->audioInputChangedConnection = connect(session, &QMediaCaptureSession::audioInputChanged,
+                                             this, reapply);
+    d->connectCamera();
+    // A duration set before the recorder was added to a session takes effect now
+    reapply();
 }
 /*!
     \qmlproperty QUrl QtMultimedia::MediaRecorder::outputLocation
@@ -254,6 +306,54 @@ QUrl QMediaRecorder::actualLocation() const
     return d->control ? d->control->actualLocation() : QUrl();
 }
 
+/*!
+    \since 6.3
+
+    Returns the device recorded media is written to, or \nullptr if recording
+    goes to the output location.
+
+    \sa setOutputDevice()
+*/
+QIODevice *QMediaRecorder::outputDevice() const
+{
+    Q_D(const QMediaRecorder);
+    return d->control ? d->control->outputDevice() : nullptr;
+}
+
+/*!
+    \since 6.3
+
+    Writes recorded media to \a device instead of a file at the output
+    location. Pass \nullptr to record to the output location again.
+
+    The media is written as it is produced, in the thread the recorder lives
+    in, which makes it possible to stream a recording while it is still running
+    or to record into memory. Formats that normally need to go back and update
+    the start of the file are written in a streamable way, MPEG-4 as
+    fragmented MP4. \a device has to be open for writing when recording
+    starts, must stay valid until the recorder has stopped and must not be
+    used from another thread in the meantime.
+
+    Segmented recording is not available when writing to a device. An
+    errorOccurred() signal is emitted if the backend does not support
+    writing to a device.
+
+    \sa outputLocation
+*/
+void QMediaRecorder::setOutputDevice(QIODevice *device)
+{
+    Q_D(QMediaRecorder);
+    if (!d->control) {
+        emit errorOccurred(QMediaRecorder::ResourceError, tr("Not available"));
+        return;
+    }
+    if (!d->control->setOutputDevice(device)) {
+        emit errorOccurred(QMediaRecorder::ResourceError, tr("Recording to a device is not supported"));
+        return;
+    }
+    d->control->clearActualLocation();
+}
+
 /*!
     Returns the current media recorder state.
 
@@ -497,6 +597,16 @@ void QMediaRecorder::stop()
     Signals that the actual \a location of the recorded media has changed.
     This signal is usually emitted when recording starts.
 */
+/*!
+    \fn QMediaRecorder::segmentFinished(const QUrl &location)
+    \since 6.3
+
+    Signals that the segment written to \a location is complete and closed.
+
+    This signal is only emitted when recording in segments, see
+    setMaximumSegmentDuration() and setMaximumSegmentSize(). It is emitted for
+    the last segment as well, when recording stops.
+*/
 /*!
     \qmlsignal QtMultimedia::MediaRecorder::errorOccurred(Error error, const QString &errorString)
     \brief Signals that an \a error has occurred.
@@ -827,6 +937,118 @@ void QMediaRecorder::setAudioSampleRate(int sampleRate)
     emit audioSampleRateChanged();
 }
 
+/*!
+    \since 6.3
+
+    Returns the maximum duration of a recorded segment in milliseconds.
+*/
+qint64 QMediaRecorder::maximumSegmentDuration() const
+{
+    Q_D(const QMediaRecorder);
+    return d->encoderSettings.maximumSegmentDuration();
+}
+
+/*!
+    \since 6.3
+
+    Sets the maximum duration of a recorded segment to \a msecs.
+
+    When a maximum segment duration or size is set, recording is split into
+    consecutive files without losing any data in between. Every segment starts
+    with a key frame. actualLocationChanged() is emitted when a new segment is
+    opened, segmentFinished() when it has been closed.
+
+    A value of \c 0, the default, disables splitting by duration. The change
+    takes effect the next time recording starts.
+
+    \sa setMaximumSegmentSize()
+*/
+void QMediaRecorder::setMaximumSegmentDuration(qint64 msecs)
+{
+    Q_D(QMediaRecorder);
+    msecs = qMax(msecs, qint64(0));
+    if (d->encoderSettings.maximumSegmentDuration() == msecs)
+        return;
+    d->encoderSettings.setMaximumSegmentDuration(msecs);
+    emit maximumSegmentDurationChanged();
+}
+
+/*!
+    \since 6.3
+
+    Returns the maximum size of a recorded segment in bytes.
+*/
+qint64 QMediaRecorder::maximumSegmentSize() const
+{
+    Q_D(const QMediaRecorder);
+    return d->encoderSettings.maximumSegmentSize();
+}
+
+/*!
+    \since 6.3
+
+    Sets the maximum size of a recorded segment to \a bytes.
+
+    A segment is closed with the next frame once the data written to it has
+    reached the limit, so it can be slightly larger, by about one encoded frame
+    plus the data the container adds when the file is finalized. The following
+    segment starts with a key frame of its own. A value of \c 0, the default,
+    disables splitting by size.
+
+    \sa setMaximumSegmentDuration()
+*/
+void QMediaRecorder::setMaximumSegmentSize(qint64 bytes)
+{
+    Q_D(QMediaRecorder);
+    bytes = qMax(bytes, qint64(0));
+    if (d->encoderSettings.maximumSegmentSize() == bytes)
+        return;
+    d->encoderSettings.setMaximumSegmentSize(bytes);
+    emit maximumSegmentSizeChanged();
+}
+
+/*!
+    \since 6.3
+
+    Returns how many milliseconds of media recorded before record() is called
+    are written to the file.
+*/
+qint64 QMediaRecorder::preRecordDuration() const
+{
+    Q_D(const QMediaRecorder);
+    return d->encoderSettings.preRecordDuration();
+}
+
+/*!
+    \since 6.3
+
+    Keeps the last \a msecs milliseconds of encoded media while the recorder
+    is stopped, so that recording can start before the event that triggers it.
+
+    While a pre-record duration is set, the recorder encodes the camera and
+    audio input of the capture session in the background and holds on to the
+    most recent encoded data in memory. When record() is called, this history
+    is written to the file ahead of the live stream. History is trimmed at key
+    frames, so up to one group of pictures more than \a msecs can be kept.
+
+    The encoder settings in effect when the pre-record duration is set are
+    used, change them before enabling pre-recording. The camera should be
+    active at that point. Pre-recording is not combined with segmented
+    recording. A value of \c 0, the default, stops background encoding.
+
+    \note Background encoding costs as much CPU time as recording does.
+*/
+void QMediaRecorder::setPreRecordDuration(qint64 msecs)
+{
+    Q_D(QMediaRecorder);
+    msecs = qMax(msecs, qint64(0));
+    if (d->encoderSettings.preRecordDuration() == msecs)
+        return;
+    d->encoderSettings.setPreRecordDuration(msecs);
+    d->applyPreRecording();
+    emit preRecordDurationChanged();
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qmediarecorder.cpp"
@@ -55,6 +55,7 @@ class QSize;
 class QAudioFormat;
 class QCamera;
 class QCameraDevice;
+class QIODevice;
 class QMediaFormat;
 class QAudioDevice;
 class QMediaCaptureSession;
@@ -121,6 +122,9 @@ public:
 
     QUrl actualLocation() const;
 
+    QIODevice *outputDevice() const;
+    void setOutputDevice(QIODevice *device);
+
     RecorderState recorderState() const;
 
     Error error() const;
@@ -156,6 +160,15 @@ public:
     int audioSampleRate() const;
     void setAudioSampleRate(int sampleRate);
 
+    qint64 maximumSegmentDuration() const;
+    void setMaximumSegmentDuration(qint64 msecs);
+
+    qint64 maximumSegmentSize() const;
+    void setMaximumSegmentSize(qint64 bytes);
+
+    qint64 preRecordDuration() const;
+    void setPreRecordDuration(qint64 msecs);
+
     QMediaMetaData metaData() const;
     void setMetaData(const QMediaMetaData &metaData);
     void addMetaData(const QMediaMetaData &metaData);
@@ -172,6 +185,7 @@ Q_SIGNALS:
     void recorderStateChanged(RecorderState state);
     void durationChanged(qint64 duration);
     void actualLocationChanged(const QUrl &location);
+    void segmentFinished(const QUrl &location);
     void encoderSettingsChanged();
 
     void errorOccurred(Error error, const QString &errorString);
@@ -188,6 +202,9 @@ Q_SIGNALS:
     void audioBitRateChanged();
     void audioChannelCountChanged();
     void audioSampleRateChanged();
+    void maximumSegmentDurationChanged();
+    void maximumSegmentSizeChanged();
+    void preRecordDurationChanged();
 
 private:
     QMediaRecorderPrivate *d_ptr;
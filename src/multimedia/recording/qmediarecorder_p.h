@@ -71,6 +71,10 @@ public:
 
     static QString msgFailedStartRecording();
 
+    QMediaEncoderSettings resolvedSettings() const;
+    void applyPreRecording();
+    void connectCamera();
+
     QMediaCaptureSession *captureSession = nullptr;
     QPlatformMediaRecorder *control = nullptr;
 
@@ -78,6 +82,10 @@ public:
 
     QMediaEncoderSettings encoderSettings;
 
+    QMetaObject::Connection cameraChangedConnection;
+    QMetaObject::Connection audioInputChangedConnection;
+    QMetaObject::Connection cameraActiveConnection;
+
     QMediaRecorder *q_ptr = nullptr;
 };
 
@@ -40,7 +40,7 @@
 #include "qvideoframe.h"
 
 #include "qvideotexturehelper_p.h"
-#include "qmemoryvideobuffer_p.h"
+#include "qvideoframepool_p.h"
 #include "qvideoframeconversionhelper_p.h"
 #include "qvideoframeformat.h"
 #include "qpainter.h"
@@ -119,6 +119,26 @@ public:
     QMutex mapMutex;
     QString subtitleText;
 
+    // The images used by paint(), so that repainting the same frame doesn't
+    // convert it again. Dropped when the frame is mapped and unmapped for
+    // writing, as it is written to in between.
+    QMutex imageMutex;
+    QImage image;
+    QImage scaledImage;
+    QRectF scaledImageSource;
+    Qt::TransformationMode scaledImageMode = Qt::FastTransformation;
+    // changes whenever the images are dropped, so that a conversion racing
+    // with a write isn't stored
+    quint64 imageGeneration = 0;
+
+    void clearImages()
+    {
+        QMutexLocker lock(&imageMutex);
+        image = {};
+        scaledImage = {};
+        ++imageGeneration;
+    }
+
 private:
     Q_DISABLE_COPY(QVideoFramePrivate)
 };
@@ -196,16 +216,9 @@ QAbstractVideoBuffer *QVideoFrame::videoBuffer() const
 QVideoFrame::QVideoFrame(const QVideoFrameFormat &format)
     : d(new QVideoFramePrivate(format))
 {
-    auto *textureDescription = QVideoTextureHelper::textureDescription(format.pixelFormat());
-    qsizetype bytes = textureDescription->bytesForSize(format.frameSize());
-    if (bytes > 0) {
-        QByteArray data;
-        data.resize(bytes);
-
-        // Check the memory was successfully allocated.
-        if (!data.isEmpty())
-            d->buffer = new QMemoryVideoBuffer(data, textureDescription->strideForWidth(format.frameWidth()));
-    }
+    // The memory is recycled through the global frame pool, so that code
+    // creating a frame per video frame doesn't allocate each time.
+    d->buffer = QVideoFramePool::instance()->allocateBuffer(format);
 }
 
 /*!
@@ -441,6 +454,9 @@ bool QVideoFrame::map(QVideoFrame::MapMode mode)
     if (d->mapData.nPlanes == 0)
         return false;
 
+    if (mode & QVideoFrame::WriteOnly)
+        d->clearImages();
+
     if (d->mapData.nPlanes == 1) {
         auto pixelFmt = d->format.pixelFormat();
         // If the plane count is 1 derive the additional planes for planar formats.
@@ -550,6 +566,9 @@ void QVideoFrame::unmap()
     d->mappedCount--;
 
     if (d->mappedCount == 0) {
+        // paint() may have converted the frame while it was being written to
+        if (d->buffer->mapMode() & QVideoFrame::WriteOnly)
+            d->clearImages();
         d->mapData = {};
         d->buffer->unmap();
     }
@@ -758,6 +777,10 @@ void QVideoFrame::setSubtitleText(const QString &text)
     The PaintOptions \a options can be used to specify a background color and
     how \a rect should be filled with the video.
 
+    The converted image is kept with the frame, so painting the same frame
+    again at the same size, for example when only the surrounding scene is
+    redrawn, does not convert or scale it again.
+
     \note that rendering will usually happen without hardware acceleration when
     using this method.
 */
@@ -806,9 +829,21 @@ void QVideoFrame::paint(QPainter *painter, const QRectF &rect, const PaintOption
         source = s;
     }
 
-    if (map(QVideoFrame::ReadOnly)) {
-        QImage image = toImage();
+    QImage image;
+    quint64 imageGeneration;
+    {
+        QMutexLocker lock(&d->imageMutex);
+        image = d->image;
+        imageGeneration = d->imageGeneration;
+    }
+    if (image.isNull()) {
+        image = toImage();
+        QMutexLocker lock(&d->imageMutex);
+        if (d->imageGeneration == imageGeneration)
+            d->image = image;
+    }
 
+    if (!image.isNull()) {
         const QTransform oldTransform = painter->transform();
         QTransform transform = oldTransform;
         if (scanLineDirection == QVideoFrameFormat::BottomToTop) {
@@ -823,10 +858,33 @@ void QVideoFrame::paint(QPainter *painter, const QRectF &rect, const PaintOption
             targetRect = QRectF(0, targetRect.y(), targetRect.width(), targetRect.height());
         }
         painter->setTransform(transform);
+
+        // Unless the image is drawn rotated or flipped, scale it once for the
+        // target size and blit it unscaled when only the scene is repainted.
+        const QTransform deviceTransform = painter->deviceTransform();
+        const QSize deviceSize = deviceTransform.mapRect(targetRect).size().toSize();
+        if (deviceTransform.type() <= QTransform::TxScale && deviceTransform.m11() > 0
+            && deviceTransform.m22() > 0 && !deviceSize.isEmpty()) {
+            const auto mode = painter->testRenderHint(QPainter::SmoothPixmapTransform)
+                    ? Qt::SmoothTransformation : Qt::FastTransformation;
+            QMutexLocker lock(&d->imageMutex);
+            if (d->imageGeneration != imageGeneration || d->scaledImage.isNull()
+                || d->scaledImage.size() != deviceSize || d->scaledImageSource != source
+                || d->scaledImageMode != mode) {
+                image = image.copy(source.toAlignedRect()).scaled(deviceSize, Qt::IgnoreAspectRatio, mode);
+                if (d->imageGeneration == imageGeneration) {
+                    d->scaledImage = image;
+                    d->scaledImageSource = source;
+                    d->scaledImageMode = mode;
+                }
+            } else {
+                image = d->scaledImage;
+            }
+            source = image.rect();
+        }
+
         painter->drawImage(targetRect, image, source);
         painter->setTransform(oldTransform);
-
-        unmap();
     } else if (isValid()) {
         // #### error handling
     } else {
@@ -0,0 +1,313 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qvideoframepool_p.h"
+
+#include "qvideotexturehelper_p.h"
+#include <private/qabstractvideobuffer_p.h>
+
+#include <qlist.h>
+#include <qmutex.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QVideoFramePool
+    \brief The QVideoFramePool class recycles the system memory of video frames.
+    \internal
+
+    Frames allocated from a pool are backed by aligned memory. When the last
+    QVideoFrame referring to the memory is destroyed, the memory is returned to
+    the pool and handed out again for the next frame of the same size, instead
+    of being freed.
+
+    The pool keeps at most maximumFreeBuffers() unused buffers and
+    maximumFreeBytes() of unused memory; the buffers that were returned first
+    are freed when either limit is exceeded.
+
+    Frames may outlive the pool they were allocated from, their memory is then
+    freed directly.
+*/
+
+class QVideoFramePoolPrivate
+{
+public:
+    struct Block
+    {
+        uchar *data = nullptr;
+        qsizetype size = 0;
+    };
+
+    ~QVideoFramePoolPrivate() { clear(); }
+
+    uchar *take(qsizetype size)
+    {
+        {
+            QMutexLocker locker(&mutex);
+            for (qsizetype i = freeList.size() - 1; i >= 0; --i) {
+                if (freeList.at(i).size == size) {
+                    uchar *data = freeList.takeAt(i).data;
+                    freeBytes -= size;
+                    return data;
+                }
+            }
+        }
+        return static_cast<uchar *>(qMallocAligned(size, QVideoFramePool::Alignment));
+    }
+
+    void release(uchar *data, qsizetype size)
+    {
+        {
+            QMutexLocker locker(&mutex);
+            freeList.append({ data, size });
+            freeBytes += size;
+        }
+        shrink();
+    }
+
+    // frees the oldest blocks until the pool is within its limits
+    void shrink()
+    {
+        QList<Block> evicted;
+        {
+            QMutexLocker locker(&mutex);
+            while (!freeList.isEmpty() && (freeList.size() > maximumFreeBuffers || freeBytes > maximumFreeBytes)) {
+                evicted.append(freeList.takeFirst());
+                freeBytes -= evicted.last().size;
+            }
+        }
+        for (const auto &block : qAsConst(evicted))
+            qFreeAligned(block.data);
+    }
+
+    void clear()
+    {
+        QList<Block> evicted;
+        {
+            QMutexLocker locker(&mutex);
+            evicted.swap(freeList);
+            freeBytes = 0;
+        }
+        for (const auto &block : qAsConst(evicted))
+            qFreeAligned(block.data);
+    }
+
+    mutable QMutex mutex;
+    QList<Block> freeList;
+    qsizetype freeBytes = 0;
+    int maximumFreeBuffers = 8;
+    qsizetype maximumFreeBytes = 128 * 1024 * 1024;
+};
+
+class QPooledVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    QPooledVideoBuffer(const std::shared_ptr<QVideoFramePoolPrivate> &pool, uchar *data, qsizetype size, int bytesPerLine)
+        : QAbstractVideoBuffer(QVideoFrame::NoHandle)
+        , pool(pool)
+        , data(data)
+        , size(size)
+        , bytesPerLine(bytesPerLine)
+    {}
+
+    ~QPooledVideoBuffer()
+    {
+        if (auto p = pool.lock())
+            p->release(data, size);
+        else
+            qFreeAligned(data);
+    }
+
+    QVideoFrame::MapMode mapMode() const override { return m_mapMode; }
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        MapData mapData;
+        if (m_mapMode == QVideoFrame::NotMapped && mode != QVideoFrame::NotMapped) {
+            m_mapMode = mode;
+
+            mapData.nPlanes = 1;
+            mapData.bytesPerLine[0] = bytesPerLine;
+            mapData.data[0] = data;
+            mapData.size[0] = int(size);
+        }
+        return mapData;
+    }
+
+    void unmap() override { m_mapMode = QVideoFrame::NotMapped; }
+
+private:
+    std::weak_ptr<QVideoFramePoolPrivate> pool;
+    uchar *data = nullptr;
+    qsizetype size = 0;
+    int bytesPerLine = 0;
+    QVideoFrame::MapMode m_mapMode = QVideoFrame::NotMapped;
+};
+
+Q_GLOBAL_STATIC(QVideoFramePool, globalFramePool)
+
+/*!
+    Constructs an empty pool.
+*/
+QVideoFramePool::QVideoFramePool()
+    : d(std::make_shared<QVideoFramePoolPrivate>())
+{
+}
+
+/*!
+    Destroys the pool and frees its unused buffers. Buffers that are still
+    in use by frames are freed together with the last frame.
+*/
+QVideoFramePool::~QVideoFramePool() = default;
+
+/*!
+    Returns the pool used by QVideoFrame(const QVideoFrameFormat &).
+*/
+QVideoFramePool *QVideoFramePool::instance()
+{
+    return globalFramePool();
+}
+
+/*!
+    Returns a frame of \a format backed by memory from the pool, or an invalid
+    frame if the format has no size or the memory could not be allocated.
+
+    The contents of recycled memory are undefined.
+*/
+QVideoFrame QVideoFramePool::allocate(const QVideoFrameFormat &format)
+{
+    QAbstractVideoBuffer *buffer = allocateBuffer(format);
+    return buffer ? QVideoFrame(buffer, format) : QVideoFrame();
+}
+
+/*!
+    Returns a buffer for a frame of \a format backed by memory from the pool,
+    or \nullptr if the format has no size or the memory could not be allocated.
+    The caller takes ownership of the buffer.
+
+    This is for code that has a QVideoFrame to put the buffer into already.
+
+    \sa allocate()
+*/
+QAbstractVideoBuffer *QVideoFramePool::allocateBuffer(const QVideoFrameFormat &format)
+{
+    auto *textureDescription = QVideoTextureHelper::textureDescription(format.pixelFormat());
+    qsizetype bytes = textureDescription->bytesForSize(format.frameSize());
+    if (bytes <= 0)
+        return nullptr;
+
+    uchar *data = d->take(bytes);
+    if (!data)
+        return nullptr;
+
+    return new QPooledVideoBuffer(d, data, bytes, textureDescription->strideForWidth(format.frameWidth()));
+}
+
+/*!
+    Returns the maximum number of unused buffers the pool keeps. The default is 8.
+*/
+int QVideoFramePool::maximumFreeBuffers() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maximumFreeBuffers;
+}
+
+/*!
+    Sets the maximum number of unused buffers the pool keeps to \a buffers.
+    Setting it to 0 disables recycling.
+*/
+void QVideoFramePool::setMaximumFreeBuffers(int buffers)
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        d->maximumFreeBuffers = qMax(buffers, 0);
+    }
+    d->shrink();
+}
+
+/*!
+    Returns the maximum amount of unused memory in bytes the pool keeps.
+    The default is 128 MB.
+*/
+qsizetype QVideoFramePool::maximumFreeBytes() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maximumFreeBytes;
+}
+
+/*!
+    Sets the maximum amount of unused memory the pool keeps to \a bytes.
+*/
+void QVideoFramePool::setMaximumFreeBytes(qsizetype bytes)
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        d->maximumFreeBytes = qMax(bytes, qsizetype(0));
+    }
+    d->shrink();
+}
+
+/*!
+    Returns the number of unused buffers in the pool.
+*/
+int QVideoFramePool::freeBuffers() const
+{
+    QMutexLocker locker(&d->mutex);
+    return int(d->freeList.size());
+}
+
+/*!
+    Returns the amount of unused memory in the pool in bytes.
+*/
+qsizetype QVideoFramePool::freeBytes() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->freeBytes;
+}
+
+/*!
+    Frees all unused buffers.
+*/
+void QVideoFramePool::clear()
+{
+    d->clear();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,269 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qvideopresentationqueue_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QVideoPresentationQueue
+    \brief The QVideoPresentationQueue class decides which video frame to show on the next refresh.
+    \internal
+
+    Video outputs used to show the latest frame they received whenever the
+    screen was next refreshed. With a frame rate that is not a divisor of the
+    refresh rate, the time a frame stays on screen then depends on when it
+    happened to arrive, which shows as judder.
+
+    The queue instead keeps the frames it receives and, when an output is about
+    to render, returns the frame whose start time best matches the time the
+    rendered image will be shown. Frames that were superseded before they got
+    on screen are dropped without being uploaded.
+
+    Outputs receive frames at the pace they are played at. Each frame is due
+    one frame after the previous one, following the playback rate measured
+    from how fast the start times advance, and the due times are slowly pulled
+    towards the arrival times to absorb drift. A frame arriving more than about
+    one frame away from its expected time, for example after a seek, a pause or
+    a rate change, starts the timeline again and is due right away. Frames
+    without a start time are shown as soon as possible.
+
+    The queue is thread-safe, frames may be enqueued and taken on different
+    threads.
+*/
+
+QVideoPresentationQueue::QVideoPresentationQueue()
+{
+    m_clock.start();
+}
+
+/*!
+    Sets the \a refreshRate of the screen the frames are shown on in Hz.
+*/
+void QVideoPresentationQueue::setRefreshRate(qreal refreshRate)
+{
+    if (refreshRate <= 0)
+        return;
+    QMutexLocker locker(&m_mutex);
+    m_refreshInterval = qRound64(1000000. / refreshRate);
+}
+
+qreal QVideoPresentationQueue::refreshRate() const
+{
+    QMutexLocker locker(&m_mutex);
+    return 1000000. / m_refreshInterval;
+}
+
+/*!
+    Adds \a frame to the queue. When the queue is full, the oldest frame is
+    dropped if the frame after it is due already, otherwise \a frame is.
+*/
+void QVideoPresentationQueue::enqueue(const QVideoFrame &frame)
+{
+    enqueue(frame, now());
+}
+
+/*!
+    \overload
+
+    Adds \a frame as if it arrived at \a arrivalTime, in microseconds, instead
+    of the time of the queue's own clock. The same time base has to be passed
+    to takeFrame().
+*/
+void QVideoPresentationQueue::enqueue(const QVideoFrame &frame, qint64 arrivalTime)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const qint64 dueTime = dueTimeFor(frame, arrivalTime);
+
+    // frames arrive in presentation order, a frame due earlier than the one
+    // before it replaces it
+    while (!m_frames.isEmpty() && m_frames.last().dueTime >= dueTime) {
+        m_frames.removeLast();
+        ++m_statistics.droppedFrames;
+    }
+    if (m_frames.size() == MaxPendingFrames) {
+        ++m_statistics.droppedFrames;
+        // the oldest frame is about to be superseded anyway when the next
+        // one is due, otherwise it still has to be shown
+        if (!isDue(m_frames.at(1), arrivalTime))
+            return;
+        m_frames.removeFirst();
+    }
+    m_frames.append({ frame, arrivalTime, dueTime });
+}
+
+qint64 QVideoPresentationQueue::dueTimeFor(const QVideoFrame &frame, qint64 arrivalTime)
+{
+    const qint64 startTime = frame.startTime();
+    if (startTime < 0)
+        return arrivalTime;
+
+    const bool hasDuration = frame.endTime() > startTime;
+    if (hasDuration)
+        m_frameDuration = frame.endTime() - startTime;
+
+    qint64 dueTime = arrivalTime;
+    if (m_hasTimeline && startTime > m_lastStartTime) {
+        const qint64 mediaDelta = startTime - m_lastStartTime;
+        const qint64 arrivalDelta = arrivalTime - m_lastArrivalTime;
+
+        const qint64 tolerance = qMax(qRound64(m_frameDuration / m_rate), m_refreshInterval);
+        const bool continuous =
+                qAbs(arrivalTime - m_lastDueTime - qRound64(mediaDelta / m_rate)) <= tolerance;
+
+        // Frames delivered in a burst tell nothing about the rate. Otherwise
+        // the rate follows frames that continue the timeline, or two frames
+        // in a row advancing at the same new rate, but not single jumps from
+        // seeks or pauses.
+        if (arrivalDelta >= m_refreshInterval / 4) {
+            const qreal rate = qreal(mediaDelta) / arrivalDelta;
+            if (rate >= 1. / 16 && rate <= 16.
+                && (continuous || qAbs(rate - m_lastRateSample) <= m_lastRateSample / 2)) {
+                m_rate += (rate - m_rate) / 8;
+            }
+            m_lastRateSample = rate;
+        }
+
+        const qint64 expected = m_lastDueTime + qRound64(mediaDelta / m_rate);
+        const qint64 deviation = arrivalTime - expected;
+        if (qAbs(deviation) <= tolerance) {
+            dueTime = expected + deviation / 16;
+            if (!hasDuration)
+                m_frameDuration = mediaDelta;
+        }
+    }
+
+    m_hasTimeline = true;
+    m_lastStartTime = startTime;
+    m_lastArrivalTime = arrivalTime;
+    m_lastDueTime = dueTime;
+    return dueTime;
+}
+
+/*!
+    Stores the frame to show on the next refresh in \a frame and returns \c true,
+    or returns \c false if the frame on screen should stay.
+
+    Call this when rendering; the rendered image is expected to reach the
+    screen one refresh interval later.
+*/
+bool QVideoPresentationQueue::takeFrame(QVideoFrame *frame)
+{
+    return takeFrame(frame, now());
+}
+
+/*!
+    \overload
+
+    Takes the frame to show as if rendering at \a currentTime, see
+    enqueue(const QVideoFrame &, qint64).
+*/
+bool QVideoPresentationQueue::takeFrame(QVideoFrame *frame, qint64 currentTime)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const qint64 displayTime = currentTime + m_refreshInterval;
+    // the last frame due by the middle of the refresh interval it is shown in
+    qsizetype index = -1;
+    for (qsizetype i = 0; i < m_frames.size(); ++i) {
+        if (!isDue(m_frames.at(i), currentTime))
+            break;
+        index = i;
+    }
+    if (index < 0)
+        return false;
+
+    const PendingFrame &pending = m_frames.at(index);
+    *frame = pending.frame;
+
+    const qint64 latency = displayTime - pending.arrivalTime;
+    const qint64 error = qAbs(displayTime - pending.dueTime);
+    ++m_statistics.presentedFrames;
+    m_statistics.droppedFrames += index;
+    m_totalLatency += latency;
+    m_totalError += error;
+    m_statistics.averageLatency = m_totalLatency / m_statistics.presentedFrames;
+    m_statistics.maximumLatency = qMax(m_statistics.maximumLatency, latency);
+    m_statistics.averageError = m_totalError / m_statistics.presentedFrames;
+    m_statistics.maximumError = qMax(m_statistics.maximumError, error);
+
+    m_frames.remove(0, index + 1);
+    return true;
+}
+
+/*!
+    Returns \c true if frames are waiting to be shown, and the output should
+    keep rendering on every refresh.
+*/
+bool QVideoPresentationQueue::hasPendingFrames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_frames.isEmpty();
+}
+
+/*!
+    Drops all queued frames, and restarts the mapping of start times.
+*/
+void QVideoPresentationQueue::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_frames.clear();
+    m_hasTimeline = false;
+    m_frameDuration = 0;
+    m_rate = 1.;
+    m_lastRateSample = 1.;
+}
+
+QVideoPresentationQueue::Statistics QVideoPresentationQueue::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+void QVideoPresentationQueue::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_statistics = {};
+    m_totalLatency = 0;
+    m_totalError = 0;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QVIDEOPRESENTATIONQUEUE_P_H
+#define QVIDEOPRESENTATIONQUEUE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtMultimedia/qvideoframe.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_MULTIMEDIA_EXPORT QVideoPresentationQueue
+{
+public:
+    struct Statistics
+    {
+        int presentedFrames = 0;
+        int droppedFrames = 0;
+        // time from a frame's arrival until it's on screen, in usecs
+        qint64 averageLatency = 0;
+        qint64 maximumLatency = 0;
+        // how far frames were shown from the time they were due, in usecs
+        qint64 averageError = 0;
+        qint64 maximumError = 0;
+    };
+
+    QVideoPresentationQueue();
+
+    void setRefreshRate(qreal refreshRate);
+    qreal refreshRate() const;
+
+    void enqueue(const QVideoFrame &frame);
+    void enqueue(const QVideoFrame &frame, qint64 arrivalTime);
+    bool takeFrame(QVideoFrame *frame);
+    bool takeFrame(QVideoFrame *frame, qint64 currentTime);
+    bool hasPendingFrames() const;
+    void clear();
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    struct PendingFrame
+    {
+        QVideoFrame frame;
+        qint64 arrivalTime = 0;
+        qint64 dueTime = 0;
+    };
+
+    enum { MaxPendingFrames = 8 };
+
+    qint64 now() const { return m_clock.nsecsElapsed() / 1000; }
+    qint64 dueTimeFor(const QVideoFrame &frame, qint64 arrivalTime);
+    bool isDue(const PendingFrame &pending, qint64 currentTime) const
+    {
+        return pending.dueTime <= currentTime + m_refreshInterval + m_refreshInterval / 2;
+    }
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QList<PendingFrame> m_frames;
+    qint64 m_refreshInterval = 16667;
+
+    // the timeline of the stream, from the last frame with a start time
+    bool m_hasTimeline = false;
+    qint64 m_lastStartTime = 0;
+    qint64 m_lastArrivalTime = 0;
+    qint64 m_lastDueTime = 0;
+    qint64 m_frameDuration = 0;
+    qreal m_rate = 1.;
+    qreal m_lastRateSample = 1.;
+
+    Statistics m_statistics;
+    qint64 m_totalLatency = 0;
+    qint64 m_totalError = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -44,6 +44,10 @@
 #endif
 
 #include <qpainter.h>
+#include <qhash.h>
+#include <qmutex.h>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -466,6 +470,22 @@ void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const Q
     memcpy(data + 64 + 64 + 4, &width, 4);
 }
 
+static int bytesPerTexel(QRhiTexture::Format format)
+{
+    switch (format) {
+    case QRhiTexture::R8:
+        return 1;
+    case QRhiTexture::RG8:
+    case QRhiTexture::R16:
+        return 2;
+    case QRhiTexture::RGBA8:
+    case QRhiTexture::RG16:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
 int updateRhiTextures(QVideoFrame frame, QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates, QRhiTexture **textures)
 {
     QVideoFrameFormat fmt = frame.surfaceFormat();
@@ -511,6 +531,12 @@ int updateRhiTextures(QVideoFrame frame, QRhi *rhi, QRhiResourceUpdateBatch *res
     }
 
     Q_ASSERT(frame.planeCount() == description->nplanes);
+
+    // only the part inside the viewport is ever sampled
+    QRect viewport = fmt.viewport().intersected(QRect(QPoint(0, 0), size));
+    if (viewport.isEmpty())
+        viewport = QRect(QPoint(0, 0), size);
+
     for (int plane = 0; plane < description->nplanes; ++plane) {
 
         bool needsRebuild = !textures[plane] || textures[plane]->pixelSize() != planeSizes[plane];
@@ -526,8 +552,24 @@ int updateRhiTextures(QVideoFrame frame, QRhi *rhi, QRhiResourceUpdateBatch *res
             }
         }
 
-        auto data = QByteArray::fromRawData((const char *)frame.bits(plane), frame.mappedBytes(plane));
-        QRhiTextureSubresourceUploadDescription subresDesc(data);
+        const int bytesPerPixel = bytesPerTexel(description->textureFormat[plane]);
+        const QRect planeRect(viewport.x() / description->sizeScale[plane].x,
+                              viewport.y() / description->sizeScale[plane].y,
+                              description->widthForPlane(viewport.width(), plane),
+                              description->heightForPlane(viewport.height(), plane));
+        QRhiTextureSubresourceUploadDescription subresDesc;
+        if (bytesPerPixel && planeRect != QRect(QPoint(0, 0), planeSizes[plane])
+            && QRect(QPoint(0, 0), planeSizes[plane]).contains(planeRect)) {
+            // upload the cropped part only, straight from the mapped frame
+            const int offset = planeRect.y() * frame.bytesPerLine(plane) + planeRect.x() * bytesPerPixel;
+            auto data = QByteArray::fromRawData((const char *)frame.bits(plane) + offset,
+                                                frame.mappedBytes(plane) - offset);
+            subresDesc.setData(data);
+            subresDesc.setSourceSize(planeRect.size());
+            subresDesc.setDestinationTopLeft(planeRect.topLeft());
+        } else {
+            subresDesc.setData(QByteArray::fromRawData((const char *)frame.bits(plane), frame.mappedBytes(plane)));
+        }
         subresDesc.setDataStride(frame.bytesPerLine(plane));
         QRhiTextureUploadEntry entry(0, 0, subresDesc);
         QRhiTextureUploadDescription desc({ entry });
@@ -536,6 +578,130 @@ int updateRhiTextures(QVideoFrame frame, QRhi *rhi, QRhiResourceUpdateBatch *res
     return description->nplanes;
 }
 
+namespace {
+
+// Textures no longer used by any frame, kept per QRhi for the next frames
+constexpr qsizetype MaxFreeTextures = 4 * TextureDescription::maxPlanes;
+
+// The textures uploaded per QRhi, looked up by the frame they show, so that
+// outputs showing the same frame don't upload it again.
+struct TextureCache
+{
+    QMutex mutex;
+    QHash<QRhi *, QList<std::weak_ptr<FrameTextures>>> textures;
+    QHash<QRhi *, QList<QRhiTexture *>> freeTextures;
+};
+
+}
+
+Q_GLOBAL_STATIC(TextureCache, textureCache)
+
+FrameTextures::FrameTextures(const QVideoFrame &frame, QRhi *rhi)
+    : m_frame(frame)
+    , m_rhi(rhi)
+{
+}
+
+FrameTextures::~FrameTextures()
+{
+    // Uploaded textures go back to the free list of their QRhi, wrappers of
+    // native textures and textures of a QRhi that is gone are deleted
+    auto *cache = textureCache();
+    if (!cache || m_frame.handleType() == QVideoFrame::RhiTextureHandle) {
+        for (auto *texture : m_textures)
+            delete texture;
+        return;
+    }
+
+    QMutexLocker locker(&cache->mutex);
+    const auto it = cache->freeTextures.find(m_rhi);
+    for (auto *texture : m_textures) {
+        if (it != cache->freeTextures.end() && texture && it->size() < MaxFreeTextures)
+            it->append(texture);
+        else
+            delete texture;
+    }
+}
+
+/*
+    Returns the textures showing \a frame in \a rhi. Textures another output
+    already uploaded for the same frame are shared; otherwise the frame is
+    uploaded, into textures of earlier frames that nobody shows any more when
+    they fit. \a oldTextures is released first, so the textures of the
+    previous frame are reused once the last output moves on.
+
+    The caller keeps the returned textures, and the frame, alive for as long as
+    the GPU may still use them.
+*/
+std::shared_ptr<FrameTextures> createTextures(const QVideoFrame &frame, QRhi *rhi,
+                                              QRhiResourceUpdateBatch *resourceUpdates,
+                                              std::shared_ptr<FrameTextures> &&oldTextures)
+{
+    if (!frame.isValid())
+        return {};
+
+    auto *cache = textureCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        auto it = cache->textures.find(rhi);
+        if (it == cache->textures.end()) {
+            it = cache->textures.insert(rhi, {});
+            cache->freeTextures.insert(rhi, {});
+            rhi->addCleanupCallback([](QRhi *rhi) {
+                auto *cache = textureCache();
+                if (!cache)
+                    return;
+                QMutexLocker locker(&cache->mutex);
+                cache->textures.remove(rhi);
+                qDeleteAll(cache->freeTextures.take(rhi));
+            });
+        }
+        auto &entries = it.value();
+        entries.removeIf([](const std::weak_ptr<FrameTextures> &entry) { return entry.expired(); });
+        for (const auto &entry : qAsConst(entries)) {
+            auto textures = entry.lock();
+            if (textures && textures->m_frame == frame)
+                return textures;
+        }
+    }
+
+    // Once nobody else shows the old frame, its textures are free for this one
+    oldTextures.reset();
+
+    auto textures = std::make_shared<FrameTextures>(frame, rhi);
+    if (frame.handleType() != QVideoFrame::RhiTextureHandle) {
+        const QSize size = frame.surfaceFormat().frameSize();
+        const TextureDescription *description = descriptions + frame.pixelFormat();
+        QMutexLocker locker(&cache->mutex);
+        auto &freeTextures = cache->freeTextures[rhi];
+        for (int plane = 0; plane < description->nplanes; ++plane) {
+            const QSize planeSize(size.width() / description->sizeScale[plane].x,
+                                  size.height() / description->sizeScale[plane].y);
+            const auto it = std::find_if(freeTextures.begin(), freeTextures.end(), [&](QRhiTexture *texture) {
+                return texture->format() == description->textureFormat[plane]
+                        && texture->pixelSize() == planeSize;
+            });
+            if (it != freeTextures.end()) {
+                textures->m_textures[plane] = *it;
+                freeTextures.erase(it);
+            }
+        }
+    }
+
+    if (!updateRhiTextures(frame, rhi, resourceUpdates, textures->m_textures)) {
+        // Textures that failed to create must not be recycled
+        for (auto *&texture : textures->m_textures) {
+            delete texture;
+            texture = nullptr;
+        }
+        return {};
+    }
+
+    QMutexLocker locker(&textureCache()->mutex);
+    textureCache()->textures[rhi].append(textures);
+    return textures;
+}
+
 bool SubtitleLayout::updateFromVideoFrame(const QVideoFrame &frame)
 {
     auto text = frame.subtitleText();
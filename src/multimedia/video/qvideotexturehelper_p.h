@@ -51,11 +51,14 @@
 // We mean it.
 //
 
+#include <qvideoframe.h>
 #include <qvideoframeformat.h>
 #include <private/qrhi_p.h>
 
 #include <QtGui/qtextlayout.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 class QVideoFrame;
@@ -101,6 +104,29 @@ Q_MULTIMEDIA_EXPORT void updateUniformData(QByteArray *dst, const QVideoFrameFor
 Q_MULTIMEDIA_EXPORT int updateRhiTextures(QVideoFrame frame, QRhi *rhi,
                                            QRhiResourceUpdateBatch *resourceUpdates, QRhiTexture **textures);
 
+// The textures of one frame, shared by all outputs showing it with the same QRhi
+class Q_MULTIMEDIA_EXPORT FrameTextures
+{
+public:
+    FrameTextures(const QVideoFrame &frame, QRhi *rhi);
+    ~FrameTextures();
+
+    QRhiTexture *texture(int plane) const { return plane < TextureDescription::maxPlanes ? m_textures[plane] : nullptr; }
+
+private:
+    Q_DISABLE_COPY(FrameTextures)
+    friend std::shared_ptr<FrameTextures> createTextures(const QVideoFrame &, QRhi *, QRhiResourceUpdateBatch *,
+                                                         std::shared_ptr<FrameTextures> &&);
+
+    QVideoFrame m_frame;
+    QRhi *m_rhi = nullptr;
+    QRhiTexture *m_textures[TextureDescription::maxPlanes] = {};
+};
+
+Q_MULTIMEDIA_EXPORT std::shared_ptr<FrameTextures> createTextures(const QVideoFrame &frame, QRhi *rhi,
+                                                                  QRhiResourceUpdateBatch *resourceUpdates,
+                                                                  std::shared_ptr<FrameTextures> &&oldTextures);
+
 struct Q_MULTIMEDIA_EXPORT SubtitleLayout
 {
     QSize videoSize;
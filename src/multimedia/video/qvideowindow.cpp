@@ -41,6 +41,7 @@
 #include <QPlatformSurfaceEvent>
 #include <qfile.h>
 #include <qpainter.h>
+#include <qscreen.h>
 #include <private/qguiapplication_p.h>
 #include <qpa/qplatformintegration.h>
 
@@ -330,6 +331,21 @@ void QVideoWindowPrivate::releaseSwapChain()
     }
 }
 
+void QVideoWindowPrivate::presentNextFrame()
+{
+    if (QScreen *screen = q->screen())
+        m_presentationQueue.setRefreshRate(screen->refreshRate());
+
+    QVideoFrame frame;
+    if (!m_presentationQueue.takeFrame(&frame))
+        return;
+
+    if (m_currentFrame.subtitleText() != frame.subtitleText())
+        m_subtitleDirty = true;
+    m_currentFrame = frame;
+    m_texturesDirty = true;
+}
+
 void QVideoWindowPrivate::render()
 {
     if (!initialized)
@@ -495,7 +511,11 @@ bool QVideoWindow::event(QEvent *e)
 {
     switch (e->type()) {
     case QEvent::UpdateRequest:
+        d->presentNextFrame();
         d->render();
+        // keep rendering on every refresh until the queued frames are shown
+        if (d->isExposed && d->m_presentationQueue.hasPendingFrames())
+            requestUpdate();
         return true;
 
     case QEvent::PlatformSurface:
@@ -529,10 +549,16 @@ void QVideoWindow::resizeEvent(QResizeEvent *resizeEvent)
 
 void QVideoWindow::setVideoFrame(const QVideoFrame &frame)
 {
-    if (d->m_currentFrame.subtitleText() != frame.subtitleText())
-        d->m_subtitleDirty = true;
-    d->m_currentFrame = frame;
-    d->m_texturesDirty = true;
+    if (!frame.isValid()) {
+        // the stream stopped, clear the window right away
+        d->m_presentationQueue.clear();
+        if (d->m_currentFrame.subtitleText() != frame.subtitleText())
+            d->m_subtitleDirty = true;
+        d->m_currentFrame = frame;
+        d->m_texturesDirty = true;
+    } else {
+        d->m_presentationQueue.enqueue(frame);
+    }
     if (d->isExposed)
         requestUpdate();
 }
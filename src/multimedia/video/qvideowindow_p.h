@@ -72,6 +72,7 @@
 #include <qvideoframe.h>
 #include <private/qplatformvideosink_p.h>
 #include <private/qvideotexturehelper_p.h>
+#include <private/qvideopresentationqueue_p.h>
 #include <qbackingstore.h>
 
 QT_BEGIN_NAMESPACE
@@ -88,6 +89,7 @@ public:
 
     void init();
     void render();
+    void presentNextFrame();
 
     void initRhi();
 
@@ -129,6 +131,7 @@ public:
     QRhi::Implementation m_graphicsApi = QRhi::Null;
     QSize m_frameSize = QSize(-1, -1);
     QVideoFrame m_currentFrame;
+    QVideoPresentationQueue m_presentationQueue;
     QVideoTextureHelper::SubtitleLayout m_subtitleLayout;
 
     enum { NVideoFrameSlots = 4 };
@@ -46,6 +46,7 @@
 #include <QtCore/qloggingcategory.h>
 #include <qvideosink.h>
 #include <QtQuick/QQuickWindow>
+#include <QtGui/qscreen.h>
 #include <private/qquickwindow_p.h>
 #include <qsgvideonode_p.h>
 
@@ -421,18 +422,35 @@ void QQuickVideoOutput::itemChange(QQuickItem::ItemChange change,
         return;
     if (m_window)
         disconnect(m_window);
+    disconnect(m_screenChangedConnection);
     m_window = changeData.window;
 
     if (m_window) {
+        m_screenChangedConnection = QObject::connect(m_window, &QWindow::screenChanged,
+                                                     this, &QQuickVideoOutput::_q_screenChanged);
         // We want to receive the signals in the render thread
         QObject::connect(m_window, &QQuickWindow::sceneGraphInitialized, this, &QQuickVideoOutput::_q_sceneGraphInitialized,
                          Qt::DirectConnection);
         QObject::connect(m_window, &QQuickWindow::sceneGraphInvalidated,
                          this, &QQuickVideoOutput::_q_invalidateSceneGraph, Qt::DirectConnection);
     }
+    _q_screenChanged(m_window ? m_window->screen() : nullptr);
     initRhiForSink();
 }
 
+void QQuickVideoOutput::_q_screenChanged(QScreen *screen)
+{
+    // present() runs on the thread of the sink, where the screen must not
+    // be touched. Keep the refresh rate up to date from here instead.
+    disconnect(m_refreshRateConnection);
+    if (!screen)
+        return;
+    m_presentationQueue.setRefreshRate(screen->refreshRate());
+    m_refreshRateConnection = connect(screen, &QScreen::refreshRateChanged, this, [this](qreal refreshRate) {
+        m_presentationQueue.setRefreshRate(refreshRate);
+    });
+}
+
 QSize QQuickVideoOutput::nativeSize() const
 {
     return m_surfaceFormat.viewport().size();
@@ -499,12 +517,27 @@ QSGNode *QQuickVideoOutput::updatePaintNode(QSGNode *oldNode,
                                              QQuickItem::UpdatePaintNodeData *data)
 {
     Q_UNUSED(data);
-    _q_updateGeometry();
 
     QSGVideoNode *videoNode = static_cast<QSGVideoNode *>(oldNode);
 
     QMutexLocker lock(&m_frameMutex);
 
+    QVideoFrame nextFrame;
+    if (m_presentationQueue.takeFrame(&nextFrame)) {
+        m_frame = nextFrame;
+        m_frameChanged = true;
+    }
+    // The node and geometry follow the frame going on screen, queued frames
+    // carry their own format
+    if (m_frameChanged && m_frame.surfaceFormat() != m_surfaceFormat) {
+        m_surfaceFormat = m_frame.surfaceFormat();
+        m_geometryDirty = true;
+    }
+    _q_updateGeometry();
+    // keep rendering on every refresh until the queued frames are shown
+    if (m_presentationQueue.hasPendingFrames())
+        QMetaObject::invokeMethod(this, [this]() { update(); }, Qt::QueuedConnection);
+
     if (m_frameChanged) {
         if (videoNode && videoNode->pixelFormat() != m_frame.pixelFormat()) {
             qCDebug(qLcVideo) << "updatePaintNode: deleting old video node because frame format changed";
@@ -556,9 +589,22 @@ QRectF QQuickVideoOutput::adjustedViewport() const
 void QQuickVideoOutput::present(const QVideoFrame &frame)
 {
     m_frameMutex.lock();
-    m_surfaceFormat = frame.surfaceFormat();
-    m_frame = frame;
-    m_frameChanged = true;
+    if (frame.isValid()) {
+        // shown from updatePaintNode() when its time has come
+        m_presentationQueue.enqueue(frame);
+    } else {
+        const auto statistics = m_presentationQueue.statistics();
+        if (statistics.presentedFrames)
+            qCDebug(qLcVideo) << "presented" << statistics.presentedFrames << "frames, dropped"
+                              << statistics.droppedFrames << "latency avg/max"
+                              << statistics.averageLatency << statistics.maximumLatency
+                              << "us, timing error avg/max" << statistics.averageError
+                              << statistics.maximumError << "us";
+        m_presentationQueue.resetStatistics();
+        m_presentationQueue.clear();
+        m_frame = frame;
+        m_frameChanged = true;
+    }
     m_frameMutex.unlock();
 
     update();
@@ -59,12 +59,14 @@
 #include <QtCore/qmutex.h>
 
 #include <private/qtmultimediaquickglobal_p.h>
+#include <private/qvideopresentationqueue_p.h>
 #include <qvideoframe.h>
 #include <qvideoframeformat.h>
 
 QT_BEGIN_NAMESPACE
 
 class QQuickVideoBackend;
+class QScreen;
 class QVideoOutputOrientationHandler;
 class QVideoSink;
 
@@ -136,6 +138,7 @@ private Q_SLOTS:
     void _q_updateGeometry();
     void _q_invalidateSceneGraph();
     void _q_sceneGraphInitialized();
+    void _q_screenChanged(QScreen *screen);
 
 private:
     QSize m_nativeSize;
@@ -148,9 +151,12 @@ private:
 
     QPointer<QQuickWindow> m_window;
     QVideoSink *m_sink = nullptr;
-    QVideoFrameFormat m_surfaceFormat;
+    QVideoFrameFormat m_surfaceFormat; // Of the frame on screen, set in updatePaintNode()
 
     QVideoFrame m_frame;
+    QVideoPresentationQueue m_presentationQueue;
+    QMetaObject::Connection m_screenChangedConnection;
+    QMetaObject::Connection m_refreshRateConnection;
     bool m_frameChanged = false;
     QMutex m_frameMutex;
     QRectF m_renderedRect;         // Destination pixel coordinates, clipped
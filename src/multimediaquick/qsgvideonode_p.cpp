@@ -201,6 +201,7 @@ public:
 
     enum { NVideoFrameSlots = 4 };
     QVideoFrame m_videoFrameSlots[NVideoFrameSlots];
+    std::shared_ptr<QVideoTextureHelper::FrameTextures> m_frameTextures;
     QScopedPointer<QSGVideoTexture> m_textures[3];
 };
 
@@ -214,21 +215,14 @@ void QSGVideoMaterial::updateTextures(QRhi *rhi, QRhiResourceUpdateBatch *resour
     Q_ASSERT(NVideoFrameSlots >= rhi->resourceLimit(QRhi::FramesInFlight));
     m_videoFrameSlots[rhi->currentFrameSlot()] = m_currentFrame;
 
-    // update and upload all textures
-    QRhiTexture *textures[3] = {};
-    for (int i = 0; i < 3; ++i) {
-        if (m_textures[i].data())
-            textures[i] = m_textures[i].data()->rhiTexture();
-        else
-            textures[i] = nullptr;
-    }
-
-    QVideoTextureHelper::updateRhiTextures(m_currentFrame, rhi, resourceUpdates, textures);
+    // Outputs showing the same frame share its textures, and a paused frame
+    // is not uploaded again.
+    m_frameTextures = QVideoTextureHelper::createTextures(m_currentFrame, rhi, resourceUpdates,
+                                                          std::move(m_frameTextures));
+    m_texturesDirty = false;
 
-    for (int i = 0; i < 3; ++i) {
-        if (m_textures[i].data())
-            m_textures[i].data()->setRhiTexture(textures[i]);
-    }
+    for (int i = 0; i < 3; ++i)
+        m_textures[i].data()->setRhiTexture(m_frameTextures ? m_frameTextures->texture(i) : nullptr);
 }
 
 
@@ -56,6 +56,8 @@ private:
     QByteArray m_data;
 
     QScopedPointer<QRhiTexture> m_texture;
+    // set through setRhiTexture(), owned by the caller
+    QRhiTexture *m_externalTexture = nullptr;
     quint64 m_nativeObject = 0;
 };
 
@@ -76,8 +78,8 @@ qint64 QSGVideoTexture::comparisonKey() const
     if (d->m_nativeObject)
         return d->m_nativeObject;
 
-    if (d->m_texture)
-        return qint64(qintptr(d->m_texture.data()));
+    if (QRhiTexture *texture = rhiTexture())
+        return qint64(qintptr(texture));
 
     // two textures (and so materials) with not-yet-created texture underneath are never equal
     return qint64(qintptr(this));
@@ -85,7 +87,8 @@ qint64 QSGVideoTexture::comparisonKey() const
 
 QRhiTexture *QSGVideoTexture::rhiTexture() const
 {
-    return d_func()->m_texture.data();
+    Q_D(const QSGVideoTexture);
+    return d->m_externalTexture ? d->m_externalTexture : d->m_texture.data();
 }
 
 QSize QSGVideoTexture::textureSize() const
@@ -126,6 +129,9 @@ void QSGVideoTexturePrivate::updateRhiTexture(QRhi *rhi, QRhiResourceUpdateBatch
 {
     Q_Q(QSGVideoTexture);
 
+    if (m_externalTexture)
+        return;
+
     bool needsRebuild = m_texture && m_texture->pixelSize() != m_size;
     if (!m_texture) {
         QRhiTexture::Flags flags;
@@ -164,9 +170,12 @@ void QSGVideoTexture::commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch
     d_func()->updateRhiTexture(rhi, resourceUpdates);
 }
 
+/*
+    Shows \a texture, which stays owned by the caller and must outlive its use.
+*/
 void QSGVideoTexture::setRhiTexture(QRhiTexture *texture)
 {
-    d_func()->m_texture.reset(texture);
+    d_func()->m_externalTexture = texture;
 }
 
 QT_END_NAMESPACE
@@ -74,6 +74,7 @@ private slots:
     void testCameraFormat();
     void testCameraCapture();
     void testCaptureToBuffer();
+    void testCaptureBurst();
     void testCameraCaptureMetadata();
     void testExposureCompensation();
     void testExposureMode();
@@ -431,6 +432,56 @@ void tst_QCameraBackend::testCaptureToBuffer()
     QTRY_VERIFY(imageCapture.isReadyForCapture());
 }
 
+void tst_QCameraBackend::testCaptureBurst()
+{
+    if (noCamera)
+        QSKIP("No camera available");
+
+    QMediaCaptureSession session;
+    QCamera camera;
+    QImageCapture imageCapture;
+    session.setCamera(&camera);
+    session.setImageCapture(&imageCapture);
+
+    camera.setActive(true);
+    QTRY_VERIFY(camera.isActive());
+    QTRY_VERIFY(imageCapture.isReadyForCapture());
+
+    QSignalSpy imageAvailableSignal(&imageCapture, SIGNAL(imageAvailable(int,QVideoFrame)));
+    QSignalSpy savedSignal(&imageCapture, SIGNAL(imageSaved(int,QString)));
+    QSignalSpy errorSignal(&imageCapture, SIGNAL(errorOccurred(int,QImageCapture::Error,const QString&)));
+
+    const int count = 4;
+    int id = imageCapture.captureBurst(count, 2);
+    QVERIFY(id > 0);
+    QTRY_COMPARE_WITH_TIMEOUT(imageAvailableSignal.count(), count, 10000);
+    QVERIFY(errorSignal.isEmpty());
+    QVERIFY(savedSignal.isEmpty());
+
+    // Consecutive ids, one frame each
+    for (int i = 0; i < count; ++i) {
+        QCOMPARE(imageAvailableSignal.at(i).first().toInt(), id + i);
+        QVideoFrame frame = imageAvailableSignal.at(i).last().value<QVideoFrame>();
+        QVERIFY(!frame.toImage().isNull());
+    }
+    imageAvailableSignal.clear();
+
+    // The same into files, named after the given location
+    const QString location = QDir::temp().filePath(QStringLiteral("tst_qcamerabackend_burst.jpg"));
+    id = imageCapture.captureBurstToFile(count, 1, location);
+    QVERIFY(id > 0);
+    QTRY_COMPARE_WITH_TIMEOUT(savedSignal.count(), count, 10000);
+    QVERIFY(errorSignal.isEmpty());
+    QStringList files;
+    for (const auto &args : qAsConst(savedSignal))
+        files.append(args.last().toString());
+    QCOMPARE(QSet<QString>(files.cbegin(), files.cend()).size(), count);
+    for (const QString &file : qAsConst(files)) {
+        QVERIFY2(!QImageReader(file).read().isNull(), qPrintable(file));
+        QFile::remove(file);
+    }
+}
+
 void tst_QCameraBackend::testCameraCaptureMetadata()
 {
     if (noCamera)
@@ -95,6 +95,8 @@ private slots:
     void can_record_AudioInput_with_null_AudioDevice();
     void can_record_Camera_with_null_CameraDevice();
     void recording_stops_when_recorder_removed();
+    void can_record_in_segments_by_size();
+    void recording_includes_pre_recorded_history();
 
     void can_add_and_remove_ImageCapture();
     void can_move_ImageCapture_between_sessions();
@@ -785,6 +787,94 @@ void tst_QMediaCaptureSession::recording_stops_when_recorder_removed()
     QFile(fileName).remove();
 }
 
+void tst_QMediaCaptureSession::can_record_in_segments_by_size()
+{
+    QAudioInput input;
+    if (input.device().isNull())
+        QSKIP("Recording source not available");
+
+    QMediaCaptureSession session;
+    QMediaRecorder recorder;
+    session.setAudioInput(&input);
+    session.setRecorder(&recorder);
+
+    const qint64 maximumSize = 8 * 1024;
+    recorder.setMaximumSegmentSize(maximumSize);
+    recorder.setQuality(QMediaRecorder::HighQuality);
+
+    QSignalSpy recorderErrorSignal(&recorder, SIGNAL(errorOccurred(Error, const QString &)));
+    QSignalSpy segmentFinished(&recorder, &QMediaRecorder::segmentFinished);
+    QSignalSpy locationChanged(&recorder, &QMediaRecorder::actualLocationChanged);
+
+    recorder.record();
+    QTRY_VERIFY_WITH_TIMEOUT(recorder.recorderState() == QMediaRecorder::RecordingState, 2000);
+    // Several segments have been closed while recording continues
+    QTRY_VERIFY_WITH_TIMEOUT(segmentFinished.count() >= 2, 10000);
+    QCOMPARE(recorder.recorderState(), QMediaRecorder::RecordingState);
+    recorder.stop();
+    QTRY_VERIFY_WITH_TIMEOUT(recorder.recorderState() == QMediaRecorder::StoppedState, 2000);
+    QVERIFY(recorderErrorSignal.isEmpty());
+
+    // Every opened segment gets closed, the last one when recording stops
+    QTRY_COMPARE(segmentFinished.count(), locationChanged.count());
+
+    QStringList files;
+    for (const auto &args : qAsConst(segmentFinished))
+        files.append(args.at(0).toUrl().toLocalFile());
+    QCOMPARE(QSet<QString>(files.cbegin(), files.cend()).size(), files.size());
+    for (int i = 0; i < files.size(); ++i) {
+        const qint64 size = QFileInfo(files.at(i)).size();
+        QVERIFY2(size > 0, qPrintable(files.at(i)));
+        // Only the last segment may be closed before reaching the limit, and
+        // none grows much beyond it
+        if (i < files.size() - 1)
+            QVERIFY2(size >= maximumSize, qPrintable(QString::number(size)));
+        QVERIFY2(size < 2 * maximumSize, qPrintable(QString::number(size)));
+    }
+    for (const QString &file : qAsConst(files))
+        QFile::remove(file);
+}
+
+void tst_QMediaCaptureSession::recording_includes_pre_recorded_history()
+{
+    QAudioInput input;
+    if (input.device().isNull())
+        QSKIP("Recording source not available");
+
+    QMediaCaptureSession session;
+    QMediaRecorder recorder;
+    // Set before the recorder is part of a session, pre-recording starts when it is added
+    const qint64 preRecordDuration = 1000;
+    recorder.setPreRecordDuration(preRecordDuration);
+    session.setAudioInput(&input);
+    session.setRecorder(&recorder);
+
+    QSignalSpy recorderErrorSignal(&recorder, SIGNAL(errorOccurred(Error, const QString &)));
+    QSignalSpy durationChanged(&recorder, SIGNAL(durationChanged(qint64)));
+
+    // Let more history accumulate than is kept
+    QTest::qWait(2 * preRecordDuration);
+
+    recorder.record();
+    QTRY_VERIFY_WITH_TIMEOUT(recorder.recorderState() == QMediaRecorder::RecordingState, 2000);
+    QVERIFY(durationChanged.wait(2000));
+    recorder.stop();
+    QTRY_VERIFY_WITH_TIMEOUT(recorder.recorderState() == QMediaRecorder::StoppedState, 2000);
+    QVERIFY(recorderErrorSignal.isEmpty());
+
+    // The recording starts with the history instead of at record(), which
+    // was only a moment ago. Allow for the granularity of audio buffers.
+    QVERIFY2(recorder.duration() >= preRecordDuration - 100,
+             qPrintable(QString::number(recorder.duration())));
+    QVERIFY2(recorder.duration() < 2 * preRecordDuration + 500,
+             qPrintable(QString::number(recorder.duration())));
+
+    QString fileName = recorder.actualLocation().toLocalFile();
+    QVERIFY(!fileName.isEmpty());
+    QTRY_VERIFY(QFileInfo(fileName).size() > 0);
+    QFile(fileName).remove();
+}
+
 void tst_QMediaCaptureSession::can_add_and_remove_ImageCapture()
 {
     QCamera camera;
@@ -41,6 +41,7 @@
 #include "qmockmediadevices_p.h"
 #include "qmockmediaplayer.h"
 #include "qmockaudiodecoder.h"
+#include "qmockmetadatascanner.h"
 #include "qmockcamera.h"
 #include "qmockmediacapturesession.h"
 #include "qmockvideosink.h"
@@ -76,6 +77,12 @@ QPlatformAudioDecoder *QMockIntegration::createAudioDecoder(QAudioDecoder *decod
     return m_lastAudioDecoderControl;
 }
 
+QPlatformMetaDataScanner *QMockIntegration::createMetaDataScanner(QMediaMetaDataScanner *scanner)
+{
+    m_lastMetaDataScanner = new QMockMetaDataScanner(scanner);
+    return m_lastMetaDataScanner;
+}
+
 QPlatformMediaPlayer *QMockIntegration::createPlayer(QMediaPlayer *parent)
 {
     if (m_flags & NoPlayerInterface)
@@ -58,6 +58,7 @@ QT_BEGIN_NAMESPACE
 class QMockMediaDevices;
 class QMockMediaPlayer;
 class QMockAudioDecoder;
+class QMockMetaDataScanner;
 class QMockCamera;
 class QMockMediaCaptureSession;
 class QMockVideoSink;
@@ -72,6 +73,7 @@ public:
     QPlatformMediaFormatInfo *formatInfo() override { return nullptr; }
 
     QPlatformAudioDecoder *createAudioDecoder(QAudioDecoder *decoder) override;
+    QPlatformMetaDataScanner *createMetaDataScanner(QMediaMetaDataScanner *scanner) override;
     QPlatformMediaPlayer *createPlayer(QMediaPlayer *) override;
     QPlatformCamera *createCamera(QCamera *) override;
     QPlatformMediaRecorder *createRecorder(QMediaRecorder *) override;
@@ -93,6 +95,7 @@ public:
 
     QMockMediaPlayer *lastPlayer() const { return m_lastPlayer; }
     QMockAudioDecoder *lastAudioDecoder() const { return m_lastAudioDecoderControl; }
+    QMockMetaDataScanner *lastMetaDataScanner() const { return m_lastMetaDataScanner; }
     QMockCamera *lastCamera() const { return m_lastCamera; }
     // QMockMediaEncoder *lastEncoder const { return m_lastEncoder; }
     QMockMediaCaptureSession *lastCaptureService() const { return m_lastCaptureService; }
@@ -103,6 +106,7 @@ private:
     QMockMediaDevices *m_devices = nullptr;
     QMockMediaPlayer *m_lastPlayer = nullptr;
     QMockAudioDecoder *m_lastAudioDecoderControl = nullptr;
+    QMockMetaDataScanner *m_lastMetaDataScanner = nullptr;
     QMockCamera *m_lastCamera = nullptr;
     // QMockMediaEncoder *m_lastEncoder = nullptr;
     QMockMediaCaptureSession *m_lastCaptureService = nullptr;
@@ -0,0 +1,76 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMOCKMETADATASCANNER_H
+#define QMOCKMETADATASCANNER_H
+
+#include "private/qplatformmetadatascanner_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE
+
+// Reports the file name as the title; urls with a "broken" scheme fail and
+// files named "slow..." take ten times as long to scan.
+class QMockMetaDataScanner : public QPlatformMetaDataScanner
+{
+public:
+    QMockMetaDataScanner(QMediaMetaDataScanner *parent)
+        : QPlatformMetaDataScanner(parent)
+    {}
+
+    QAtomicInt running;
+    QAtomicInt maximumRunning;
+    int scanDuration = 10;
+
+protected:
+    Result scanUrl(const QUrl &url) override
+    {
+        const int now = running.fetchAndAddOrdered(1) + 1;
+        int max = maximumRunning.loadAcquire();
+        while (now > max && !maximumRunning.testAndSetOrdered(max, now, max)) {}
+        QThread::msleep(url.fileName().startsWith(QLatin1String("slow")) ? 10 * scanDuration : scanDuration);
+        running.fetchAndAddOrdered(-1);
+
+        Result result;
+        if (url.scheme() == QLatin1String("broken")) {
+            result.error = QMediaMetaDataScanner::ResourceError;
+            result.errorString = QStringLiteral("broken");
+            return result;
+        }
+        result.metaData.insert(QMediaMetaData::Title, url.fileName());
+        result.metaData.insert(QMediaMetaData::Duration, qint64(1000));
+        result.tracks[QPlatformMediaPlayer::AudioStream].append(QMediaMetaData());
+        return result;
+    }
+};
+
+QT_END_NAMESPACE
+
+#endif // QMOCKMETADATASCANNER_H
@@ -0,0 +1,142 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <private/qaudiocapturedispatcher_p.h>
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qsemaphore.h>
+
+class tst_QAudioCaptureDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QAudioCaptureDispatcher()
+    {
+        m_format.setChannelCount(1);
+        m_format.setSampleFormat(QAudioFormat::Int16);
+        m_format.setSampleRate(1000);
+    }
+
+private Q_SLOTS:
+    void deliversFixedSizeBlocks();
+    void reportsOverruns();
+    void forwardsDeviceWrites();
+
+private:
+    QAudioFormat m_format;
+};
+
+void tst_QAudioCaptureDispatcher::deliversFixedSizeBlocks()
+{
+    QMutex mutex;
+    QList<QAudioBuffer> blocks;
+    QSemaphore delivered;
+
+    QAudioCaptureDispatcher dispatcher(m_format, 10, [&](const QAudioBuffer &buffer) {
+        QMutexLocker locker(&mutex);
+        blocks.append(buffer);
+        delivered.release();
+    });
+    QCOMPARE(dispatcher.bytesPerBlock(), qsizetype(20));
+    dispatcher.start();
+
+    // 25 frames in chunks that don't line up with the block size
+    QByteArray data(50, Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i)
+        data[i] = char(i);
+    dispatcher.push(data.constData(), 7);
+    dispatcher.push(data.constData() + 7, 30);
+    dispatcher.push(data.constData() + 37, 13);
+
+    QVERIFY(delivered.tryAcquire(2, 5000));
+    dispatcher.stop();
+
+    QCOMPARE(blocks.size(), 2); // the trailing half block is not delivered
+    QCOMPARE(blocks.at(0).byteCount(), 20);
+    QCOMPARE(blocks.at(0).format(), m_format);
+    QCOMPARE(blocks.at(0).startTime(), qint64(0));
+    QCOMPARE(blocks.at(1).startTime(), qint64(10000));
+    QCOMPARE(QByteArray(blocks.at(0).constData<char>(), 20), data.left(20));
+    QCOMPARE(QByteArray(blocks.at(1).constData<char>(), 20), data.mid(20, 20));
+    QCOMPARE(dispatcher.processedBytes(), qint64(50));
+    QCOMPARE(dispatcher.overrunCount(), 0u);
+}
+
+void tst_QAudioCaptureDispatcher::reportsOverruns()
+{
+    QSemaphore entered;
+    QSemaphore proceed;
+    QList<qint64> startTimes;
+
+    QAudioCaptureDispatcher dispatcher(m_format, 10, [&](const QAudioBuffer &buffer) {
+        startTimes.append(buffer.startTime());
+        entered.release();
+        proceed.acquire();
+    }, 2);
+    dispatcher.start();
+
+    QByteArray block(20, 0);
+    dispatcher.push(block.constData(), block.size());
+    QVERIFY(entered.tryAcquire(1, 5000));
+
+    // The callback is blocked on the first block; two more fill the ring,
+    // the next two have nowhere to go
+    for (int i = 0; i < 4; ++i)
+        dispatcher.push(block.constData(), block.size());
+    QCOMPARE(dispatcher.overrunCount(), 2u);
+
+    proceed.release(3);
+    QVERIFY(entered.tryAcquire(2, 5000));
+    dispatcher.stop();
+
+    QCOMPARE(startTimes, (QList<qint64>{ 0, 10000, 20000 }));
+}
+
+void tst_QAudioCaptureDispatcher::forwardsDeviceWrites()
+{
+    QSemaphore delivered;
+    QAudioCaptureDispatcher dispatcher(m_format, 4, [&](const QAudioBuffer &) {
+        delivered.release();
+    });
+    dispatcher.start();
+
+    QIODevice *device = dispatcher.device();
+    QVERIFY(device->isWritable());
+    QCOMPARE(device->write(QByteArray(16, 0)), qint64(16));
+
+    QVERIFY(delivered.tryAcquire(2, 5000));
+    dispatcher.stop();
+}
+
+QTEST_APPLESS_MAIN(tst_QAudioCaptureDispatcher)
+
+#include "tst_qaudiocapturedispatcher.moc"
@@ -0,0 +1,542 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+#include <QtCore/qbuffer.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qtemporaryfile.h>
+#include <qaudiodecoder.h>
+#include <qwavedecoder.h>
+#include <private/qaudiowaveform_p.h>
+#include <private/qsimd_p.h>
+
+#include "qmockintegration_p.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+class tst_QAudioWaveform : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void analyze_data();
+    void analyze();
+    void analyzeAudioDecoder();
+    void coarseQuery();
+    void timeQuery();
+    void saveAndLoad();
+    void loadOtherSource();
+    void loadInvalid();
+    void cancel();
+    void closeMapped_data();
+    void closeMapped();
+    void reduceKernels_data();
+    void reduceKernels();
+
+private:
+    QMockIntegration mockIntegration;
+    QTemporaryDir tempDir;
+};
+
+static const int FrameCount = 10000;
+static const int FramesPerBucket = 16;
+
+// Stereo 16 bit samples: a sawtooth on the left, a square wave with a period of
+// 2048 frames on the right
+static QList<qint16> testSamples()
+{
+    QList<qint16> samples;
+    for (int i = 0; i < FrameCount; ++i) {
+        samples.append(qint16((i % 200 - 100) * 300));
+        samples.append(qint16((i / 1024) % 2 ? 12000 : -6000));
+    }
+    return samples;
+}
+
+static QByteArray waveFile(const QList<qint16> &samples)
+{
+    const int channels = 2;
+    const int sampleRate = 8000;
+    const QByteArray data(reinterpret_cast<const char *>(samples.constData()),
+                          samples.size() * sizeof(qint16));
+
+    QByteArray file;
+    QDataStream stream(&file, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("RIFF", 4);
+    stream << quint32(4 + 8 + 16 + 8 + data.size());
+    stream.writeRawData("WAVEfmt ", 8);
+    stream << quint32(16) << quint16(1) << quint16(channels) << quint32(sampleRate)
+           << quint32(sampleRate * channels * 2) << quint16(channels * 2) << quint16(16);
+    stream.writeRawData("data", 4);
+    stream << quint32(data.size());
+    stream.writeRawData(data.constData(), data.size());
+    return file;
+}
+
+static std::unique_ptr<QIODevice> waveDevice(const QByteArray &data, bool useFile, const QString &dir)
+{
+    if (useFile) {
+        auto file = std::make_unique<QTemporaryFile>(dir + QLatin1String("/XXXXXX.wav"));
+        if (!file->open() || file->write(data) != data.size() || !file->seek(0))
+            return {};
+        return file;
+    }
+    auto buffer = std::make_unique<QBuffer>();
+    buffer->setData(data);
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+static QAudioWaveform::Peak expectedPeak(const QList<qint16> &samples, int channel, qint64 from, qint64 to)
+{
+    QAudioWaveform::Peak peak;
+    peak.min = peak.max = samples.at(from * 2 + channel) / 32768.f;
+    double sumSquares = 0;
+    for (qint64 i = from; i < to; ++i) {
+        const float s = samples.at(i * 2 + channel) / 32768.f;
+        peak.min = qMin(peak.min, s);
+        peak.max = qMax(peak.max, s);
+        sumSquares += s * s;
+    }
+    peak.rms = float(std::sqrt(sumSquares / (to - from)));
+    return peak;
+}
+
+static bool analyzeWave(QAudioWaveform &waveform, QWaveDecoder &decoder)
+{
+    QSignalSpy readySpy(&waveform, &QAudioWaveform::ready);
+    if (!waveform.analyze(&decoder))
+        return false;
+    return readySpy.wait() && readySpy.count() == 1;
+}
+
+void tst_QAudioWaveform::analyze_data()
+{
+    QTest::addColumn<bool>("useFile");
+
+    QTest::newRow("buffer") << false;
+    QTest::newRow("mapped file") << true;
+}
+
+void tst_QAudioWaveform::analyze()
+{
+    QFETCH(bool, useFile);
+
+    const QList<qint16> samples = testSamples();
+    auto device = waveDevice(waveFile(samples), useFile, tempDir.path());
+    QVERIFY(device);
+    QWaveDecoder decoder(device.get());
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QCOMPARE(decoder.mappedData().isEmpty(), !useFile);
+
+    QAudioWaveform waveform;
+    waveform.setFramesPerBucket(FramesPerBucket);
+    QVERIFY(analyzeWave(waveform, decoder));
+    QVERIFY(waveform.isReady());
+    QVERIFY(!waveform.isRunning());
+    QCOMPARE(waveform.channelCount(), 2);
+    QCOMPARE(waveform.sampleRate(), 8000);
+    QCOMPARE(waveform.frameCount(), qint64(FrameCount));
+    QCOMPARE(waveform.duration(), qint64(1250000));
+    QCOMPARE(waveform.bucketFrames(0), qint64(FramesPerBucket));
+    QCOMPARE(waveform.bucketFrames(1), qint64(FramesPerBucket * QAudioWaveform::LevelFactor));
+
+    // 625 buckets, divided by four until a single one is left
+    QCOMPARE(waveform.levelCount(), 6);
+
+    // One point per bucket reads the finest level unchanged
+    for (int channel = 0; channel < 2; ++channel) {
+        const QList<QAudioWaveform::Peak> peaks =
+                waveform.framePeaks(channel, 0, FrameCount, FrameCount / FramesPerBucket);
+        QCOMPARE(peaks.size(), FrameCount / FramesPerBucket);
+        for (int i = 0; i < peaks.size(); ++i) {
+            const auto expected = expectedPeak(samples, channel, i * FramesPerBucket,
+                                               (i + 1) * FramesPerBucket);
+            QCOMPARE(peaks.at(i).min, expected.min);
+            QCOMPARE(peaks.at(i).max, expected.max);
+            QVERIFY(qAbs(peaks.at(i).rms - expected.rms) < 1e-5f);
+        }
+    }
+
+    // A single point covers everything
+    const auto all = waveform.framePeaks(1, 0, FrameCount, 1);
+    QCOMPARE(all.size(), 1);
+    const auto expected = expectedPeak(samples, 1, 0, FrameCount);
+    QCOMPARE(all.first().min, expected.min);
+    QCOMPARE(all.first().max, expected.max);
+    QVERIFY(qAbs(all.first().rms - expected.rms) < 1e-4f);
+
+    QVERIFY(waveform.framePeaks(2, 0, FrameCount, 10).isEmpty());
+    QVERIFY(waveform.framePeaks(0, 0, FrameCount, 0).isEmpty());
+}
+
+void tst_QAudioWaveform::analyzeAudioDecoder()
+{
+    // The mock decodes 10 buffers of 4 mono UInt8 frames, buffer n holding
+    // the bytes n, 0, 0, 0
+    QAudioDecoder decoder;
+    decoder.setSource(QUrl::fromLocalFile(QLatin1String("test.wav")));
+
+    QAudioWaveform waveform;
+    waveform.setFramesPerBucket(4);
+    QSignalSpy readySpy(&waveform, &QAudioWaveform::ready);
+    QSignalSpy errorSpy(&waveform, &QAudioWaveform::error);
+    QVERIFY(waveform.analyze(&decoder));
+    QVERIFY(decoder.isDecoding());
+    QTRY_COMPARE_WITH_TIMEOUT(readySpy.count(), 1, 5000);
+    QCOMPARE(errorSpy.count(), 0);
+
+    QCOMPARE(waveform.channelCount(), 1);
+    QCOMPARE(waveform.sampleRate(), 1000);
+    QCOMPARE(waveform.sampleFormat(), QAudioFormat::UInt8);
+    QCOMPARE(waveform.frameCount(), qint64(40));
+
+    const QList<QAudioWaveform::Peak> peaks = waveform.framePeaks(0, 0, 40, 10);
+    QCOMPARE(peaks.size(), 10);
+    for (int i = 0; i < peaks.size(); ++i) {
+        QCOMPARE(peaks.at(i).min, -1.f);
+        QCOMPARE(peaks.at(i).max, (i - 128) / 128.f);
+    }
+
+    // Without a source the decoder fails to start
+    QAudioDecoder unset;
+    QVERIFY(waveform.analyze(&unset));
+    QCOMPARE(errorSpy.count(), 1);
+    QVERIFY(!waveform.isRunning());
+}
+
+void tst_QAudioWaveform::coarseQuery()
+{
+    const QList<qint16> samples = testSamples();
+    QBuffer buffer;
+    buffer.setData(waveFile(samples));
+    buffer.open(QIODevice::ReadOnly);
+    QWaveDecoder decoder(&buffer);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+
+    QAudioWaveform waveform;
+    waveform.setFramesPerBucket(FramesPerBucket);
+    QVERIFY(analyzeWave(waveform, decoder));
+
+    // Points not aligned to buckets get the peaks of the buckets they touch
+    const qint64 start = 1234;
+    const qint64 end = 9876;
+    const int count = 37;
+    const QList<QAudioWaveform::Peak> peaks = waveform.framePeaks(0, start, end, count);
+    QCOMPARE(peaks.size(), count);
+    for (int i = 0; i < count; ++i) {
+        const qint64 from = start + (end - start) * i / count;
+        const qint64 to = start + (end - start) * (i + 1) / count;
+        const auto expected = expectedPeak(samples, 0, from, to);
+        QVERIFY(peaks.at(i).min <= expected.min);
+        QVERIFY(peaks.at(i).max >= expected.max);
+        QVERIFY(peaks.at(i).rms > 0);
+        QVERIFY(peaks.at(i).rms <= qMax(-peaks.at(i).min, peaks.at(i).max));
+    }
+
+    // More points than frames
+    const QList<QAudioWaveform::Peak> zoomed = waveform.framePeaks(0, 100, 104, 8);
+    QCOMPARE(zoomed.size(), 8);
+    QCOMPARE(zoomed.first().min, zoomed.last().min);
+
+    // Ranges are clipped to the stream
+    const QList<QAudioWaveform::Peak> clipped = waveform.framePeaks(0, FrameCount, FrameCount + 100, 4);
+    QCOMPARE(clipped.size(), 4);
+    QCOMPARE(clipped.first().max, 0.f);
+}
+
+void tst_QAudioWaveform::timeQuery()
+{
+    const QList<qint16> samples = testSamples();
+    QBuffer buffer;
+    buffer.setData(waveFile(samples));
+    buffer.open(QIODevice::ReadOnly);
+    QWaveDecoder decoder(&buffer);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+
+    QAudioWaveform waveform;
+    waveform.setFramesPerBucket(FramesPerBucket);
+    QVERIFY(analyzeWave(waveform, decoder));
+
+    // The right channel is low for the first 128ms, and high for the next 128ms
+    const auto peaks = waveform.peaks(1, 0, 256000, 2);
+    QCOMPARE(peaks.size(), 2);
+    QCOMPARE(peaks.at(0).max, -6000 / 32768.f);
+    QCOMPARE(peaks.at(1).min, 12000 / 32768.f);
+}
+
+void tst_QAudioWaveform::saveAndLoad()
+{
+    const QList<qint16> samples = testSamples();
+    QBuffer buffer;
+    buffer.setData(waveFile(samples));
+    buffer.open(QIODevice::ReadOnly);
+    QWaveDecoder decoder(&buffer);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+
+    QAudioWaveform waveform;
+    waveform.setFramesPerBucket(FramesPerBucket);
+    QVERIFY(analyzeWave(waveform, decoder));
+
+    const QString fileName = QAudioWaveform::sidecarFileName(tempDir.filePath(QLatin1String("test.wav")));
+    QVERIFY(fileName.endsWith(QLatin1String(".peaks")));
+    QVERIFY(waveform.save(fileName));
+    // Six bytes per bucket and channel after the header
+    QCOMPARE(QFileInfo(fileName).size(), qint64(42 + 625 * 2 * 6));
+
+    QAudioWaveform loaded;
+    QVERIFY(loaded.load(fileName));
+    QCOMPARE(loaded.channelCount(), waveform.channelCount());
+    QCOMPARE(loaded.sampleRate(), waveform.sampleRate());
+    QCOMPARE(loaded.sampleFormat(), QAudioFormat::Int16);
+    QCOMPARE(loaded.frameCount(), waveform.frameCount());
+    QCOMPARE(loaded.levelCount(), waveform.levelCount());
+    QCOMPARE(loaded.bucketFrames(0), waveform.bucketFrames(0));
+
+    for (int channel = 0; channel < 2; ++channel) {
+        for (int count : { 625, 100, 7, 1 }) {
+            const auto expected = waveform.framePeaks(channel, 0, FrameCount, count);
+            const auto peaks = loaded.framePeaks(channel, 0, FrameCount, count);
+            QCOMPARE(peaks.size(), expected.size());
+            for (int i = 0; i < count; ++i) {
+                QVERIFY(qAbs(peaks.at(i).min - expected.at(i).min) <= 1.f / 32767);
+                QVERIFY(qAbs(peaks.at(i).max - expected.at(i).max) <= 1.f / 32767);
+                QVERIFY(qAbs(peaks.at(i).rms - expected.at(i).rms) <= 2.f / 32767);
+            }
+        }
+    }
+}
+
+void tst_QAudioWaveform::loadOtherSource()
+{
+    const QString audioFileName = tempDir.filePath(QLatin1String("source.wav"));
+    QFile audioFile(audioFileName);
+    QVERIFY(audioFile.open(QIODevice::WriteOnly));
+    QVERIFY(audioFile.write(waveFile(testSamples())) > 0);
+    audioFile.close();
+
+    QVERIFY(audioFile.open(QIODevice::ReadOnly));
+    QWaveDecoder decoder(&audioFile);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QAudioWaveform waveform;
+    waveform.setFramesPerBucket(FramesPerBucket);
+    QVERIFY(analyzeWave(waveform, decoder));
+    decoder.close();
+    audioFile.close();
+
+    const QString fileName = QAudioWaveform::sidecarFileName(audioFileName);
+    QVERIFY(waveform.save(fileName));
+
+    QAudioWaveform loaded;
+    QVERIFY(loaded.load(fileName, audioFileName));
+    QVERIFY(loaded.isReady());
+
+    // A rewritten file, or another one, is not described by the overview
+    QVERIFY(audioFile.open(QIODevice::WriteOnly));
+    QVERIFY(audioFile.write(waveFile(testSamples().mid(0, 2000))) > 0);
+    audioFile.close();
+    QVERIFY(!loaded.load(fileName, audioFileName));
+    QVERIFY(!loaded.isReady());
+    QVERIFY(!loaded.load(fileName, tempDir.filePath(QLatin1String("missing.wav"))));
+
+    // Without a file name the overview is taken as it is
+    QVERIFY(loaded.load(fileName));
+
+    // Neither is an overview of a stream
+    QBuffer buffer;
+    buffer.setData(waveFile(testSamples()));
+    buffer.open(QIODevice::ReadOnly);
+    QWaveDecoder bufferDecoder(&buffer);
+    QVERIFY(bufferDecoder.open(QIODevice::ReadOnly));
+    QVERIFY(analyzeWave(waveform, bufferDecoder));
+    QVERIFY(waveform.save(fileName));
+    QVERIFY(!loaded.load(fileName, audioFileName));
+}
+
+void tst_QAudioWaveform::loadInvalid()
+{
+    QAudioWaveform waveform;
+    QVERIFY(!waveform.load(tempDir.filePath(QLatin1String("missing.peaks"))));
+    QVERIFY(!waveform.isReady());
+
+    QBuffer garbage;
+    garbage.setData(QByteArray(100, 'x'));
+    garbage.open(QIODevice::ReadOnly);
+    QVERIFY(!waveform.load(&garbage));
+    QVERIFY(!waveform.isReady());
+
+    // A valid header with the bucket data cut off
+    QByteArray truncated;
+    {
+        QDataStream stream(&truncated, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << quint32(0x4d465751) << quint16(2) << quint16(1) << qint32(8000)
+               << qint32(256) << qint64(1000000) << quint16(QAudioFormat::Int16)
+               << qint64(-1) << qint64(0);
+    }
+    QBuffer buffer(&truncated);
+    buffer.open(QIODevice::ReadOnly);
+    QVERIFY(!waveform.load(&buffer));
+    QVERIFY(!waveform.isReady());
+
+    // Version 1 did not record the source
+    QByteArray version1;
+    {
+        QDataStream stream(&version1, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << quint32(0x4d465751) << quint16(1) << quint16(1) << qint32(8000)
+               << qint32(256) << qint64(256);
+        stream << qint16(-100) << qint16(100) << qint16(50);
+    }
+    QBuffer oldBuffer(&version1);
+    oldBuffer.open(QIODevice::ReadOnly);
+    QVERIFY(!waveform.load(&oldBuffer));
+    QVERIFY(!waveform.isReady());
+}
+
+void tst_QAudioWaveform::cancel()
+{
+    QBuffer buffer;
+    buffer.setData(waveFile(testSamples()));
+    buffer.open(QIODevice::ReadOnly);
+    QWaveDecoder decoder(&buffer);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+
+    QAudioWaveform waveform;
+    QSignalSpy readySpy(&waveform, &QAudioWaveform::ready);
+    QSignalSpy errorSpy(&waveform, &QAudioWaveform::error);
+    QVERIFY(waveform.analyze(&decoder));
+    QVERIFY(waveform.isRunning());
+    waveform.cancel();
+    QVERIFY(!waveform.isRunning());
+
+    QTest::qWait(100);
+    QCOMPARE(readySpy.count(), 0);
+    QCOMPARE(errorSpy.count(), 0);
+    QVERIFY(!waveform.isReady());
+}
+
+void tst_QAudioWaveform::closeMapped_data()
+{
+    QTest::addColumn<bool>("closeFile");
+    QTest::addColumn<bool>("destroyFile");
+
+    QTest::newRow("close decoder") << false << false;
+    QTest::newRow("close file") << true << false;
+    QTest::newRow("destroy file") << true << true;
+}
+
+void tst_QAudioWaveform::closeMapped()
+{
+    QFETCH(bool, closeFile);
+    QFETCH(bool, destroyFile);
+
+    auto device = waveDevice(waveFile(testSamples()), true, tempDir.path());
+    QVERIFY(device);
+    QWaveDecoder decoder(device.get());
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QVERIFY(!decoder.mappedData().isEmpty());
+
+    QAudioWaveform waveform;
+    QSignalSpy readySpy(&waveform, &QAudioWaveform::ready);
+    QSignalSpy errorSpy(&waveform, &QAudioWaveform::error);
+    QVERIFY(waveform.analyze(&decoder));
+    if (destroyFile)
+        device.reset();
+    else if (closeFile)
+        device->close();
+    else
+        decoder.close();
+    QVERIFY(!waveform.isRunning());
+    QCOMPARE(errorSpy.count(), 1);
+
+    QTest::qWait(100);
+    QCOMPARE(readySpy.count(), 0);
+}
+
+void tst_QAudioWaveform::reduceKernels_data()
+{
+    QTest::addColumn<int>("count");
+
+    // Shorter than, a multiple of and a remainder past the vector widths
+    for (int count : { 1, 3, 4, 7, 8, 9, 33, 1000 })
+        QTest::addRow("%d", count) << count;
+}
+
+void tst_QAudioWaveform::reduceKernels()
+{
+    QFETCH(int, count);
+
+    typedef void (QT_FASTCALL *ReducePeaksFunc)(const float *, qsizetype, float *, float *, float *);
+    QList<QPair<const char *, ReducePeaksFunc>> kernels;
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    if (qCpuHasFeature(SSE2))
+        kernels.append({ "SSE2", qt_reduce_peaks_sse2 });
+#endif
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+    if (qCpuHasFeature(AVX2))
+        kernels.append({ "AVX2", qt_reduce_peaks_avx2 });
+#endif
+    if (kernels.isEmpty())
+        QSKIP("No SIMD kernel for this CPU");
+
+    std::mt19937 generator(count);
+    std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+    QList<float> samples(count);
+    for (float &sample : samples)
+        sample = distribution(generator);
+    // The extremes in the last element catch a dropped tail
+    samples.last() = 1.5f;
+
+    float min = 0;
+    float max = 0;
+    float sumSquares = 0;
+    qt_reduce_peaks(samples.constData(), count, &min, &max, &sumSquares);
+    QCOMPARE(max, 1.5f);
+
+    for (const auto &kernel : qAsConst(kernels)) {
+        float kernelMin = 0;
+        float kernelMax = 0;
+        float kernelSumSquares = 0;
+        kernel.second(samples.constData(), count, &kernelMin, &kernelMax, &kernelSumSquares);
+        QVERIFY2(kernelMin == min, kernel.first);
+        QVERIFY2(kernelMax == max, kernel.first);
+        // The vector kernels add in a different order
+        QVERIFY2(qAbs(kernelSumSquares - sumSquares) <= sumSquares * 1e-5f, kernel.first);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioWaveform)
+
+#include "tst_qaudiowaveform.moc"
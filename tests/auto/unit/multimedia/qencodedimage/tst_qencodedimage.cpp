@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <QtCore/qbuffer.h>
+#include <QtGui/qimage.h>
+#include <qmediametadata.h>
+#include <private/qencodedimage_p.h>
+
+QT_USE_NAMESPACE
+
+class tst_QEncodedImage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void null();
+    void decode();
+    void scaledDecode();
+    void cacheLimit();
+    void variantConversion();
+    void asyncDecode();
+    void invalidData();
+
+private:
+    QByteArray png;
+};
+
+void tst_QEncodedImage::initTestCase()
+{
+    QImage image(400, 200, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(image.save(&buffer, "PNG"));
+}
+
+void tst_QEncodedImage::null()
+{
+    QEncodedImage image;
+    QVERIFY(image.isNull());
+    QVERIFY(image.image().isNull());
+    QVERIFY(image.decode().result().isNull());
+}
+
+void tst_QEncodedImage::decode()
+{
+    QEncodedImage encoded(png, "image/png");
+    QVERIFY(!encoded.isNull());
+    QCOMPARE(encoded.data(), png);
+    QCOMPARE(encoded.mimeType(), "image/png");
+
+    QImage image = encoded.image();
+    QCOMPARE(image.size(), QSize(400, 200));
+    QCOMPARE(image.pixelColor(10, 10), QColor(Qt::red));
+
+    // decoded once and shared with copies
+    QEncodedImage copy = encoded;
+    QCOMPARE(copy.image().cacheKey(), image.cacheKey());
+    QCOMPARE(copy, encoded);
+}
+
+void tst_QEncodedImage::scaledDecode()
+{
+    QEncodedImage encoded(png, "image/png");
+    QCOMPARE(encoded.image(QSize(100, 100)).size(), QSize(100, 50));
+    // never scaled up
+    QCOMPARE(encoded.image(QSize(800, 800)).size(), QSize(400, 200));
+    QCOMPARE(encoded.image().size(), QSize(400, 200));
+}
+
+void tst_QEncodedImage::cacheLimit()
+{
+    QEncodedImage encoded(png, "image/png");
+    const qint64 full = encoded.image().cacheKey();
+    const qint64 small = encoded.image(QSize(100, 100)).cacheKey();
+    QCOMPARE(encoded.image().cacheKey(), full);
+    QCOMPARE(encoded.image(QSize(100, 100)).cacheKey(), small);
+
+    // a third size pushes out the oldest one
+    QCOMPARE(encoded.image(QSize(50, 50)).size(), QSize(50, 25));
+    QCOMPARE(encoded.image(QSize(100, 100)).cacheKey(), small);
+    QVERIFY(encoded.image().cacheKey() != full);
+}
+
+void tst_QEncodedImage::variantConversion()
+{
+    QVariant value = QVariant::fromValue(QEncodedImage(png, "image/png"));
+    QVERIFY(value.canConvert<QImage>());
+    QCOMPARE(value.value<QImage>().size(), QSize(400, 200));
+
+    // meta data hands out the decoded image
+    QMediaMetaData metaData;
+    metaData.insert(QMediaMetaData::CoverArtImage, value);
+    const QVariant coverArt = metaData.value(QMediaMetaData::CoverArtImage);
+    QCOMPARE(coverArt.metaType(), QMetaType::fromType<QImage>());
+    QCOMPARE(coverArt.value<QImage>().size(), QSize(400, 200));
+}
+
+void tst_QEncodedImage::asyncDecode()
+{
+    QEncodedImage encoded(png, "image/png");
+    QFuture<QImage> future = encoded.decode(QSize(40, 40));
+    future.waitForFinished();
+    QCOMPARE(future.result().size(), QSize(40, 20));
+
+    // now cached
+    future = encoded.decode(QSize(40, 40));
+    QVERIFY(future.isFinished());
+    QCOMPARE(future.result().size(), QSize(40, 20));
+}
+
+void tst_QEncodedImage::invalidData()
+{
+    QEncodedImage encoded("not an image", "image/png");
+    QVERIFY(!encoded.isNull());
+    QVERIFY(encoded.image().isNull());
+}
+
+QTEST_GUILESS_MAIN(tst_QEncodedImage)
+
+#include "tst_qencodedimage.moc"
@@ -63,6 +63,7 @@ private slots:
     void imageExposed();
     void imageSaved();
     void readyForCaptureChanged();
+    void burstUnsupported();
 
 private:
     QMockIntegration *mockIntegration;
@@ -329,6 +330,43 @@ void tst_QImageCapture::readyForCaptureChanged()
     spy.clear();
 }
 
+void tst_QImageCapture::burstUnsupported()
+{
+    QMediaCaptureSession session;
+    QCamera camera;
+    QImageCapture imageCapture;
+    session.setCamera(&camera);
+    session.setImageCapture(&imageCapture);
+
+    QSignalSpy spy(&imageCapture, SIGNAL(errorOccurred(int,QImageCapture::Error,QString)));
+    // like single captures, bursts need an active camera
+    QCOMPARE(imageCapture.captureBurst(5), -1);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(qvariant_cast<QImageCapture::Error>(spy.at(0).at(1)), QImageCapture::NotReadyError);
+    QCOMPARE(imageCapture.captureBurstToFile(5, 2), -1);
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(qvariant_cast<QImageCapture::Error>(spy.at(1).at(1)), QImageCapture::NotReadyError);
+    spy.clear();
+
+    camera.start();
+    QTRY_VERIFY(imageCapture.isReadyForCapture());
+
+    // the mock backend encodes one image at a time
+    QSignalSpy pendingSpy(&imageCapture, SIGNAL(maximumPendingImagesChanged()));
+    QCOMPARE(imageCapture.maximumPendingImages(), 1);
+    imageCapture.setMaximumPendingImages(4);
+    QCOMPARE(imageCapture.maximumPendingImages(), 1);
+    QCOMPARE(pendingSpy.count(), 0);
+
+    QCOMPARE(imageCapture.captureBurst(5), -1);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(qvariant_cast<QImageCapture::Error>(spy.at(0).at(1)), QImageCapture::NotSupportedFeatureError);
+
+    QCOMPARE(imageCapture.captureBurstToFile(5, 2), -1);
+    QTRY_COMPARE(spy.count(), 2);
+    camera.stop();
+}
+
 QTEST_MAIN(tst_QImageCapture)
 
 #include "tst_qimagecapture.moc"
@@ -0,0 +1,185 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qmediametadatascanner.h>
+#include "qmockintegration_p.h"
+#include "qmockmetadatascanner.h"
+
+QT_USE_NAMESPACE
+
+class tst_QMediaMetaDataScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void scan();
+    void errors();
+    void concurrency();
+    void cancel();
+    void cancelThenRescan();
+    void destroyWhileScanning();
+
+private:
+    QMockIntegration mockIntegration;
+};
+
+void tst_QMediaMetaDataScanner::scan()
+{
+    QMediaMetaDataScanner scanner;
+    QVERIFY(scanner.isSupported());
+    QCOMPARE(scanner.pendingScans(), 0);
+
+    QSignalSpy scanned(&scanner, &QMediaMetaDataScanner::scanned);
+    QSignalSpy finished(&scanner, &QMediaMetaDataScanner::finished);
+
+    scanner.scan(QUrl(QStringLiteral("file:///music/a.ogg")));
+    QCOMPARE(scanner.pendingScans(), 1);
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(scanner.pendingScans(), 0);
+
+    QCOMPARE(scanned.count(), 1);
+    const auto arguments = scanned.first();
+    QCOMPARE(arguments.at(0).toUrl(), QUrl(QStringLiteral("file:///music/a.ogg")));
+    const auto metaData = arguments.at(1).value<QMediaMetaData>();
+    QCOMPARE(metaData.stringValue(QMediaMetaData::Title), QStringLiteral("a.ogg"));
+    QCOMPARE(metaData.value(QMediaMetaData::Duration).toLongLong(), 1000);
+    QCOMPARE(arguments.at(2).value<QList<QMediaMetaData>>().size(), 1);
+    QCOMPARE(arguments.at(3).value<QList<QMediaMetaData>>().size(), 0);
+    QCOMPARE(arguments.at(4).value<QList<QMediaMetaData>>().size(), 0);
+}
+
+void tst_QMediaMetaDataScanner::errors()
+{
+    QMediaMetaDataScanner scanner;
+    QSignalSpy scanned(&scanner, &QMediaMetaDataScanner::scanned);
+    QSignalSpy errors(&scanner, &QMediaMetaDataScanner::error);
+    QSignalSpy finished(&scanner, &QMediaMetaDataScanner::finished);
+
+    scanner.scan({ QUrl(QStringLiteral("broken:///a")), QUrl(QStringLiteral("file:///b.ogg")) });
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(scanned.count(), 1);
+    QCOMPARE(errors.count(), 1);
+    QCOMPARE(errors.first().at(0).toUrl(), QUrl(QStringLiteral("broken:///a")));
+    QCOMPARE(errors.first().at(1).value<QMediaMetaDataScanner::Error>(), QMediaMetaDataScanner::ResourceError);
+}
+
+void tst_QMediaMetaDataScanner::concurrency()
+{
+    QMediaMetaDataScanner scanner;
+    auto *mock = mockIntegration.lastMetaDataScanner();
+    QVERIFY(mock);
+
+    QSignalSpy maximumChanged(&scanner, &QMediaMetaDataScanner::maximumConcurrentScansChanged);
+    scanner.setMaximumConcurrentScans(3);
+    QCOMPARE(scanner.maximumConcurrentScans(), 3);
+    QCOMPARE(maximumChanged.count(), 1);
+    scanner.setMaximumConcurrentScans(0);
+    QCOMPARE(scanner.maximumConcurrentScans(), 3);
+
+    QSignalSpy scanned(&scanner, &QMediaMetaDataScanner::scanned);
+    QSignalSpy finished(&scanner, &QMediaMetaDataScanner::finished);
+
+    QList<QUrl> urls;
+    for (int i = 0; i < 20; ++i)
+        urls.append(QUrl::fromLocalFile(QStringLiteral("/music/%1.ogg").arg(i)));
+    scanner.scan(urls);
+    QCOMPARE(scanner.pendingScans(), 20);
+
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(scanned.count(), 20);
+    QVERIFY(mock->maximumRunning.loadAcquire() <= 3);
+}
+
+void tst_QMediaMetaDataScanner::cancel()
+{
+    QMediaMetaDataScanner scanner;
+    mockIntegration.lastMetaDataScanner()->scanDuration = 100;
+    scanner.setMaximumConcurrentScans(1);
+
+    QSignalSpy scanned(&scanner, &QMediaMetaDataScanner::scanned);
+    QSignalSpy finished(&scanner, &QMediaMetaDataScanner::finished);
+
+    scanner.scan({ QUrl(QStringLiteral("file:///a.ogg")), QUrl(QStringLiteral("file:///b.ogg")) });
+    scanner.cancel();
+    // the running scan finishes, but is not reported
+    QCOMPARE(scanner.pendingScans(), 1);
+    QTRY_COMPARE(scanner.pendingScans(), 0);
+    QTest::qWait(50);
+    QCOMPARE(scanned.count(), 0);
+    QCOMPARE(finished.count(), 0);
+
+    // and the scanner can be used again
+    scanner.scan(QUrl(QStringLiteral("file:///c.ogg")));
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(scanned.count(), 1);
+}
+
+void tst_QMediaMetaDataScanner::cancelThenRescan()
+{
+    QMediaMetaDataScanner scanner;
+    mockIntegration.lastMetaDataScanner()->scanDuration = 30;
+    scanner.setMaximumConcurrentScans(2);
+
+    QSignalSpy scanned(&scanner, &QMediaMetaDataScanner::scanned);
+    QSignalSpy finished(&scanner, &QMediaMetaDataScanner::finished);
+
+    scanner.scan(QUrl(QStringLiteral("file:///slow.ogg")));
+    scanner.cancel();
+    scanner.scan(QUrl(QStringLiteral("file:///c.ogg")));
+    QCOMPARE(scanner.pendingScans(), 2);
+
+    // the new scan is done first, the canceled one is still running
+    QTRY_COMPARE(scanned.count(), 1);
+    QCOMPARE(scanner.pendingScans(), 1);
+    QCOMPARE(finished.count(), 0);
+
+    // the queue runs empty when the canceled scan finishes
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(scanner.pendingScans(), 0);
+    QCOMPARE(scanned.count(), 1);
+    QCOMPARE(scanned.first().at(0).toUrl(), QUrl(QStringLiteral("file:///c.ogg")));
+    QTest::qWait(50);
+    QCOMPARE(finished.count(), 1);
+}
+
+void tst_QMediaMetaDataScanner::destroyWhileScanning()
+{
+    auto *scanner = new QMediaMetaDataScanner;
+    QList<QUrl> urls;
+    for (int i = 0; i < 20; ++i)
+        urls.append(QUrl::fromLocalFile(QStringLiteral("/music/%1.ogg").arg(i)));
+    scanner->scan(urls);
+    delete scanner;
+}
+
+QTEST_GUILESS_MAIN(tst_QMediaMetaDataScanner)
+
+#include "tst_qmediametadatascanner.moc"
@@ -71,6 +71,9 @@ private slots:
 
     void testVideoSettingsQuality();
     void testVideoSettingsEncodingMode();
+    void testSegmentSettings();
+    void testPreRecordDuration();
+    void testOutputDeviceUnsupported();
 
     void testApplicationInative();
 
@@ -459,6 +462,69 @@ void tst_QMediaRecorder::testVideoSettingsEncodingMode()
     QCOMPARE(recorder.encodingMode(), QMediaRecorder::AverageBitRateEncoding);
 }
 
+void tst_QMediaRecorder::testSegmentSettings()
+{
+    QMediaRecorder recorder;
+    QSignalSpy durationSpy(&recorder, &QMediaRecorder::maximumSegmentDurationChanged);
+    QSignalSpy sizeSpy(&recorder, &QMediaRecorder::maximumSegmentSizeChanged);
+
+    /* Recording is not split by default */
+    QCOMPARE(recorder.maximumSegmentDuration(), qint64(0));
+    QCOMPARE(recorder.maximumSegmentSize(), qint64(0));
+
+    recorder.setMaximumSegmentDuration(60000);
+    QCOMPARE(recorder.maximumSegmentDuration(), qint64(60000));
+    QCOMPARE(durationSpy.count(), 1);
+    recorder.setMaximumSegmentDuration(60000);
+    QCOMPARE(durationSpy.count(), 1);
+
+    recorder.setMaximumSegmentSize(Q_INT64_C(100) * 1024 * 1024);
+    QCOMPARE(recorder.maximumSegmentSize(), Q_INT64_C(100) * 1024 * 1024);
+    QCOMPARE(sizeSpy.count(), 1);
+
+    /* Negative values disable splitting */
+    recorder.setMaximumSegmentDuration(-1);
+    QCOMPARE(recorder.maximumSegmentDuration(), qint64(0));
+    recorder.setMaximumSegmentSize(-1);
+    QCOMPARE(recorder.maximumSegmentSize(), qint64(0));
+    QCOMPARE(durationSpy.count(), 2);
+    QCOMPARE(sizeSpy.count(), 2);
+}
+
+void tst_QMediaRecorder::testPreRecordDuration()
+{
+    QMediaRecorder recorder;
+    QSignalSpy spy(&recorder, &QMediaRecorder::preRecordDurationChanged);
+
+    QCOMPARE(recorder.preRecordDuration(), qint64(0));
+
+    recorder.setPreRecordDuration(10000);
+    QCOMPARE(recorder.preRecordDuration(), qint64(10000));
+    QCOMPARE(spy.count(), 1);
+    recorder.setPreRecordDuration(10000);
+    QCOMPARE(spy.count(), 1);
+
+    recorder.setPreRecordDuration(-5);
+    QCOMPARE(recorder.preRecordDuration(), qint64(0));
+    QCOMPARE(spy.count(), 2);
+}
+
+void tst_QMediaRecorder::testOutputDeviceUnsupported()
+{
+    QSignalSpy spy(encoder, &QMediaRecorder::errorOccurred);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    /* The mock backend can only record to locations */
+    encoder->setOutputDevice(&buffer);
+    QCOMPARE(encoder->outputDevice(), nullptr);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<QMediaRecorder::Error>(), QMediaRecorder::ResourceError);
+
+    encoder->setOutputDevice(nullptr);
+    QCOMPARE(spy.count(), 1);
+}
+
 void tst_QMediaRecorder::testApplicationInative()
 {
     QMediaCaptureSession session;
@@ -33,7 +33,9 @@
 #include <qvideoframe.h>
 #include <qvideoframeformat.h>
 #include "private/qmemoryvideobuffer_p.h"
+#include "private/qvideoframepool_p.h"
 #include <QtGui/QImage>
+#include <QtGui/QPainter>
 #include <QtCore/QPointer>
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
 
@@ -86,6 +88,12 @@ private slots:
     void image();
 
     void emptyData();
+
+    void paintCachesImages();
+    void paintAfterWrite();
+
+    void poolRecyclesMemory();
+    void poolLimits();
 };
 
 class QtTestDummyVideoBuffer : public QObject, public QAbstractVideoBuffer
@@ -1005,6 +1013,157 @@ void tst_QVideoFrame::emptyData()
     QVERIFY(!f.map(QVideoFrame::ReadOnly));
 }
 
+static void fillFrame(QVideoFrame &frame, const QList<uchar> &pixels)
+{
+    // Y8, one byte per pixel
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    for (int y = 0; y < frame.height(); ++y)
+        memcpy(frame.bits(0) + y * frame.bytesPerLine(0), pixels.constData() + y * frame.width(), frame.width());
+    frame.unmap();
+}
+
+static QImage paintFrame(QVideoFrame &frame, const QSize &size, bool smooth = false)
+{
+    QImage target(size, QImage::Format_RGB32);
+    target.fill(Qt::red);
+    QPainter painter(&target);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+    frame.paint(&painter, QRectF(QPointF(), size), {});
+    return target;
+}
+
+static int distinctColors(const QImage &image)
+{
+    QSet<QRgb> colors;
+    for (int y = 0; y < image.height(); ++y)
+        for (int x = 0; x < image.width(); ++x)
+            colors.insert(image.pixel(x, y));
+    return colors.size();
+}
+
+void tst_QVideoFrame::paintCachesImages()
+{
+    QVideoFrame frame(QVideoFrameFormat(QSize(2, 2), QVideoFrameFormat::Format_Y8));
+    fillFrame(frame, { 0, 255, 255, 0 });
+
+    // repainting gives the same result as painting the first time
+    const QImage unscaled = paintFrame(frame, QSize(2, 2));
+    QCOMPARE(distinctColors(unscaled), 2);
+    QCOMPARE(paintFrame(frame, QSize(2, 2)), unscaled);
+
+    const QImage fast = paintFrame(frame, QSize(8, 8));
+    QCOMPARE(distinctColors(fast), 2);
+    QCOMPARE(paintFrame(frame, QSize(8, 8)), fast);
+
+    // the scaled image isn't reused for another transformation mode
+    const QImage smooth = paintFrame(frame, QSize(8, 8), true);
+    QVERIFY(distinctColors(smooth) > 2);
+    QCOMPARE(paintFrame(frame, QSize(8, 8), true), smooth);
+    QCOMPARE(paintFrame(frame, QSize(8, 8)), fast);
+
+    // nor for another size
+    QCOMPARE(paintFrame(frame, QSize(4, 4)).size(), QSize(4, 4));
+    QCOMPARE(paintFrame(frame, QSize(8, 8)), fast);
+}
+
+void tst_QVideoFrame::paintAfterWrite()
+{
+    const QSize size(4, 4);
+    QVideoFrame frame(QVideoFrameFormat(size, QVideoFrameFormat::Format_Y8));
+    fillFrame(frame, QList<uchar>(16, 0));
+    const QImage black = paintFrame(frame, size);
+    const QImage blackScaled = paintFrame(frame, size * 2);
+
+    fillFrame(frame, QList<uchar>(16, 255));
+    const QImage white = paintFrame(frame, size);
+    QVERIFY(white != black);
+    QVERIFY(qGray(white.pixel(0, 0)) > qGray(black.pixel(0, 0)));
+    QVERIFY(paintFrame(frame, size * 2) != blackScaled);
+
+    // writes through a mapping that exists while the frame is painted are
+    // seen once the frame is unmapped
+    QVideoFrame copy = frame;
+    QVERIFY(copy.map(QVideoFrame::ReadWrite));
+    paintFrame(frame, size);
+    memset(copy.bits(0), 0, copy.mappedBytes(0));
+    paintFrame(frame, size);
+    copy.unmap();
+    QCOMPARE(paintFrame(frame, size), black);
+    QCOMPARE(paintFrame(frame, size * 2), blackScaled);
+}
+
+void tst_QVideoFrame::poolRecyclesMemory()
+{
+    QVideoFramePool pool;
+    QVideoFrameFormat format(QSize(640, 480), QVideoFrameFormat::Format_NV12);
+
+    QVideoFrame frame = pool.allocate(format);
+    QVERIFY(frame.isValid());
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    const uchar *bits = frame.bits(0);
+    QCOMPARE(quintptr(bits) % QVideoFramePool::Alignment, quintptr(0));
+    QCOMPARE(frame.bytesPerLine(0), 640);
+    QCOMPARE(frame.mappedBytes(0) + frame.mappedBytes(1), 640 * 480 * 3 / 2);
+    frame.unmap();
+
+    QVideoFrame copy = frame;
+    frame = QVideoFrame();
+    QCOMPARE(pool.freeBuffers(), 0);
+    copy = QVideoFrame();
+    QCOMPARE(pool.freeBuffers(), 1);
+
+    // a frame of the same size gets the same memory back
+    frame = pool.allocate(format);
+    QCOMPARE(pool.freeBuffers(), 0);
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+    QCOMPARE(frame.bits(0), bits);
+    frame.unmap();
+
+    // and frames outliving their pool free their memory themselves
+    {
+        QVideoFramePool temporary;
+        copy = temporary.allocate(format);
+    }
+    QVERIFY(copy.isValid());
+    copy = QVideoFrame();
+
+    QCOMPARE(pool.allocate(QVideoFrameFormat()).isValid(), false);
+
+    // bare buffers come from and return to the same free list
+    frame = QVideoFrame();
+    QCOMPARE(pool.freeBuffers(), 1);
+    QAbstractVideoBuffer *buffer = pool.allocateBuffer(format);
+    QVERIFY(buffer);
+    QCOMPARE(pool.freeBuffers(), 0);
+    QCOMPARE(buffer->map(QVideoFrame::ReadOnly).data[0], bits);
+    buffer->unmap();
+    delete buffer;
+    QCOMPARE(pool.freeBuffers(), 1);
+    QCOMPARE(pool.allocateBuffer(QVideoFrameFormat()), nullptr);
+}
+
+void tst_QVideoFrame::poolLimits()
+{
+    QVideoFramePool pool;
+    QVideoFrameFormat format(QSize(64, 64), QVideoFrameFormat::Format_ARGB8888);
+
+    QList<QVideoFrame> frames;
+    for (int i = 0; i < 4; ++i)
+        frames.append(pool.allocate(format));
+
+    pool.setMaximumFreeBuffers(2);
+    frames.clear();
+    QCOMPARE(pool.freeBuffers(), 2);
+    QCOMPARE(pool.freeBytes(), 2 * 64 * 64 * 4);
+
+    pool.setMaximumFreeBytes(64 * 64 * 4);
+    QCOMPARE(pool.freeBuffers(), 1);
+
+    pool.clear();
+    QCOMPARE(pool.freeBuffers(), 0);
+    QCOMPARE(pool.freeBytes(), 0);
+}
+
 QTEST_MAIN(tst_QVideoFrame)
 
 #include "tst_qvideoframe.moc"
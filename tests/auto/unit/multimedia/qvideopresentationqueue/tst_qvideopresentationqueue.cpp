@@ -0,0 +1,239 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qvideoframe.h>
+#include <qvideoframeformat.h>
+#include <private/qvideopresentationqueue_p.h>
+
+QT_USE_NAMESPACE
+
+class tst_QVideoPresentationQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyQueue();
+    void framesWithoutStartTime();
+    void futureFramesWait();
+    void seekRestartsTimeline();
+    void shortSeeks();
+    void playbackRate_data();
+    void playbackRate();
+    void clear();
+
+private:
+    static QVideoFrame frameAt(qint64 startTime, qint64 endTime = -1)
+    {
+        QVideoFrame frame(QVideoFrameFormat(QSize(16, 16), QVideoFrameFormat::Format_ARGB8888));
+        frame.setStartTime(startTime);
+        frame.setEndTime(endTime);
+        return frame;
+    }
+};
+
+void tst_QVideoPresentationQueue::emptyQueue()
+{
+    QVideoPresentationQueue queue;
+    QVideoFrame frame;
+    QVERIFY(!queue.hasPendingFrames());
+    QVERIFY(!queue.takeFrame(&frame));
+    QVERIFY(!frame.isValid());
+}
+
+void tst_QVideoPresentationQueue::framesWithoutStartTime()
+{
+    QVideoPresentationQueue queue;
+    QVideoFrame frames[] = { frameAt(-1), frameAt(-1), frameAt(-1) };
+    for (const auto &frame : frames)
+        queue.enqueue(frame);
+
+    // only the latest one is worth showing
+    QVideoFrame frame;
+    QVERIFY(queue.takeFrame(&frame));
+    QCOMPARE(frame, frames[2]);
+    QVERIFY(!queue.hasPendingFrames());
+
+    auto statistics = queue.statistics();
+    QCOMPARE(statistics.presentedFrames, 1);
+    QCOMPARE(statistics.droppedFrames, 2);
+
+    queue.resetStatistics();
+    statistics = queue.statistics();
+    QCOMPARE(statistics.presentedFrames, 0);
+    QCOMPARE(statistics.droppedFrames, 0);
+}
+
+void tst_QVideoPresentationQueue::futureFramesWait()
+{
+    QVideoPresentationQueue queue;
+    queue.setRefreshRate(60);
+    QCOMPARE(queue.refreshRate(), 60.);
+
+    // two frames of a stream at 2 fps, delivered at once
+    const QVideoFrame first = frameAt(0, 500000);
+    const QVideoFrame second = frameAt(500000, 1000000);
+    queue.enqueue(first, 0);
+    queue.enqueue(second, 0);
+
+    QVideoFrame frame;
+    QVERIFY(queue.takeFrame(&frame, 0));
+    QCOMPARE(frame, first);
+
+    // the second frame is due about half a second later
+    QVERIFY(!queue.takeFrame(&frame, 0));
+    QVERIFY(!queue.takeFrame(&frame, 400000));
+    QCOMPARE(frame, first);
+    QVERIFY(queue.hasPendingFrames());
+
+    QVERIFY(queue.takeFrame(&frame, 500000));
+    QCOMPARE(frame, second);
+    QCOMPARE(queue.statistics().presentedFrames, 2);
+    QCOMPARE(queue.statistics().droppedFrames, 0);
+}
+
+void tst_QVideoPresentationQueue::seekRestartsTimeline()
+{
+    QVideoPresentationQueue queue;
+    const QVideoFrame beforeSeek = frameAt(0);
+    const QVideoFrame afterSeek = frameAt(60000000);
+    queue.enqueue(beforeSeek);
+    queue.enqueue(afterSeek);
+
+    QVideoFrame frame;
+    QVERIFY(queue.takeFrame(&frame));
+    QCOMPARE(frame, afterSeek);
+    QCOMPARE(queue.statistics().droppedFrames, 1);
+}
+
+void tst_QVideoPresentationQueue::shortSeeks()
+{
+    QVideoPresentationQueue queue;
+    queue.setRefreshRate(60);
+    const qint64 frameDuration = 33333;
+
+    // play a few frames at 30 fps
+    QVideoFrame frame;
+    qint64 time = 0;
+    for (int i = 0; i < 10; ++i, time += frameDuration) {
+        queue.enqueue(frameAt(i * frameDuration, (i + 1) * frameDuration), time);
+        QVERIFY(queue.takeFrame(&frame, time));
+    }
+
+    // a seek by less than a second while playing is shown right away
+    const QVideoFrame forward = frameAt(600000, 600000 + frameDuration);
+    queue.enqueue(forward, time);
+    QVERIFY(queue.takeFrame(&frame, time));
+    QCOMPARE(frame, forward);
+
+    // and so are seeks while paused, in both directions
+    time += 2000000;
+    const QVideoFrame pausedForward = frameAt(900000, 900000 + frameDuration);
+    queue.enqueue(pausedForward, time);
+    QVERIFY(queue.takeFrame(&frame, time));
+    QCOMPARE(frame, pausedForward);
+
+    time += 1000000;
+    const QVideoFrame pausedBackward = frameAt(700000, 700000 + frameDuration);
+    queue.enqueue(pausedBackward, time);
+    QVERIFY(queue.takeFrame(&frame, time));
+    QCOMPARE(frame, pausedBackward);
+
+    // playback continues on the new timeline
+    time += frameDuration;
+    const QVideoFrame next = frameAt(700000 + frameDuration, 700000 + 2 * frameDuration);
+    queue.enqueue(next, time);
+    QVERIFY(queue.takeFrame(&frame, time));
+    QCOMPARE(frame, next);
+    QCOMPARE(queue.statistics().droppedFrames, 0);
+}
+
+void tst_QVideoPresentationQueue::playbackRate_data()
+{
+    QTest::addColumn<qreal>("rate");
+
+    QTest::newRow("0.5") << 0.5;
+    QTest::newRow("1") << 1.;
+    QTest::newRow("2") << 2.;
+}
+
+void tst_QVideoPresentationQueue::playbackRate()
+{
+    QFETCH(qreal, rate);
+
+    QVideoPresentationQueue queue;
+    queue.setRefreshRate(60);
+    const qint64 refreshInterval = 16667;
+    const qint64 frameDuration = 33333;
+    const int frameCount = 90;
+
+    // Frames of a 30 fps stream arrive at the pace they are played at, in the
+    // middle of refresh intervals, and the output renders on every refresh.
+    QList<QVideoFrame> frames;
+    for (int i = 0; i < frameCount; ++i)
+        frames.append(frameAt(i * frameDuration, (i + 1) * frameDuration));
+
+    QList<QVideoFrame> shown;
+    int next = 0;
+    for (qint64 time = 0; shown.size() < frameCount && time < 10000000; time += refreshInterval) {
+        for (; next < frameCount; ++next) {
+            const qint64 arrivalTime = refreshInterval / 2 + qRound64(next * frameDuration / rate);
+            if (arrivalTime > time)
+                break;
+            queue.enqueue(frames.at(next), arrivalTime);
+        }
+        QVideoFrame frame;
+        if (queue.takeFrame(&frame, time))
+            shown.append(frame);
+    }
+
+    // every frame gets on screen in order, within a refresh or two of its arrival
+    QCOMPARE(shown, frames);
+    const auto statistics = queue.statistics();
+    QCOMPARE(statistics.droppedFrames, 0);
+    QVERIFY2(statistics.maximumLatency <= 2 * refreshInterval,
+             qPrintable(QString::number(statistics.maximumLatency)));
+}
+
+void tst_QVideoPresentationQueue::clear()
+{
+    QVideoPresentationQueue queue;
+    queue.enqueue(frameAt(0));
+    QVERIFY(queue.hasPendingFrames());
+
+    queue.clear();
+    QVERIFY(!queue.hasPendingFrames());
+    QVideoFrame frame;
+    QVERIFY(!queue.takeFrame(&frame));
+}
+
+QTEST_GUILESS_MAIN(tst_QVideoPresentationQueue)
+
+#include "tst_qvideopresentationqueue.moc"
@@ -35,6 +35,8 @@
 #include <QNetworkRequest>
 #include <QNetworkReply>
 
+#include <memory>
+
 class tst_QWaveDecoder : public QObject
 {
     Q_OBJECT
@@ -65,6 +67,22 @@ private slots:
 
     void readAllAtOnce();
     void readPerByte();
+
+    void int24_data();
+    void int24();
+    void floatSamples_data();
+    void floatSamples();
+    void rf64_data() { devices(); }
+    void rf64();
+    void seekToFrame_data() { devices(); }
+    void seekToFrame();
+    void mappedData();
+
+private:
+    static void devices();
+
+    QTemporaryDir tempDir;
+    std::unique_ptr<QIODevice> device;
 };
 
 void tst_QWaveDecoder::init()
@@ -83,6 +101,53 @@ void tst_QWaveDecoder::cleanupTestCase()
 {
 }
 
+// Writes a wave file around samples, which are already in the byte order of the file
+static QByteArray waveFile(const char *riffId, quint16 formatTag, int channels, int bits,
+                           const QByteArray &samples, bool extensible = false)
+{
+    const bool rf64 = qstrcmp(riffId, "RF64") == 0;
+    const int sampleRate = 8000;
+    const int blockAlign = channels * bits / 8;
+
+    QByteArray fmt;
+    {
+        QDataStream stream(&fmt, QIODevice::WriteOnly);
+        stream.setByteOrder(qstrcmp(riffId, "RIFX") == 0 ? QDataStream::BigEndian : QDataStream::LittleEndian);
+        stream << quint16(extensible ? 0xfffe : formatTag) << quint16(channels) << quint32(sampleRate)
+               << quint32(sampleRate * blockAlign) << quint16(blockAlign) << quint16(bits);
+        if (extensible) {
+            stream << quint16(22) << quint16(bits) << quint32(0) << formatTag << quint16(0);
+            stream.writeRawData("\x00\x00\x10\x00\x80\x00\x00\xaa\x00\x38\x9b\x71", 12);
+        }
+    }
+
+    QByteArray file;
+    QDataStream stream(&file, QIODevice::WriteOnly);
+    stream.setByteOrder(qstrcmp(riffId, "RIFX") == 0 ? QDataStream::BigEndian : QDataStream::LittleEndian);
+    const quint32 riffSize = 4 + (rf64 ? 36 : 0) + 8 + fmt.size() + 8 + samples.size();
+    stream.writeRawData(riffId, 4);
+    stream << (rf64 ? quint32(0xffffffff) : riffSize);
+    stream.writeRawData("WAVE", 4);
+    if (rf64) {
+        stream.writeRawData("ds64", 4);
+        stream << quint32(28) << quint64(riffSize) << quint64(samples.size())
+               << quint64(samples.size() / blockAlign) << quint32(0);
+    }
+    stream.writeRawData("fmt ", 4);
+    stream << quint32(fmt.size());
+    stream.writeRawData(fmt.constData(), fmt.size());
+    stream.writeRawData("data", 4);
+    stream << (rf64 ? quint32(0xffffffff) : quint32(samples.size()));
+    stream.writeRawData(samples.constData(), samples.size());
+    if (rf64) {
+        // must not be taken for sample data
+        stream.writeRawData("LIST", 4);
+        stream << quint32(4);
+        stream.writeRawData("INFO", 4);
+    }
+    return file;
+}
+
 static QString testFilePath(const char *filename)
 {
     QString path = QString("data/%1").arg(filename);
@@ -96,33 +161,33 @@ void tst_QWaveDecoder::file_data()
     QTest::addColumn<int>("channels");
     QTest::addColumn<int>("samplesize");
     QTest::addColumn<int>("samplerate");
-    QTest::addColumn<QAudioFormat::Endian>("byteorder");
-
-    QTest::newRow("File is empty")  << testFilePath("empty.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("File is one byte")  << testFilePath("onebyte.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("File is not a wav(text)")  << testFilePath("notawav.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("Wav file has no sample data")  << testFilePath("nosampledata.wav") << tst_QWaveDecoder::NoSampleData << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt fmt chunk descriptor")  << testFilePath("corrupt_fmtdesc_1_16_8000.le.wav") << tst_QWaveDecoder::FormatDescriptor << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt fmt string")  << testFilePath("corrupt_fmtstring_1_16_8000.le.wav") << tst_QWaveDecoder::FormatString << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt data chunk descriptor")  << testFilePath("corrupt_datadesc_1_16_8000.le.wav") << tst_QWaveDecoder::DataDescriptor << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-
-    QTest::newRow("File isawav_1_8_8000.wav") << testFilePath("isawav_1_8_8000.wav")  << tst_QWaveDecoder::None << 1 << 8 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_8_44100.wav") << testFilePath("isawav_1_8_44100.wav")  << tst_QWaveDecoder::None << 1 << 8 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_8_8000.wav") << testFilePath("isawav_2_8_8000.wav")  << tst_QWaveDecoder::None << 2 << 8 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_8_44100.wav") << testFilePath("isawav_2_8_44100.wav")  << tst_QWaveDecoder::None << 2 << 8 << 44100 << QAudioFormat::LittleEndian;
-
-    QTest::newRow("File isawav_1_16_8000_le.wav") << testFilePath("isawav_1_16_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_16_44100_le.wav") << testFilePath("isawav_1_16_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_16_8000_be.wav") << testFilePath("isawav_2_16_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 8000 << QAudioFormat::BigEndian;
-    QTest::newRow("File isawav_2_16_44100_be.wav") << testFilePath("isawav_2_16_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 44100 << QAudioFormat::BigEndian;
+    QTest::addColumn<QSysInfo::Endian>("byteorder");
+
+    QTest::newRow("File is empty")  << testFilePath("empty.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QSysInfo::LittleEndian;
+    QTest::newRow("File is one byte")  << testFilePath("onebyte.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QSysInfo::LittleEndian;
+    QTest::newRow("File is not a wav(text)")  << testFilePath("notawav.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QSysInfo::LittleEndian;
+    QTest::newRow("Wav file has no sample data")  << testFilePath("nosampledata.wav") << tst_QWaveDecoder::NoSampleData << -1 << -1 << -1 << QSysInfo::LittleEndian;
+    QTest::newRow("corrupt fmt chunk descriptor")  << testFilePath("corrupt_fmtdesc_1_16_8000.le.wav") << tst_QWaveDecoder::FormatDescriptor << -1 << -1 << -1 << QSysInfo::LittleEndian;
+    QTest::newRow("corrupt fmt string")  << testFilePath("corrupt_fmtstring_1_16_8000.le.wav") << tst_QWaveDecoder::FormatString << -1 << -1 << -1 << QSysInfo::LittleEndian;
+    QTest::newRow("corrupt data chunk descriptor")  << testFilePath("corrupt_datadesc_1_16_8000.le.wav") << tst_QWaveDecoder::DataDescriptor << -1 << -1 << -1 << QSysInfo::LittleEndian;
+
+    QTest::newRow("File isawav_1_8_8000.wav") << testFilePath("isawav_1_8_8000.wav")  << tst_QWaveDecoder::None << 1 << 8 << 8000 << QSysInfo::LittleEndian;
+    QTest::newRow("File isawav_1_8_44100.wav") << testFilePath("isawav_1_8_44100.wav")  << tst_QWaveDecoder::None << 1 << 8 << 44100 << QSysInfo::LittleEndian;
+    QTest::newRow("File isawav_2_8_8000.wav") << testFilePath("isawav_2_8_8000.wav")  << tst_QWaveDecoder::None << 2 << 8 << 8000 << QSysInfo::LittleEndian;
+    QTest::newRow("File isawav_2_8_44100.wav") << testFilePath("isawav_2_8_44100.wav")  << tst_QWaveDecoder::None << 2 << 8 << 44100 << QSysInfo::LittleEndian;
+
+    QTest::newRow("File isawav_1_16_8000_le.wav") << testFilePath("isawav_1_16_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 8000 << QSysInfo::LittleEndian;
+    QTest::newRow("File isawav_1_16_44100_le.wav") << testFilePath("isawav_1_16_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QSysInfo::LittleEndian;
+    QTest::newRow("File isawav_2_16_8000_be.wav") << testFilePath("isawav_2_16_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 8000 << QSysInfo::BigEndian;
+    QTest::newRow("File isawav_2_16_44100_be.wav") << testFilePath("isawav_2_16_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 44100 << QSysInfo::BigEndian;
     // The next file has extra data in the wave header.
-    QTest::newRow("File isawav_1_16_44100_le_2.wav") << testFilePath("isawav_1_16_44100_le_2.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QAudioFormat::LittleEndian;
+    QTest::newRow("File isawav_1_16_44100_le_2.wav") << testFilePath("isawav_1_16_44100_le_2.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QSysInfo::LittleEndian;
 
-    // 32 bit waves are not supported
-    QTest::newRow("File isawav_1_32_8000_le.wav") << testFilePath("isawav_1_32_8000_le.wav")  << tst_QWaveDecoder::FormatDescriptor << 1 << 32 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_32_44100_le.wav") << testFilePath("isawav_1_32_44100_le.wav")  << tst_QWaveDecoder::FormatDescriptor << 1 << 32 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_32_8000_be.wav") << testFilePath("isawav_2_32_8000_be.wav")  << tst_QWaveDecoder::FormatDescriptor << 2 << 32 << 8000 << QAudioFormat::BigEndian;
-    QTest::newRow("File isawav_2_32_44100_be.wav") << testFilePath("isawav_2_32_44100_be.wav")  << tst_QWaveDecoder::FormatDescriptor << 2 << 32 << 44100 << QAudioFormat::BigEndian;
+    // 32 bit waves use WAVE_FORMAT_EXTENSIBLE
+    QTest::newRow("File isawav_1_32_8000_le.wav") << testFilePath("isawav_1_32_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 32 << 8000 << QSysInfo::LittleEndian;
+    QTest::newRow("File isawav_1_32_44100_le.wav") << testFilePath("isawav_1_32_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 32 << 44100 << QSysInfo::LittleEndian;
+    QTest::newRow("File isawav_2_32_8000_be.wav") << testFilePath("isawav_2_32_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 32 << 8000 << QSysInfo::BigEndian;
+    QTest::newRow("File isawav_2_32_44100_be.wav") << testFilePath("isawav_2_32_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 32 << 44100 << QSysInfo::BigEndian;
 }
 
 void tst_QWaveDecoder::file()
@@ -132,7 +197,7 @@ void tst_QWaveDecoder::file()
     QFETCH(int, channels);
     QFETCH(int, samplesize);
     QFETCH(int, samplerate);
-    QFETCH(QAudioFormat::Endian, byteorder);
+    QFETCH(QSysInfo::Endian, byteorder);
 
     QFile stream;
     stream.setFileName(file);
@@ -143,6 +208,7 @@ void tst_QWaveDecoder::file()
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
     QSignalSpy parsingErrorSpy(&waveDecoder, SIGNAL(parsingError()));
+    waveDecoder.open(QIODevice::ReadOnly);
 
     if (corruption == NotAWav) {
         QSKIP("Not all failures detected correctly yet");
@@ -174,11 +240,10 @@ void tst_QWaveDecoder::file()
         QAudioFormat format = waveDecoder.audioFormat();
         QVERIFY(format.isValid());
         QVERIFY(format.channelCount() == channels);
-        QVERIFY(format.sampleSize() == samplesize);
+        QVERIFY(format.bytesPerSample() * 8 == samplesize);
         QVERIFY(format.sampleRate() == samplerate);
-        if (format.sampleSize() != 8) {
-            QVERIFY(format.byteOrder() == byteorder);
-        }
+        // samples are always converted to the native byte order
+        Q_UNUSED(byteorder);
     }
 
     stream.close();
@@ -191,7 +256,7 @@ void tst_QWaveDecoder::http()
     QFETCH(int, channels);
     QFETCH(int, samplesize);
     QFETCH(int, samplerate);
-    QFETCH(QAudioFormat::Endian, byteorder);
+    QFETCH(QSysInfo::Endian, byteorder);
 
     QFile stream;
     stream.setFileName(file);
@@ -206,6 +271,7 @@ void tst_QWaveDecoder::http()
     QWaveDecoder waveDecoder(reply);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
     QSignalSpy parsingErrorSpy(&waveDecoder, SIGNAL(parsingError()));
+    waveDecoder.open(QIODevice::ReadOnly);
 
     if (corruption == NotAWav) {
         QSKIP("Not all failures detected correctly yet");
@@ -237,11 +303,10 @@ void tst_QWaveDecoder::http()
         QAudioFormat format = waveDecoder.audioFormat();
         QVERIFY(format.isValid());
         QVERIFY(format.channelCount() == channels);
-        QVERIFY(format.sampleSize() == samplesize);
+        QVERIFY(format.bytesPerSample() * 8 == samplesize);
         QVERIFY(format.sampleRate() == samplerate);
-        if (format.sampleSize() != 8) {
-            QVERIFY(format.byteOrder() == byteorder);
-        }
+        // samples are always converted to the native byte order
+        Q_UNUSED(byteorder);
     }
 
     delete reply;
@@ -257,6 +322,7 @@ void tst_QWaveDecoder::readAllAtOnce()
 
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    waveDecoder.open(QIODevice::ReadOnly);
 
     QTRY_COMPARE(validFormatSpy.count(), 1);
     QVERIFY(waveDecoder.size() > 0);
@@ -283,6 +349,7 @@ void tst_QWaveDecoder::readPerByte()
 
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    waveDecoder.open(QIODevice::ReadOnly);
 
     QTRY_COMPARE(validFormatSpy.count(), 1);
     QVERIFY(waveDecoder.size() > 0);
@@ -297,6 +364,217 @@ void tst_QWaveDecoder::readPerByte()
     stream.close();
 }
 
+void tst_QWaveDecoder::devices()
+{
+    QTest::addColumn<bool>("useFile");
+
+    QTest::newRow("buffer") << false;
+    QTest::newRow("file") << true;
+}
+
+// Opens the decoder on the wave data, from a QBuffer or a memory mapped file
+static std::unique_ptr<QIODevice> waveDevice(const QByteArray &data, bool useFile, const QString &dir)
+{
+    if (useFile) {
+        auto file = std::make_unique<QTemporaryFile>(dir + QLatin1String("/XXXXXX.wav"));
+        if (!file->open() || file->write(data) != data.size() || !file->seek(0))
+            return {};
+        return file;
+    }
+    auto buffer = std::make_unique<QBuffer>();
+    buffer->setData(data);
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+static bool openDecoder(QWaveDecoder &decoder)
+{
+    QSignalSpy formatSpy(&decoder, SIGNAL(formatKnown()));
+    decoder.open(QIODevice::ReadOnly);
+    return formatSpy.count() == 1;
+}
+
+void tst_QWaveDecoder::int24_data()
+{
+    QTest::addColumn<bool>("useFile");
+    QTest::addColumn<bool>("bigEndian");
+
+    QTest::newRow("buffer le") << false << false;
+    QTest::newRow("buffer be") << false << true;
+    QTest::newRow("file le") << true << false;
+    QTest::newRow("file be") << true << true;
+}
+
+void tst_QWaveDecoder::int24()
+{
+    QFETCH(bool, useFile);
+    QFETCH(bool, bigEndian);
+
+    const qint32 values[] = { 0x123456, -2, 0x7fffff, -0x800000 };
+    QByteArray samples;
+    for (qint32 value : values) {
+        const char bytes[3] = { char(value), char(value >> 8), char(value >> 16) };
+        if (bigEndian) {
+            samples.append(bytes[2]).append(bytes[1]).append(bytes[0]);
+        } else {
+            samples.append(bytes, 3);
+        }
+    }
+
+    device = waveDevice(waveFile(bigEndian ? "RIFX" : "RIFF", 1, 2, 24, samples), useFile, tempDir.path());
+    QVERIFY(device);
+    QWaveDecoder decoder(device.get());
+    QVERIFY(openDecoder(decoder));
+
+    // widened to 32 bit without losing precision
+    QCOMPARE(decoder.audioFormat().sampleFormat(), QAudioFormat::Int32);
+    QCOMPARE(decoder.size(), qint64(sizeof(values)));
+    QCOMPARE(decoder.frameCount(), qint64(2));
+
+    qint32 decoded[4] = {};
+    QCOMPARE(decoder.read(reinterpret_cast<char *>(decoded), sizeof(decoded)), qint64(sizeof(decoded)));
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(decoded[i], qint32(quint32(values[i]) << 8));
+    QVERIFY(decoder.mappedData().isEmpty());
+}
+
+void tst_QWaveDecoder::floatSamples_data()
+{
+    QTest::addColumn<bool>("useFile");
+    QTest::addColumn<int>("bits");
+    QTest::addColumn<bool>("extensible");
+
+    QTest::newRow("buffer float") << false << 32 << false;
+    QTest::newRow("buffer extensible float") << false << 32 << true;
+    QTest::newRow("buffer double") << false << 64 << false;
+    QTest::newRow("file float") << true << 32 << false;
+    QTest::newRow("file extensible float") << true << 32 << true;
+    QTest::newRow("file double") << true << 64 << false;
+}
+
+void tst_QWaveDecoder::floatSamples()
+{
+    QFETCH(bool, useFile);
+    QFETCH(int, bits);
+    QFETCH(bool, extensible);
+
+    const float values[] = { 0.f, 0.5f, -1.f, 0.25f };
+    QByteArray samples;
+    for (float value : values) {
+        if (bits == 64) {
+            const double d = value;
+            samples.append(reinterpret_cast<const char *>(&d), sizeof(d));
+        } else {
+            samples.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+    }
+    if (QSysInfo::ByteOrder == QSysInfo::BigEndian)
+        QSKIP("The samples are written in host byte order");
+
+    device = waveDevice(waveFile("RIFF", 3, 1, bits, samples, extensible), useFile, tempDir.path());
+    QVERIFY(device);
+    QWaveDecoder decoder(device.get());
+    QVERIFY(openDecoder(decoder));
+
+    QCOMPARE(decoder.audioFormat().sampleFormat(), QAudioFormat::Float);
+    QCOMPARE(decoder.frameCount(), qint64(4));
+
+    float decoded[4] = {};
+    QCOMPARE(decoder.read(reinterpret_cast<char *>(decoded), sizeof(decoded)), qint64(sizeof(decoded)));
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(decoded[i], values[i]);
+}
+
+void tst_QWaveDecoder::rf64()
+{
+    QFETCH(bool, useFile);
+
+    QByteArray samples;
+    for (qint16 i = 0; i < 64; ++i)
+        samples.append(reinterpret_cast<const char *>(&i), sizeof(i));
+    if (QSysInfo::ByteOrder == QSysInfo::BigEndian)
+        QSKIP("The samples are written in host byte order");
+
+    device = waveDevice(waveFile("RF64", 1, 2, 16, samples), useFile, tempDir.path());
+    QVERIFY(device);
+    QWaveDecoder decoder(device.get());
+    QVERIFY(openDecoder(decoder));
+
+    // the size comes from the ds64 chunk, the trailing LIST chunk is not sample data
+    QCOMPARE(decoder.audioFormat().sampleFormat(), QAudioFormat::Int16);
+    QCOMPARE(decoder.size(), qint64(samples.size()));
+    QCOMPARE(decoder.frameCount(), qint64(32));
+    QCOMPARE(decoder.readAll(), samples);
+}
+
+void tst_QWaveDecoder::seekToFrame()
+{
+    QFETCH(bool, useFile);
+
+    // stereo, both channels hold the frame number
+    QByteArray samples;
+    for (qint16 i = 0; i < 1000; ++i) {
+        samples.append(reinterpret_cast<const char *>(&i), sizeof(i));
+        samples.append(reinterpret_cast<const char *>(&i), sizeof(i));
+    }
+    if (QSysInfo::ByteOrder == QSysInfo::BigEndian)
+        QSKIP("The samples are written in host byte order");
+
+    device = waveDevice(waveFile("RIFF", 1, 2, 16, samples), useFile, tempDir.path());
+    QVERIFY(device);
+    QWaveDecoder decoder(device.get());
+    QVERIFY(openDecoder(decoder));
+    QCOMPARE(decoder.frameCount(), qint64(1000));
+
+    for (qint16 frame : { 500, 0, 999, 123 }) {
+        QVERIFY(decoder.seekToFrame(frame));
+        QCOMPARE(decoder.pos(), qint64(frame * 4));
+        qint16 decoded[2] = {};
+        QCOMPARE(decoder.read(reinterpret_cast<char *>(decoded), 4), qint64(4));
+        QCOMPARE(decoded[0], frame);
+        QCOMPARE(decoded[1], frame);
+    }
+
+    QVERIFY(decoder.seekToFrame(1000));
+    QVERIFY(decoder.atEnd());
+    QVERIFY(!decoder.seekToFrame(1001));
+}
+
+void tst_QWaveDecoder::mappedData()
+{
+    QByteArray samples;
+    for (qint16 i = 0; i < 100; ++i)
+        samples.append(reinterpret_cast<const char *>(&i), sizeof(i));
+    if (QSysInfo::ByteOrder == QSysInfo::BigEndian)
+        QSKIP("The samples are written in host byte order");
+
+    // local files in native byte order are not copied at all
+    device = waveDevice(waveFile("RIFF", 1, 1, 16, samples), true, tempDir.path());
+    QVERIFY(device);
+    {
+        QWaveDecoder decoder(device.get());
+        QVERIFY(openDecoder(decoder));
+        QCOMPARE(decoder.mappedData().toByteArray(), samples);
+    }
+
+    // everything else goes through read()
+    device = waveDevice(waveFile("RIFF", 1, 1, 16, samples), false, tempDir.path());
+    QVERIFY(device);
+    {
+        QWaveDecoder decoder(device.get());
+        QVERIFY(openDecoder(decoder));
+        QVERIFY(decoder.mappedData().isEmpty());
+    }
+
+    device = waveDevice(waveFile("RIFX", 1, 1, 16, samples), true, tempDir.path());
+    QVERIFY(device);
+    {
+        QWaveDecoder decoder(device.get());
+        QVERIFY(openDecoder(decoder));
+        QVERIFY(decoder.mappedData().isEmpty());
+    }
+}
+
 QTEST_MAIN(tst_QWaveDecoder)
 
 #include "tst_qwavedecoder.moc"
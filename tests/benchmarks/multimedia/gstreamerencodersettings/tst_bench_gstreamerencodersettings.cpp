@@ -0,0 +1,129 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <private/qgstreamerencodersettings_p.h>
+
+// Encodes a fixed number of 1080p test frames with each of the installed
+// software video encoders, for every quality preset, with and without a
+// restriction to 720p. Run with "-perf -perfcounter task-clock" to get the
+// CPU time spent across all encoder threads instead of wall time.
+
+static const int frameCount = 60;
+
+class tst_Bench_GStreamerEncoderSettings : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void encode_data();
+    void encode();
+};
+
+void tst_Bench_GStreamerEncoderSettings::initTestCase()
+{
+    gst_init(nullptr, nullptr);
+    if (!gst_element_factory_find("videotestsrc"))
+        QSKIP("videotestsrc is not available");
+}
+
+void tst_Bench_GStreamerEncoderSettings::encode_data()
+{
+    QTest::addColumn<QByteArray>("encoder");
+    QTest::addColumn<QMediaRecorder::Quality>("quality");
+    QTest::addColumn<QSize>("resolution");
+
+    const QMetaEnum qualities = QMetaEnum::fromType<QMediaRecorder::Quality>();
+    for (const char *encoder : { "x264enc", "x265enc", "vp8enc", "vp9enc", "theoraenc" }) {
+        GstElementFactory *factory = gst_element_factory_find(encoder);
+        if (!factory)
+            continue;
+        gst_object_unref(factory);
+
+        for (int i = 0; i < qualities.keyCount(); ++i) {
+            const auto quality = QMediaRecorder::Quality(qualities.value(i));
+            for (const QSize &resolution : { QSize(), QSize(1280, 720) }) {
+                QTest::addRow("%s-%s-%s", encoder, qualities.key(i),
+                              resolution.isValid() ? "720p" : "native")
+                        << QByteArray(encoder) << quality << resolution;
+            }
+        }
+    }
+}
+
+void tst_Bench_GStreamerEncoderSettings::encode()
+{
+    QFETCH(QByteArray, encoder);
+    QFETCH(QMediaRecorder::Quality, quality);
+    QFETCH(QSize, resolution);
+
+    QMediaEncoderSettings settings;
+    settings.setQuality(quality);
+    settings.setVideoResolution(resolution);
+
+    QGstMutableCaps restriction = QGstreamerEncoderSettings::videoRestriction(settings);
+    const QByteArray description =
+            "videotestsrc num-buffers=" + QByteArray::number(frameCount)
+            + " ! video/x-raw,format=I420,width=1920,height=1080,framerate=30/1"
+            + " ! videoscale ! capsfilter name=restriction"
+            + " ! " + encoder + " name=encoder ! fakesink sync=false";
+
+    QBENCHMARK {
+        GError *error = nullptr;
+        GstElement *pipeline = gst_parse_launch(description.constData(), &error);
+        QVERIFY2(pipeline, error ? error->message : "");
+
+        GstElement *encoderElement = gst_bin_get_by_name(GST_BIN(pipeline), "encoder");
+        QVERIFY(QGstreamerEncoderSettings::configureEncoder(encoderElement, settings));
+        gst_object_unref(encoderElement);
+        if (!restriction.isNull()) {
+            GstElement *capsFilter = gst_bin_get_by_name(GST_BIN(pipeline), "restriction");
+            g_object_set(capsFilter, "caps", restriction.get(), nullptr);
+            gst_object_unref(capsFilter);
+        }
+
+        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+        GstBus *bus = gst_element_get_bus(pipeline);
+        GstMessage *message = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                                         GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        const bool eos = message && GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS;
+        if (message)
+            gst_message_unref(message);
+        gst_object_unref(bus);
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+        QVERIFY(eos);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_Bench_GStreamerEncoderSettings)
+
+#include "tst_bench_gstreamerencodersettings.moc"
@@ -0,0 +1,294 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qaudiosink.h>
+#include <QtMultimedia/qaudiosource.h>
+#include <QtMultimedia/qsoundeffect.h>
+
+#include <private/qplatformmediaintegration_p.h>
+#include <private/qnullmediaintegration_p.h>
+#include <private/qnullmediadevices_p.h>
+
+// Runs QAudioSink, QAudioSource and QSoundEffect against the virtual audio
+// devices of the null backend. The free running clock measures the overhead
+// of the audio classes without any hardware in the way, the real time clock
+// measures how often they wake up and how much latency they add.
+
+static const qint64 streamUSecs = 10 * 1000 * 1000;
+
+class tst_Bench_NullAudio : public QObject
+{
+    Q_OBJECT
+
+public:
+    static void initMain() { qputenv("QT_MEDIA_BACKEND", "null"); }
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+
+    void sinkPushThroughput();
+    void sinkPullThroughput();
+    void sourcePushThroughput();
+    void sourcePullThroughput();
+    void soundEffect();
+
+    void sinkWakeups_data();
+    void sinkWakeups();
+    void sinkLatency_data();
+    void sinkLatency();
+
+private:
+    QNullMediaDevices *devices() { return integration->nullDevices(); }
+    static QAudioFormat testFormat();
+
+    QNullMediaIntegration *integration = nullptr;
+};
+
+QAudioFormat tst_Bench_NullAudio::testFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+void tst_Bench_NullAudio::initTestCase()
+{
+    // selected by QT_MEDIA_BACKEND in initMain()
+    integration = static_cast<QNullMediaIntegration *>(QPlatformMediaIntegration::instance());
+}
+
+void tst_Bench_NullAudio::init()
+{
+    QNullAudioConfig config;
+    config.clock = QNullAudioConfig::FreeRunning;
+    devices()->setConfig(config);
+}
+
+void tst_Bench_NullAudio::sinkPushThroughput()
+{
+    const QAudioFormat format = testFormat();
+    const QByteArray chunk(format.bytesForDuration(10000), '\0');
+
+    QBENCHMARK {
+        QAudioSink sink(format);
+        QIODevice *device = nullptr;
+
+        // refill on every period, like an application polling bytesFree()
+        QNullAudioConfig config = devices()->config();
+        config.periodHook = [&](const QNullAudioPeriod &) {
+            while (sink.bytesFree() >= chunk.size())
+                device->write(chunk);
+        };
+        devices()->setConfig(config);
+
+        device = sink.start();
+        QVERIFY(device);
+        device->write(chunk);
+        QTRY_VERIFY_WITH_TIMEOUT(sink.processedUSecs() >= streamUSecs, 60000);
+        sink.stop();
+    }
+}
+
+void tst_Bench_NullAudio::sinkPullThroughput()
+{
+    const QAudioFormat format = testFormat();
+    QByteArray data(format.bytesForDuration(streamUSecs), '\0');
+
+    QBENCHMARK {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+
+        QAudioSink sink(format);
+        sink.start(&buffer);
+        QTRY_COMPARE_WITH_TIMEOUT(sink.state(), QAudio::IdleState, 60000);
+        QCOMPARE(sink.processedUSecs(), streamUSecs);
+        sink.stop();
+    }
+}
+
+void tst_Bench_NullAudio::sourcePushThroughput()
+{
+    const QAudioFormat format = testFormat();
+
+    QBENCHMARK {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+
+        QAudioSource source(format);
+        source.start(&buffer);
+        QTRY_VERIFY_WITH_TIMEOUT(source.processedUSecs() >= streamUSecs, 60000);
+        source.stop();
+    }
+}
+
+void tst_Bench_NullAudio::sourcePullThroughput()
+{
+    const QAudioFormat format = testFormat();
+
+    QBENCHMARK {
+        QAudioSource source(format);
+        QIODevice *device = source.start();
+        QVERIFY(device);
+
+        QByteArray data(format.bytesForDuration(10000), '\0');
+        connect(device, &QIODevice::readyRead, this, [&]() {
+            while (device->read(data.data(), data.size()) > 0)
+                ;
+        });
+        QTRY_VERIFY_WITH_TIMEOUT(source.processedUSecs() >= streamUSecs, 60000);
+        source.stop();
+    }
+}
+
+void tst_Bench_NullAudio::soundEffect()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // one second of silence, 48 kHz stereo 16 bit
+    const QString fileName = dir.filePath(QStringLiteral("silence.wav"));
+    {
+        const quint32 dataSize = 48000 * 4;
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QDataStream stream(&file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.writeRawData("RIFF", 4);
+        stream << quint32(36 + dataSize);
+        stream.writeRawData("WAVEfmt ", 8);
+        stream << quint32(16) << quint16(1) << quint16(2) << quint32(48000)
+               << quint32(48000 * 4) << quint16(4) << quint16(16);
+        stream.writeRawData("data", 4);
+        stream << dataSize;
+        file.write(QByteArray(dataSize, '\0'));
+    }
+
+    QSoundEffect effect;
+    effect.setSource(QUrl::fromLocalFile(fileName));
+    QTRY_COMPARE(effect.status(), QSoundEffect::Ready);
+    effect.setLoopCount(10);
+
+    QBENCHMARK {
+        effect.play();
+        QTRY_VERIFY(effect.isPlaying());
+        QTRY_VERIFY_WITH_TIMEOUT(!effect.isPlaying(), 60000);
+    }
+}
+
+void tst_Bench_NullAudio::sinkWakeups_data()
+{
+    QTest::addColumn<int>("periodUSecs");
+
+    QTest::newRow("1ms") << 1000;
+    QTest::newRow("5ms") << 5000;
+    QTest::newRow("20ms") << 20000;
+}
+
+// Reports the periods per second, that the sink processed while an
+// application kept its buffer filled.
+void tst_Bench_NullAudio::sinkWakeups()
+{
+    QFETCH(int, periodUSecs);
+
+    const QAudioFormat format = testFormat();
+    const QByteArray chunk(format.bytesForDuration(periodUSecs), '\0');
+
+    QAudioSink sink(format);
+    QIODevice *device = nullptr;
+    int periods = 0;
+
+    QNullAudioConfig config;
+    config.clock = QNullAudioConfig::RealTime;
+    config.periodUSecs = periodUSecs;
+    config.periodHook = [&](const QNullAudioPeriod &) {
+        ++periods;
+        while (sink.bytesFree() >= chunk.size())
+            device->write(chunk);
+    };
+    devices()->setConfig(config);
+
+    device = sink.start();
+    QVERIFY(device);
+    device->write(chunk);
+    QTest::qWait(1000);
+    const qint64 elapsed = sink.elapsedUSecs();
+    sink.stop();
+
+    QVERIFY(elapsed > 0);
+    QTest::setBenchmarkResult(periods * 1000000. / elapsed, QTest::Events);
+}
+
+void tst_Bench_NullAudio::sinkLatency_data()
+{
+    sinkWakeups_data();
+}
+
+// Reports the mean amount of audio, that waited in the sink when a period
+// was played, which is the latency added by buffering.
+void tst_Bench_NullAudio::sinkLatency()
+{
+    QFETCH(int, periodUSecs);
+
+    const QAudioFormat format = testFormat();
+    const QByteArray chunk(format.bytesForDuration(periodUSecs), '\0');
+
+    QAudioSink sink(format);
+    QIODevice *device = nullptr;
+    qint64 bufferedUSecs = 0;
+    int periods = 0;
+
+    QNullAudioConfig config;
+    config.clock = QNullAudioConfig::RealTime;
+    config.periodUSecs = periodUSecs;
+    config.periodHook = [&](const QNullAudioPeriod &period) {
+        bufferedUSecs += period.bufferedUSecs;
+        ++periods;
+        while (sink.bytesFree() >= chunk.size())
+            device->write(chunk);
+    };
+    devices()->setConfig(config);
+
+    device = sink.start();
+    QVERIFY(device);
+    device->write(chunk);
+    QTest::qWait(1000);
+    sink.stop();
+
+    QVERIFY(periods > 0);
+    QTest::setBenchmarkResult(bufferedUSecs / 1000. / periods, QTest::WalltimeMilliseconds);
+}
+
+QTEST_MAIN(tst_Bench_NullAudio)
+
+#include "tst_bench_nullaudio.moc"
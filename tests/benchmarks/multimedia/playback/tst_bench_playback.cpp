@@ -0,0 +1,382 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qmediaplayer.h>
+#include <QtMultimedia/qmediacapturesession.h>
+#include <QtMultimedia/qcamera.h>
+#include <QtMultimedia/qvideosink.h>
+#include <QtMultimedia/qvideoframe.h>
+
+#include <gst/gst.h>
+
+#include <climits>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+// Measures QMediaPlayer and QMediaCaptureSession end to end on the GStreamer
+// backend, without any test data: the clips are encoded from videotestsrc
+// and audiotestsrc when the benchmark starts, and the capture session uses
+// videotestsrc when the machine has no camera.
+//
+// QT_BENCH_PLAYBACK_SECONDS sets the length of the long running memory test.
+
+static const int clipSeconds = 10;
+static const int clipFrameRate = 30;
+
+static const struct Clip {
+    const char *name;
+    const char *videoEncoder;
+    const char *audioEncoder;
+    const char *muxer;
+    const char *suffix;
+} clipFormats[] = {
+    { "mjpeg-pcm-avi", "jpegenc", "audioconvert", "avimux", "avi" },
+    { "theora-vorbis-ogg", "theoraenc", "vorbisenc", "oggmux", "ogv" },
+    { "h264-mp3-mp4", "x264enc", "lamemp3enc", "mp4mux", "mp4" },
+    { "vp8-vorbis-webm", "vp8enc deadline=1", "vorbisenc", "webmmux", "webm" },
+};
+
+static bool hasElement(const char *description)
+{
+    // the factory name is the first word of the description
+    const QByteArray name = QByteArray(description).split(' ').first();
+    GstElementFactory *factory = gst_element_factory_find(name.constData());
+    if (!factory)
+        return false;
+    gst_object_unref(factory);
+    return true;
+}
+
+class FrameCounter : public QVideoSink
+{
+public:
+    FrameCounter()
+    {
+        connect(this, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame &frame) {
+            if (!frame.isValid())
+                return;
+            ++frames;
+            lastStartTime = frame.startTime();
+        });
+    }
+
+    int frames = 0;
+    qint64 lastStartTime = -1;
+};
+
+class tst_Bench_Playback : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void timeToFirstFrame_data();
+    void timeToFirstFrame();
+    void seekLatency_data();
+    void seekLatency();
+    void droppedFrames_data();
+    void droppedFrames();
+    void cpuPerStream_data();
+    void cpuPerStream();
+    void memoryGrowth();
+    void concurrentPlayers_data();
+    void concurrentPlayers();
+    void cameraTimeToFirstFrame();
+
+private:
+    bool encodeClip(const Clip &clip, const QString &fileName);
+    void addClipRows();
+
+    QTemporaryDir dir;
+    QMap<QByteArray, QUrl> clips;
+};
+
+bool tst_Bench_Playback::encodeClip(const Clip &clip, const QString &fileName)
+{
+    const QByteArray description = QByteArray()
+            + "videotestsrc num-buffers=" + QByteArray::number(clipSeconds * clipFrameRate)
+            + " ! video/x-raw,width=1280,height=720,framerate=" + QByteArray::number(clipFrameRate) + "/1"
+            + " ! videoconvert ! " + clip.videoEncoder + " ! " + clip.muxer + " name=mux"
+            + " ! filesink location=\"" + fileName.toUtf8() + "\""
+            + " audiotestsrc num-buffers=" + QByteArray::number(clipSeconds * 44100 / 1024)
+            + " samplesperbuffer=1024 ! audioconvert ! " + clip.audioEncoder + " ! mux.";
+
+    GError *error = nullptr;
+    GstElement *pipeline = gst_parse_launch(description.constData(), &error);
+    if (error) {
+        qWarning() << "could not create" << clip.name << error->message;
+        g_error_free(error);
+        if (pipeline)
+            gst_object_unref(pipeline);
+        return false;
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus *bus = gst_element_get_bus(pipeline);
+    GstMessage *message = gst_bus_timed_pop_filtered(bus, 300 * GST_SECOND,
+            GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    const bool ok = message && GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS;
+    if (message)
+        gst_message_unref(message);
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    return ok;
+}
+
+void tst_Bench_Playback::initTestCase()
+{
+    QVERIFY(dir.isValid());
+    gst_init(nullptr, nullptr);
+
+    for (const auto &clip : clipFormats) {
+        if (!hasElement(clip.videoEncoder) || !hasElement(clip.audioEncoder) || !hasElement(clip.muxer))
+            continue;
+        const QString fileName = dir.filePath(QString::fromLatin1(clip.name) + QLatin1Char('.')
+                                              + QLatin1String(clip.suffix));
+        if (encodeClip(clip, fileName))
+            clips.insert(clip.name, QUrl::fromLocalFile(fileName));
+    }
+
+    if (clips.isEmpty())
+        QSKIP("None of the test clips could be encoded");
+}
+
+void tst_Bench_Playback::addClipRows()
+{
+    QTest::addColumn<QUrl>("source");
+
+    for (auto it = clips.cbegin(); it != clips.cend(); ++it)
+        QTest::newRow(it.key().constData()) << it.value();
+}
+
+void tst_Bench_Playback::timeToFirstFrame_data()
+{
+    addClipRows();
+}
+
+void tst_Bench_Playback::timeToFirstFrame()
+{
+    QFETCH(QUrl, source);
+
+    QBENCHMARK {
+        QMediaPlayer player;
+        FrameCounter sink;
+        player.setVideoOutput(&sink);
+        player.setSource(source);
+        player.play();
+        QTRY_VERIFY_WITH_TIMEOUT(sink.frames > 0, 10000);
+    }
+}
+
+void tst_Bench_Playback::seekLatency_data()
+{
+    addClipRows();
+}
+
+// time from setPosition() until a frame from the new position is shown
+void tst_Bench_Playback::seekLatency()
+{
+    QFETCH(QUrl, source);
+
+    QMediaPlayer player;
+    FrameCounter sink;
+    player.setVideoOutput(&sink);
+    player.setSource(source);
+    player.pause();
+    QTRY_VERIFY_WITH_TIMEOUT(sink.frames > 0, 10000);
+
+    const qint64 positions[] = { 7000, 2000, 9000, 500, 5000 };
+    int index = 0;
+
+    QBENCHMARK {
+        const qint64 position = positions[index];
+        index = (index + 1) % std::size(positions);
+        player.setPosition(position);
+        // a frame within a frame duration of the target
+        QTRY_VERIFY_WITH_TIMEOUT(qAbs(sink.lastStartTime / 1000 - position) <= 1000 / clipFrameRate + 1, 10000);
+    }
+}
+
+void tst_Bench_Playback::droppedFrames_data()
+{
+    addClipRows();
+}
+
+// plays a whole clip and reports how many of its frames never reached the sink
+void tst_Bench_Playback::droppedFrames()
+{
+    QFETCH(QUrl, source);
+
+    QMediaPlayer player;
+    FrameCounter sink;
+    player.setVideoOutput(&sink);
+    player.setSource(source);
+    player.play();
+    QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::EndOfMedia, clipSeconds * 3000);
+
+    const int expected = clipSeconds * clipFrameRate;
+    QTest::setBenchmarkResult(qMax(expected - sink.frames, 0), QTest::Events);
+}
+
+void tst_Bench_Playback::cpuPerStream_data()
+{
+    addClipRows();
+}
+
+// reports the CPU time of the whole process per second of playback, in
+// std::clock() ticks (microseconds on POSIX systems)
+void tst_Bench_Playback::cpuPerStream()
+{
+    QFETCH(QUrl, source);
+
+    QMediaPlayer player;
+    FrameCounter sink;
+    player.setVideoOutput(&sink);
+    player.setSource(source);
+    player.play();
+    QTRY_VERIFY_WITH_TIMEOUT(sink.frames > 0, 10000);
+
+    QElapsedTimer timer;
+    timer.start();
+    const std::clock_t cpuStart = std::clock();
+    QTest::qWait(5000);
+    const std::clock_t cpuEnd = std::clock();
+    const qint64 elapsed = timer.elapsed();
+
+    QTest::setBenchmarkResult(qreal(cpuEnd - cpuStart) * 1000 / elapsed, QTest::CPUTicks);
+}
+
+static qint64 residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly))
+        return -1;
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : -1;
+#else
+    return -1;
+#endif
+}
+
+// loops a clip and reports how much the resident memory grew after warming up
+void tst_Bench_Playback::memoryGrowth()
+{
+    if (residentBytes() < 0)
+        QSKIP("Resident memory can not be measured on this platform");
+
+    bool ok = false;
+    int seconds = qEnvironmentVariableIntValue("QT_BENCH_PLAYBACK_SECONDS", &ok);
+    if (!ok || seconds <= 0)
+        seconds = 60;
+
+    QMediaPlayer player;
+    FrameCounter sink;
+    player.setVideoOutput(&sink);
+    player.setSource(clips.first());
+    player.setLoops(QMediaPlayer::Infinite);
+    player.play();
+    QTRY_VERIFY_WITH_TIMEOUT(sink.frames > 0, 10000);
+
+    // the first loop fills caches and pools
+    QTest::qWait(clipSeconds * 1000);
+    const qint64 before = residentBytes();
+    QTest::qWait(seconds * 1000);
+    const qint64 after = residentBytes();
+
+    QTest::setBenchmarkResult(after - before, QTest::BytesAllocated);
+}
+
+void tst_Bench_Playback::concurrentPlayers_data()
+{
+    QTest::addColumn<int>("players");
+
+    for (int players : { 1, 2, 4, 8, 16, 32 })
+        QTest::addRow("%d", players) << players;
+}
+
+// reports the frame rate of the slowest of a number of players playing at
+// once, a process sustains them while it stays at the clip's frame rate
+void tst_Bench_Playback::concurrentPlayers()
+{
+    QFETCH(int, players);
+
+    std::vector<std::unique_ptr<QMediaPlayer>> mediaPlayers;
+    std::vector<std::unique_ptr<FrameCounter>> sinks;
+    for (int i = 0; i < players; ++i) {
+        mediaPlayers.push_back(std::make_unique<QMediaPlayer>());
+        sinks.push_back(std::make_unique<FrameCounter>());
+        mediaPlayers.back()->setVideoOutput(sinks.back().get());
+        mediaPlayers.back()->setSource(clips.first());
+        mediaPlayers.back()->setLoops(QMediaPlayer::Infinite);
+        mediaPlayers.back()->play();
+    }
+    for (const auto &sink : sinks)
+        QTRY_VERIFY_WITH_TIMEOUT(sink->frames > 0, 30000);
+
+    std::vector<int> startFrames;
+    for (const auto &sink : sinks)
+        startFrames.push_back(sink->frames);
+    QElapsedTimer timer;
+    timer.start();
+    QTest::qWait(5000);
+    const qint64 elapsed = timer.elapsed();
+
+    int slowest = INT_MAX;
+    for (int i = 0; i < players; ++i)
+        slowest = qMin(slowest, sinks[i]->frames - startFrames[i]);
+
+    QTest::setBenchmarkResult(slowest * 1000. / elapsed, QTest::FramesPerSecond);
+}
+
+void tst_Bench_Playback::cameraTimeToFirstFrame()
+{
+    QBENCHMARK {
+        QMediaCaptureSession session;
+        QCamera camera;
+        FrameCounter sink;
+        session.setCamera(&camera);
+        session.setVideoOutput(&sink);
+        camera.start();
+        QTRY_VERIFY_WITH_TIMEOUT(sink.frames > 0, 10000);
+    }
+}
+
+QTEST_MAIN(tst_Bench_Playback)
+
+#include "tst_bench_playback.moc"
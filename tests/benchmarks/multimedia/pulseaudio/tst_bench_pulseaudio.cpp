@@ -0,0 +1,271 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/qprocess.h>
+#include <QtCore/qthread.h>
+#include <QtMultimedia/qaudioformat.h>
+
+#include <private/qpulseaudiosink_p.h>
+#include <private/qpulseaudiosource_p.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Feeds many concurrent streams from their own threads, the way a multi-zone
+// audio server does, against null sinks loaded into the local PulseAudio
+// server with pactl. It measures how long a single write() or read() takes and
+// how late the feeder threads wake up as the number of streams grows.
+//
+// Streams are spread over QT_PA_STREAM_CONTEXTS server connections; run with
+// QT_PA_STREAM_CONTEXTS=1 to compare against a single shared mainloop lock.
+
+static const int nullSinkCount = 4;
+static const int periodMs = 10;
+static const qint64 runNSecs = 3ll * 1000 * 1000 * 1000;
+
+struct StreamStats
+{
+    std::vector<qint64> callNSecs;
+    qint64 maxLateNSecs = 0;
+    bool failed = false;
+};
+
+class tst_Bench_PulseAudio : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sinkWriteLatency_data() { streamCounts(); }
+    void sinkWriteLatency();
+    void sinkJitter_data() { streamCounts(); }
+    void sinkJitter();
+    void sourceReadLatency_data() { streamCounts(); }
+    void sourceReadLatency();
+
+private:
+    enum Direction { Playback, Capture };
+
+    static void streamCounts();
+    static QAudioFormat testFormat();
+    static qint64 percentile(std::vector<qint64> &values, double p);
+    StreamStats runStreams(Direction direction, int streams);
+
+    QStringList m_modules;
+    QList<QByteArray> m_sinks;
+};
+
+static bool pactl(const QStringList &arguments, QByteArray *output = nullptr)
+{
+    QProcess process;
+    process.start(QStringLiteral("pactl"), arguments);
+    if (!process.waitForFinished(10000) || process.exitStatus() != QProcess::NormalExit
+        || process.exitCode() != 0) {
+        return false;
+    }
+    if (output)
+        *output = process.readAllStandardOutput().trimmed();
+    return true;
+}
+
+void tst_Bench_PulseAudio::initTestCase()
+{
+    for (int i = 0; i < nullSinkCount; ++i) {
+        const QByteArray name = "qt_bench_null_" + QByteArray::number(i);
+        QByteArray module;
+        if (!pactl({ QStringLiteral("load-module"), QStringLiteral("module-null-sink"),
+                     QStringLiteral("sink_name=") + QString::fromLatin1(name) }, &module)) {
+            cleanupTestCase();
+            QSKIP("Needs pactl and a running PulseAudio server");
+        }
+        m_modules.append(QString::fromLatin1(module));
+        m_sinks.append(name);
+    }
+}
+
+void tst_Bench_PulseAudio::cleanupTestCase()
+{
+    for (const QString &module : qAsConst(m_modules))
+        pactl({ QStringLiteral("unload-module"), module });
+    m_modules.clear();
+    m_sinks.clear();
+}
+
+void tst_Bench_PulseAudio::streamCounts()
+{
+    QTest::addColumn<int>("streams");
+
+    for (int streams : { 1, 2, 4, 8, 16, 32 })
+        QTest::addRow("%d", streams) << streams;
+}
+
+QAudioFormat tst_Bench_PulseAudio::testFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+qint64 tst_Bench_PulseAudio::percentile(std::vector<qint64> &values, double p)
+{
+    if (values.empty())
+        return 0;
+    auto nth = values.begin() + qMin(values.size() - 1, size_t(p * values.size()));
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+StreamStats tst_Bench_PulseAudio::runStreams(Direction direction, int streams)
+{
+    const QAudioFormat format = testFormat();
+    const qint64 periodNSecs = periodMs * 1000 * 1000;
+
+    std::vector<StreamStats> results(streams);
+    std::vector<std::unique_ptr<QThread>> threads;
+
+    // Every thread owns one stream and services it once per period, like a
+    // feeder thread of an audio server would
+    for (int i = 0; i < streams; ++i) {
+        StreamStats &stats = results[i];
+        const QByteArray sink = m_sinks.at(i % m_sinks.size());
+        threads.emplace_back(QThread::create([&stats, sink, direction, format, periodNSecs]() {
+            QByteArray buffer(format.bytesForDuration(periodMs * 1000), '\0');
+            std::unique_ptr<QPulseAudioSink> output;
+            std::unique_ptr<QPulseAudioSource> input;
+            QIODevice *device = nullptr;
+
+            if (direction == Playback) {
+                output.reset(new QPulseAudioSink(sink));
+                output->setFormat(format);
+                device = output->start();
+            } else {
+                input.reset(new QPulseAudioSource(sink + ".monitor"));
+                input->setFormat(format);
+                device = input->start();
+            }
+            if (!device) {
+                stats.failed = true;
+                return;
+            }
+
+            QElapsedTimer clock;
+            clock.start();
+            qint64 deadline = 0;
+            while (clock.nsecsElapsed() < runNSecs) {
+                const qint64 now = clock.nsecsElapsed();
+                if (now < deadline) {
+                    QThread::usleep((deadline - now) / 1000);
+                    continue;
+                }
+                stats.maxLateNSecs = qMax(stats.maxLateNSecs, now - deadline);
+                deadline += periodNSecs;
+
+                if (direction == Playback) {
+                    while (output->bytesFree() >= buffer.size()) {
+                        const qint64 start = clock.nsecsElapsed();
+                        device->write(buffer);
+                        stats.callNSecs.push_back(clock.nsecsElapsed() - start);
+                    }
+                } else {
+                    const qint64 start = clock.nsecsElapsed();
+                    device->read(buffer.data(), buffer.size());
+                    stats.callNSecs.push_back(clock.nsecsElapsed() - start);
+                }
+            }
+
+            if (output)
+                output->stop();
+            if (input)
+                input->stop();
+        }));
+    }
+
+    for (auto &thread : threads)
+        thread->start();
+    for (auto &thread : threads)
+        thread->wait();
+
+    StreamStats total;
+    for (StreamStats &stats : results) {
+        total.failed |= stats.failed;
+        total.maxLateNSecs = qMax(total.maxLateNSecs, stats.maxLateNSecs);
+        total.callNSecs.insert(total.callNSecs.end(), stats.callNSecs.begin(), stats.callNSecs.end());
+    }
+    return total;
+}
+
+void tst_Bench_PulseAudio::sinkWriteLatency()
+{
+    QFETCH(int, streams);
+
+    StreamStats stats = runStreams(Playback, streams);
+    QVERIFY(!stats.failed);
+    QVERIFY(!stats.callNSecs.empty());
+
+    const qint64 median = percentile(stats.callNSecs, 0.5);
+    const qint64 p99 = percentile(stats.callNSecs, 0.99);
+    qInfo("%d streams: %zu writes, median %lld ns, p99 %lld ns", streams,
+          stats.callNSecs.size(), median, p99);
+    QTest::setBenchmarkResult(p99, QTest::WalltimeNanoseconds);
+}
+
+void tst_Bench_PulseAudio::sinkJitter()
+{
+    QFETCH(int, streams);
+
+    StreamStats stats = runStreams(Playback, streams);
+    QVERIFY(!stats.failed);
+
+    // how late the worst feeder thread got around to its next period
+    QTest::setBenchmarkResult(stats.maxLateNSecs, QTest::WalltimeNanoseconds);
+}
+
+void tst_Bench_PulseAudio::sourceReadLatency()
+{
+    QFETCH(int, streams);
+
+    StreamStats stats = runStreams(Capture, streams);
+    QVERIFY(!stats.failed);
+    QVERIFY(!stats.callNSecs.empty());
+
+    const qint64 median = percentile(stats.callNSecs, 0.5);
+    const qint64 p99 = percentile(stats.callNSecs, 0.99);
+    qInfo("%d streams: %zu reads, median %lld ns, p99 %lld ns", streams,
+          stats.callNSecs.size(), median, p99);
+    QTest::setBenchmarkResult(p99, QTest::WalltimeNanoseconds);
+}
+
+QTEST_MAIN(tst_Bench_PulseAudio)
+
+#include "tst_bench_pulseaudio.moc"
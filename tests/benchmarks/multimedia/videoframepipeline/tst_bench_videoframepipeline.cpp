@@ -0,0 +1,336 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qvideoframe.h>
+#include <QtMultimedia/qvideosink.h>
+
+#include <private/qtmultimediaglobal_p.h>
+#include <private/qvideoframeconversionhelper_p.h>
+#include <private/qvideotexturehelper_p.h>
+#include <private/qmemoryvideobuffer_p.h>
+#include <private/qplatformvideosink_p.h>
+#include <private/qrhinull_p.h>
+
+#if QT_CONFIG(gstreamer)
+#include <private/qgstvideobuffer_p.h>
+#endif
+
+// Covers the stages a decoded frame goes through before it is shown:
+// conversion to RGB, mapping, texture upload and delivery to the sinks.
+// Run with "-o results.xml,xml" or "-o results.csv,csv" to get results,
+// that can be compared between builds.
+
+class tst_Bench_VideoFramePipeline : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void convert_data();
+    void convert();
+    void toImage_data();
+    void toImage();
+
+    void mapMemoryBuffer_data();
+    void mapMemoryBuffer();
+#if QT_CONFIG(gstreamer)
+    void mapGstBuffer_data();
+    void mapGstBuffer();
+#endif
+
+    void updateRhiTextures_data();
+    void updateRhiTextures();
+
+    void sinkFanOut_data();
+    void sinkFanOut();
+
+private:
+    std::unique_ptr<QRhi> rhi;
+};
+
+static const struct {
+    const char *name;
+    QSize size;
+} resolutions[] = {
+    { "480p", QSize(640, 480) },
+    { "1080p", QSize(1920, 1080) },
+    { "4K", QSize(3840, 2160) },
+};
+
+static QVideoFrame filledFrame(QVideoFrameFormat::PixelFormat pixelFormat, const QSize &size)
+{
+    QVideoFrame frame(QVideoFrameFormat(size, pixelFormat));
+    if (frame.map(QVideoFrame::WriteOnly)) {
+        // anything but zeros, so that no converter takes a shortcut
+        for (int plane = 0; plane < frame.planeCount(); ++plane)
+            memset(frame.bits(plane), 0x5a + plane, frame.mappedBytes(plane));
+        frame.unmap();
+    }
+    return frame;
+}
+
+// adds a row for every pixel format with a CPU converter at every resolution
+static void addPixelFormatRows()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+
+    for (int i = QVideoFrameFormat::Format_Invalid + 1; i < QVideoFrameFormat::NPixelFormats; ++i) {
+        const auto pixelFormat = QVideoFrameFormat::PixelFormat(i);
+        if (!qConverterForFormat(pixelFormat))
+            continue;
+        const QByteArray name = QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+        for (const auto &resolution : resolutions) {
+            QTest::addRow("%s-%s", name.constData(), resolution.name)
+                    << pixelFormat << resolution.size;
+        }
+    }
+}
+
+void tst_Bench_VideoFramePipeline::initTestCase()
+{
+    QRhiNullInitParams params;
+    rhi.reset(QRhi::create(QRhi::Null, &params));
+    QVERIFY(rhi);
+}
+
+void tst_Bench_VideoFramePipeline::cleanupTestCase()
+{
+    rhi.reset();
+}
+
+void tst_Bench_VideoFramePipeline::convert_data()
+{
+    addPixelFormatRows();
+}
+
+void tst_Bench_VideoFramePipeline::convert()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    QVideoFrame frame = filledFrame(pixelFormat, size);
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    const VideoFrameConvertFunc convert = qConverterForFormat(pixelFormat);
+
+    QBENCHMARK {
+        convert(frame, image.bits());
+    }
+
+    frame.unmap();
+}
+
+void tst_Bench_VideoFramePipeline::toImage_data()
+{
+    addPixelFormatRows();
+}
+
+// the full path of QVideoFrame::toImage(), including mapping and allocation
+void tst_Bench_VideoFramePipeline::toImage()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    const QVideoFrame frame = filledFrame(pixelFormat, size);
+
+    QBENCHMARK {
+        QImage image = frame.toImage();
+        Q_UNUSED(image);
+    }
+}
+
+void tst_Bench_VideoFramePipeline::mapMemoryBuffer_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+
+    for (auto pixelFormat : { QVideoFrameFormat::Format_ARGB8888, QVideoFrameFormat::Format_YUV420P,
+                              QVideoFrameFormat::Format_NV12 }) {
+        const QByteArray name = QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+        for (const auto &resolution : resolutions) {
+            QTest::addRow("%s-%s", name.constData(), resolution.name)
+                    << pixelFormat << resolution.size;
+        }
+    }
+}
+
+void tst_Bench_VideoFramePipeline::mapMemoryBuffer()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    QVideoFrame frame = filledFrame(pixelFormat, size);
+
+    QBENCHMARK {
+        frame.map(QVideoFrame::ReadOnly);
+        frame.unmap();
+    }
+}
+
+#if QT_CONFIG(gstreamer)
+void tst_Bench_VideoFramePipeline::mapGstBuffer_data()
+{
+    QTest::addColumn<int>("videoFormat");
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+
+    const struct {
+        GstVideoFormat videoFormat;
+        QVideoFrameFormat::PixelFormat pixelFormat;
+    } formats[] = {
+        { GST_VIDEO_FORMAT_BGRA, QVideoFrameFormat::Format_BGRA8888 },
+        { GST_VIDEO_FORMAT_I420, QVideoFrameFormat::Format_YUV420P },
+        { GST_VIDEO_FORMAT_NV12, QVideoFrameFormat::Format_NV12 },
+    };
+
+    for (const auto &format : formats) {
+        const QByteArray name = QVideoFrameFormat::pixelFormatToString(format.pixelFormat).toLatin1();
+        for (const auto &resolution : resolutions) {
+            QTest::addRow("%s-%s", name.constData(), resolution.name)
+                    << int(format.videoFormat) << format.pixelFormat << resolution.size;
+        }
+    }
+}
+
+void tst_Bench_VideoFramePipeline::mapGstBuffer()
+{
+    QFETCH(int, videoFormat);
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    gst_init(nullptr, nullptr);
+
+    GstVideoInfo info;
+    QVERIFY(gst_video_info_set_format(&info, GstVideoFormat(videoFormat), size.width(), size.height()));
+    GstBuffer *buffer = gst_buffer_new_allocate(nullptr, GST_VIDEO_INFO_SIZE(&info), nullptr);
+    gst_buffer_memset(buffer, 0, 0x5a, GST_VIDEO_INFO_SIZE(&info));
+
+    // the video buffer takes a reference of its own
+    QVideoFrame frame(new QGstVideoBuffer(buffer, QVideoFrameFormat(size, pixelFormat), info),
+                      QVideoFrameFormat(size, pixelFormat));
+    gst_buffer_unref(buffer);
+
+    QBENCHMARK {
+        frame.map(QVideoFrame::ReadOnly);
+        frame.unmap();
+    }
+}
+#endif
+
+void tst_Bench_VideoFramePipeline::updateRhiTextures_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+
+    for (int i = QVideoFrameFormat::Format_Invalid + 1; i < QVideoFrameFormat::NPixelFormats; ++i) {
+        const auto pixelFormat = QVideoFrameFormat::PixelFormat(i);
+        if (pixelFormat == QVideoFrameFormat::Format_Jpeg
+            || pixelFormat == QVideoFrameFormat::Format_SamplerExternalOES
+            || pixelFormat == QVideoFrameFormat::Format_SamplerRect)
+            continue;
+        const QByteArray name = QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+        for (const auto &resolution : resolutions) {
+            QTest::addRow("%s-%s", name.constData(), resolution.name)
+                    << pixelFormat << resolution.size;
+        }
+    }
+}
+
+// uploads a new frame for every iteration, to textures that already exist
+void tst_Bench_VideoFramePipeline::updateRhiTextures()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    const QVideoFrame frame = filledFrame(pixelFormat, size);
+    QRhiTexture *textures[QVideoTextureHelper::TextureDescription::maxPlanes] = {};
+
+    QBENCHMARK {
+        QRhiCommandBuffer *cb = nullptr;
+        QCOMPARE(rhi->beginOffscreenFrame(&cb), QRhi::FrameOpSuccess);
+        QRhiResourceUpdateBatch *resourceUpdates = rhi->nextResourceUpdateBatch();
+        QVERIFY(QVideoTextureHelper::updateRhiTextures(frame, rhi.get(), resourceUpdates, textures) > 0);
+        cb->resourceUpdate(resourceUpdates);
+        rhi->endOffscreenFrame();
+    }
+
+    for (auto *texture : textures)
+        delete texture;
+}
+
+void tst_Bench_VideoFramePipeline::sinkFanOut_data()
+{
+    QTest::addColumn<int>("receivers");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("4") << 4;
+    QTest::newRow("16") << 16;
+}
+
+// delivers frames through QPlatformVideoSink::setVideoFrame() to a number of
+// receivers of QVideoSink::videoFrameChanged()
+void tst_Bench_VideoFramePipeline::sinkFanOut()
+{
+    QFETCH(int, receivers);
+
+    QVideoSink sink;
+    QPlatformVideoSink *platformSink = sink.platformVideoSink();
+    if (!platformSink)
+        QSKIP("The media backend has no video sink");
+
+    int delivered = 0;
+    for (int i = 0; i < receivers; ++i) {
+        connect(&sink, &QVideoSink::videoFrameChanged, this, [&delivered](const QVideoFrame &frame) {
+            if (frame.isValid())
+                ++delivered;
+        });
+    }
+
+    // setVideoFrame() skips a frame, that is already current
+    const QVideoFrame frames[] = {
+        filledFrame(QVideoFrameFormat::Format_NV12, QSize(1920, 1080)),
+        filledFrame(QVideoFrameFormat::Format_NV12, QSize(1920, 1080)),
+    };
+    int index = 0;
+
+    QBENCHMARK {
+        platformSink->setVideoFrame(frames[index]);
+        index ^= 1;
+    }
+
+    QVERIFY(delivered > 0);
+}
+
+QTEST_MAIN(tst_Bench_VideoFramePipeline)
+
+#include "tst_bench_videoframepipeline.moc"